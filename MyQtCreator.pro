@@ -17,21 +17,38 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
     apiconfigdialog.cpp \
+    auditlogspool.cpp \
+    auditlogwriter.cpp \
     basedbhelper.cpp \
     baseeditdialog.cpp \
+    chatdbhelper.cpp \
     configwidget.cpp \
+    dbasyncexecutor.cpp \
+    dbconnectionpool.cpp \
     forgetpwddialog.cpp \
     iphelper.cpp \
+    llmcontextbuilder.cpp \
+    llmfileloader.cpp \
+    llmrequestscheduler.cpp \
+    llmresponsecache.cpp \
+    llmstreamparser.cpp \
     llmwidget.cpp \
+    logarchiver.cpp \
     logdbhelper.cpp \
     loghelper.cpp \
+    logkeywordmatcher.cpp \
     loginwidget.cpp \
     logmanager.cpp \
     logtablewidget.cpp \
     main.cpp \
     mainwindow.cpp \
+    markdownrenderer.cpp \
+    parametersweep.cpp \
     personcenterwidget.cpp \
+    preparedstatementcache.cpp \
     pythonrunner.cpp \
+    pythonworker.cpp \
+    runscheduler.cpp \
     smshelper.cpp \
     tableoperatewidget.cpp \
     testdbhelper.cpp \
@@ -43,20 +60,39 @@ SOURCES += \
 
 HEADERS += \
     apiconfigdialog.h \
+    auditlogspool.h \
+    auditlogwriter.h \
     basedbhelper.h \
     baseeditdialog.h \
+    chatdbhelper.h \
     configwidget.h \
+    crc32helper.h \
+    dbasyncexecutor.h \
+    dbconnectionpool.h \
     forgetpwddialog.h \
     iphelper.h \
+    llmcontextbuilder.h \
+    llmfileloader.h \
+    llmrequestscheduler.h \
+    llmresponsecache.h \
+    llmstreamparser.h \
     llmwidget.h \
+    logarchiver.h \
     logdbhelper.h \
     loghelper.h \
+    logkeywordmatcher.h \
+    logringbuffer.h \
     loginwidget.h \
     logmanager.h \
     logtablewidget.h \
     mainwindow.h \
+    markdownrenderer.h \
+    parametersweep.h \
     personcenterwidget.h \
+    preparedstatementcache.h \
     pythonrunner.h \
+    pythonworker.h \
+    runscheduler.h \
     smshelper.h \
     tableoperatewidget.h \
     testdbhelper.h \
@@ -79,4 +115,5 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 RESOURCES += \
-    icon.qrc
+    icon.qrc \
+    python.qrc
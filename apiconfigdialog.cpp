@@ -52,7 +52,7 @@ void ApiConfigDialog::loadConfig()
     BaseDbHelper *dbHelper = BaseDbHelper::getInstance();
     // 查询当前用户的API配置
     QString sql = QString("SELECT api_url, api_key, model, temperature FROM user_api_config WHERE user_id = %1").arg(UserSession::instance()->userId());
-    QSqlQuery query = dbHelper->execQuery(sql);
+    DbQuery query = dbHelper->execQuery(sql);
     if (query.next()) {
         m_apiUrlEdit->setText(query.value(0).toString());
         m_apiKeyEdit->setText(query.value(1).toString());
@@ -81,7 +81,7 @@ void ApiConfigDialog::saveConfig()
     BaseDbHelper *dbHelper = BaseDbHelper::getInstance();
     // 先查询是否存在配置（存在则更新，不存在则插入）
     QString checkSql = QString("SELECT id FROM user_api_config WHERE user_id = %1").arg(UserSession::instance()->userId());
-    QSqlQuery checkQuery = dbHelper->execQuery(checkSql);
+    DbQuery checkQuery = dbHelper->execQuery(checkSql);
 
     if (checkQuery.next()) {
         // 更新配置
@@ -0,0 +1,255 @@
+#include "auditlogspool.h"
+#include "crc32helper.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const quint32 SPOOL_RECORD_MAGIC = 0x414C5350; // "ALSP"
+static const int SPOOL_RECORD_HEADER = 12;            // 魔数 + 长度 + CRC32
+
+// 刷到磁盘（QFile::flush只保证进入系统缓冲）
+static void syncFile(QFile &file)
+{
+    file.flush();
+#ifdef Q_OS_WIN
+    FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(file.handle())));
+#else
+    fsync(file.handle());
+#endif
+}
+
+AuditLogSpool::AuditLogSpool(const QString &spoolDir, qint64 segmentBytes, qint64 maxTotalBytes)
+    : m_spoolDir(spoolDir), m_segmentBytes(segmentBytes), m_maxTotalBytes(maxTotalBytes)
+{
+    QDir dir(m_spoolDir);
+    if (!dir.exists()) {
+        dir.mkpath(".");
+    }
+    loadSegments();
+}
+
+void AuditLogSpool::loadSegments()
+{
+    QDir dir(m_spoolDir);
+    QStringList files = dir.entryList(QStringList() << "audit_*.spool", QDir::Files, QDir::Name);
+    for (const QString &fileName : files) {
+        bool ok = false;
+        quint64 seq = QFileInfo(fileName).baseName().mid(6).toULongLong(&ok);
+        if (ok) {
+            m_segments.append(seq);
+            m_nextSeq = qMax(m_nextSeq, seq + 1);
+        }
+    }
+    std::sort(m_segments.begin(), m_segments.end());
+    m_firstOwnSeq = m_nextSeq;
+    if (!m_segments.isEmpty()) {
+        qWarning() << QString("发现未回放的审计日志暂存：%1个分段").arg(m_segments.size());
+    }
+}
+
+QString AuditLogSpool::segmentPath(quint64 seq) const
+{
+    return QString("%1/audit_%2.spool").arg(m_spoolDir).arg(seq, 10, 10, QChar('0'));
+}
+
+bool AuditLogSpool::hasPending() const
+{
+    return !m_segments.isEmpty();
+}
+
+qint64 AuditLogSpool::pendingBytes() const
+{
+    qint64 total = 0;
+    for (quint64 seq : m_segments) {
+        total += QFileInfo(segmentPath(seq)).size();
+    }
+    return total;
+}
+
+bool AuditLogSpool::writeRecords(const QString &path, const QList<SysLogRecord> &records, bool truncate)
+{
+    QByteArray buffer;
+    for (const SysLogRecord &record : records) {
+        QByteArray payload;
+        QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+        payloadStream.setVersion(QDataStream::Qt_5_0);
+        payloadStream << qint32(record.user_id) << record.operation_type << record.operation_content
+                      << record.ip_address << record.log_level << record.module_name
+                      << qint64(record.create_time.toMSecsSinceEpoch());
+
+        QByteArray header;
+        QDataStream headerStream(&header, QIODevice::WriteOnly);
+        headerStream << SPOOL_RECORD_MAGIC << quint32(payload.size()) << crc32Ieee(payload);
+        buffer.append(header).append(payload);
+    }
+
+    QFile file(path);
+    QIODevice::OpenMode mode = QIODevice::WriteOnly | (truncate ? QIODevice::Truncate : QIODevice::Append);
+    if (!file.open(mode)) {
+        qCritical() << "审计日志暂存文件打开失败：" << path << file.errorString();
+        return false;
+    }
+    bool ok = (file.write(buffer) == buffer.size());
+    syncFile(file);
+    file.close();
+    return ok;
+}
+
+bool AuditLogSpool::append(const QList<SysLogRecord> &records)
+{
+    if (records.isEmpty()) {
+        return true;
+    }
+
+    // 本进程创建的当前分段未满则续写，否则新开分段
+    if (m_segments.isEmpty() || m_segments.last() < m_firstOwnSeq
+        || QFileInfo(segmentPath(m_segments.last())).size() >= m_segmentBytes) {
+        m_segments.append(m_nextSeq++);
+    }
+    bool ok = writeRecords(segmentPath(m_segments.last()), records, false);
+    enforceCapacity();
+    return ok;
+}
+
+void AuditLogSpool::enforceCapacity()
+{
+    qint64 total = pendingBytes();
+    while (total > m_maxTotalBytes && m_segments.size() > 1) {
+        QString oldest = segmentPath(m_segments.takeFirst());
+        total -= QFileInfo(oldest).size();
+        QFile::remove(oldest);
+        qWarning() << "审计日志暂存超出容量，丢弃最早分段：" << oldest;
+    }
+}
+
+QList<SysLogRecord> AuditLogSpool::readSegment(const QString &path, bool *corrupted) const
+{
+    QList<SysLogRecord> records;
+    *corrupted = false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return records;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    // 魔数按QDataStream默认的大端序写入
+    QByteArray magicBytes;
+    QDataStream(&magicBytes, QIODevice::WriteOnly) << SPOOL_RECORD_MAGIC;
+
+    int offset = 0;
+    while (offset < data.size()) {
+        if (data.size() - offset < SPOOL_RECORD_HEADER) {
+            *corrupted = true;
+            break;
+        }
+        QDataStream headerStream(data.mid(offset, SPOOL_RECORD_HEADER));
+        quint32 magic, length, checksum;
+        headerStream >> magic >> length >> checksum;
+        QByteArray payload;
+        if (magic == SPOOL_RECORD_MAGIC && length <= quint32(data.size() - offset - SPOOL_RECORD_HEADER)) {
+            payload = data.mid(offset + SPOOL_RECORD_HEADER, int(length));
+        }
+        if (magic != SPOOL_RECORD_MAGIC || payload.size() != int(length) || crc32Ieee(payload) != checksum) {
+            // 损坏记录（如崩溃时写了一半）：跳到下一个魔数，其后的有效记录照常回放
+            *corrupted = true;
+            offset = data.indexOf(magicBytes, offset + 1);
+            if (offset < 0) {
+                break;
+            }
+            continue;
+        }
+
+        QDataStream payloadStream(payload);
+        payloadStream.setVersion(QDataStream::Qt_5_0);
+        SysLogRecord record;
+        qint32 userId;
+        qint64 msecs;
+        payloadStream >> userId >> record.operation_type >> record.operation_content
+                      >> record.ip_address >> record.log_level >> record.module_name >> msecs;
+        record.user_id = userId;
+        record.create_time = QDateTime::fromMSecsSinceEpoch(msecs);
+        records.append(record);
+
+        offset += SPOOL_RECORD_HEADER + int(length);
+    }
+    return records;
+}
+
+int AuditLogSpool::replay(int chunkSize, const std::function<int(const QList<SysLogRecord>&)> &sink)
+{
+    int replayed = 0;
+    while (!m_segments.isEmpty()) {
+        QString path = segmentPath(m_segments.first());
+        bool corrupted = false;
+        QList<SysLogRecord> records = readSegment(path, &corrupted);
+        if (corrupted) {
+            qWarning() << "审计日志暂存分段存在损坏记录，已跳过损坏部分：" << path;
+        }
+
+        int done = 0;
+        while (done < records.size()) {
+            QList<SysLogRecord> chunk = records.mid(done, chunkSize);
+            int written = sink(chunk);
+            done += written;
+            replayed += written;
+            if (written < chunk.size()) {
+                // 回放中断：保留未回放的记录，避免重复写入
+                if (done > 0 || corrupted) {
+                    writeRecords(path, records.mid(done), true);
+                }
+                return replayed;
+            }
+        }
+
+        QFile::remove(path);
+        m_segments.removeFirst();
+    }
+    return replayed;
+}
+
+QString AuditLogSpool::quarantinePath() const
+{
+    return m_spoolDir + "/audit_rejected.jsonl";
+}
+
+bool AuditLogSpool::quarantine(const QList<SysLogRecord> &records, const QString &reason)
+{
+    // 每行一条JSON，便于排查后手工修正再导入
+    QByteArray buffer;
+    for (const SysLogRecord &record : records) {
+        QJsonObject json;
+        json["user_id"] = record.user_id;
+        json["operation_type"] = record.operation_type;
+        json["operation_content"] = record.operation_content;
+        json["ip_address"] = record.ip_address;
+        json["log_level"] = record.log_level;
+        json["module_name"] = record.module_name;
+        json["create_time"] = record.create_time.toString("yyyy-MM-dd HH:mm:ss");
+        json["error"] = reason;
+        buffer.append(QJsonDocument(json).toJson(QJsonDocument::Compact)).append('\n');
+    }
+
+    QFile file(quarantinePath());
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCritical() << "审计日志死信文件打开失败：" << file.fileName() << file.errorString();
+        return false;
+    }
+    bool ok = (file.write(buffer) == buffer.size());
+    syncFile(file);
+    file.close();
+    return ok;
+}
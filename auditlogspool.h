@@ -0,0 +1,49 @@
+#ifndef AUDITLOGSPOOL_H
+#define AUDITLOGSPOOL_H
+
+#include <QString>
+#include <QList>
+#include <functional>
+#include "logdbhelper.h"
+
+// 审计日志本地暂存：数据库不可用时把事件追加写入分段文件，恢复后批量回放
+// 文件格式：每条记录 = 魔数(4) + 负载长度(4) + CRC32(4) + 负载(QDataStream序列化的SysLogRecord)
+// 非线程安全，仅由审计日志写入线程使用
+class AuditLogSpool
+{
+public:
+    AuditLogSpool(const QString &spoolDir, qint64 segmentBytes, qint64 maxTotalBytes);
+
+    // 追加一批事件（写入后刷盘），超过总容量时淘汰最早的分段
+    bool append(const QList<SysLogRecord> &records);
+    // 是否有待回放的事件
+    bool hasPending() const;
+    qint64 pendingBytes() const;
+
+    // 按分段顺序回放，每次最多chunkSize条交给sink；sink返回已处理的前缀条数，不足整块即停止，未回放部分原样保留
+    // 返回成功回放的条数
+    int replay(int chunkSize, const std::function<int(const QList<SysLogRecord>&)> &sink);
+    // 数据库拒绝写入的记录（字段超长、外键不存在等）追加到死信文件，不再回放，留待人工处理
+    bool quarantine(const QList<SysLogRecord> &records, const QString &reason);
+    QString quarantinePath() const;
+
+private:
+    // 扫描目录中已有分段（程序重启后继续回放）
+    void loadSegments();
+    QString segmentPath(quint64 seq) const;
+    // 读取分段中全部有效记录，遇到损坏/截断的记录时向后查找下一个记录魔数继续读取
+    QList<SysLogRecord> readSegment(const QString &path, bool *corrupted) const;
+    // 把记录写入文件（追加或覆盖）
+    bool writeRecords(const QString &path, const QList<SysLogRecord> &records, bool truncate);
+    // 超过总容量时删除最早的分段
+    void enforceCapacity();
+
+    QString m_spoolDir;
+    qint64 m_segmentBytes;
+    qint64 m_maxTotalBytes;
+    QList<quint64> m_segments;   // 现存分段序号（升序）
+    quint64 m_nextSeq = 1;
+    quint64 m_firstOwnSeq = 1;   // 本进程新开的首个分段序号；更早的分段可能以崩溃截断的记录结尾，不再续写
+};
+
+#endif // AUDITLOGSPOOL_H
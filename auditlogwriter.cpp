@@ -0,0 +1,257 @@
+#include "auditlogwriter.h"
+#include "auditlogspool.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QFile>
+#include <QDebug>
+
+// 连接类错误：2002/2003无法连接，2006/2013执行中连接断开，2055读写失败
+static bool isConnectionError(const QSqlError &error)
+{
+    if (error.type() == QSqlError::ConnectionError) {
+        return true;
+    }
+    static const QStringList codes = {"2002", "2003", "2006", "2013", "2055"};
+    return codes.contains(error.nativeErrorCode());
+}
+
+AuditLogWriter::AuditLogWriter(QObject *parent) : QThread(parent)
+{
+    readWriterConfig();
+}
+
+AuditLogWriter::~AuditLogWriter()
+{
+    stop();
+    delete m_spool;
+}
+
+void AuditLogWriter::readWriterConfig()
+{
+    QString configPath = QCoreApplication::applicationDirPath() + "/config.ini";
+    m_spoolDir = QCoreApplication::applicationDirPath() + "/spool/audit";
+    if (!QFile::exists(configPath)) {
+        return;
+    }
+
+    QSettings config(configPath, QSettings::IniFormat);
+    config.beginGroup("AuditLog");
+    m_batchSize = qMax(1, config.value("BatchSize", m_batchSize).toInt());
+    m_flushIntervalMs = qMax(10, config.value("FlushIntervalMs", m_flushIntervalMs).toInt());
+    m_queueCapacity = qMax(m_batchSize, config.value("QueueCapacity", m_queueCapacity).toInt());
+    m_blockTimeoutMs = qMax(0, config.value("BlockTimeoutMs", m_blockTimeoutMs).toInt());
+    QString policy = config.value("OverflowPolicy", "drop_oldest").toString().toLower();
+    m_retryIntervalMs = qMax(100, config.value("RetryIntervalMs", m_retryIntervalMs).toInt());
+    m_spoolDir = config.value("SpoolDir", m_spoolDir).toString();
+    m_spoolSegmentBytes = qMax(4096LL, config.value("SpoolSegmentKB", m_spoolSegmentBytes / 1024).toLongLong() * 1024);
+    m_spoolMaxBytes = qMax(m_spoolSegmentBytes, config.value("SpoolMaxMB", m_spoolMaxBytes / 1024 / 1024).toLongLong() * 1024 * 1024);
+    config.endGroup();
+
+    if (policy == "drop_newest") {
+        m_overflowPolicy = OVERFLOW_DROP_NEWEST;
+    } else if (policy == "block") {
+        m_overflowPolicy = OVERFLOW_BLOCK;
+    } else {
+        m_overflowPolicy = OVERFLOW_DROP_OLDEST;
+    }
+}
+
+bool AuditLogWriter::enqueue(const SysLogRecord &record)
+{
+    QMutexLocker locker(&m_queueMutex);
+    if (m_stopping) {
+        return false;
+    }
+
+    // 队列满：按策略处理背压
+    if (m_queue.size() >= m_queueCapacity) {
+        switch (m_overflowPolicy) {
+        case OVERFLOW_DROP_NEWEST:
+            m_droppedCount++;
+            return false;
+        case OVERFLOW_BLOCK:
+            m_queueReady.wakeOne();
+            m_queueNotFull.wait(&m_queueMutex, static_cast<unsigned long>(m_blockTimeoutMs));
+            if (m_queue.size() >= m_queueCapacity || m_stopping) {
+                m_droppedCount++;
+                return false;
+            }
+            break;
+        case OVERFLOW_DROP_OLDEST:
+        default:
+            m_queue.dequeue();
+            m_droppedCount++;
+            break;
+        }
+    }
+
+    m_queue.enqueue(record);
+    if (m_queue.size() >= m_batchSize) {
+        m_queueReady.wakeOne();
+    }
+    return true;
+}
+
+void AuditLogWriter::flush()
+{
+    QMutexLocker locker(&m_queueMutex);
+    if (!isRunning()) {
+        return;
+    }
+    m_flushRequested = true;
+    m_queueReady.wakeOne();
+    while (!m_queue.isEmpty() || m_writing) {
+        m_queueDrained.wait(&m_queueMutex);
+    }
+}
+
+void AuditLogWriter::stop()
+{
+    {
+        QMutexLocker locker(&m_queueMutex);
+        m_stopping = true;
+        m_queueReady.wakeOne();
+        m_queueNotFull.wakeAll();
+    }
+    wait();
+}
+
+quint64 AuditLogWriter::droppedCount() const
+{
+    QMutexLocker locker(&m_queueMutex);
+    return m_droppedCount;
+}
+
+void AuditLogWriter::run()
+{
+    // 暂存在写入线程内创建，启动时即可回放上次遗留的事件
+    if (!m_spool) {
+        m_spool = new AuditLogSpool(m_spoolDir, m_spoolSegmentBytes, m_spoolMaxBytes);
+    }
+
+    forever {
+        QList<SysLogRecord> batch;
+        {
+            QMutexLocker locker(&m_queueMutex);
+            // 未达批量阈值时最多等待一个刷新周期
+            if (m_queue.size() < m_batchSize && !m_stopping && !m_flushRequested) {
+                m_queueReady.wait(&m_queueMutex, static_cast<unsigned long>(m_flushIntervalMs));
+            }
+            while (!m_queue.isEmpty() && batch.size() < m_batchSize) {
+                batch.append(m_queue.dequeue());
+            }
+            if (batch.isEmpty()) {
+                m_flushRequested = false;
+                m_queueDrained.wakeAll();
+                if (m_stopping) {
+                    break;
+                }
+            } else {
+                m_writing = true;
+                m_queueNotFull.wakeAll();
+            }
+
+            if (m_droppedCount != m_reportedDropped) {
+                qWarning() << QString("审计日志队列已满，累计丢弃%1条").arg(m_droppedCount);
+                m_reportedDropped = m_droppedCount;
+            }
+        }
+
+        if (batch.isEmpty()) {
+            // 空闲时回放暂存
+            if (m_spool->hasPending() && retryDue()) {
+                replaySpool();
+            }
+            continue;
+        }
+
+        writeBatch(batch);
+
+        {
+            QMutexLocker locker(&m_queueMutex);
+            m_writing = false;
+            if (m_queue.isEmpty()) {
+                m_flushRequested = false;
+                m_queueDrained.wakeAll();
+            }
+        }
+    }
+}
+
+bool AuditLogWriter::retryDue() const
+{
+    return !m_retryTimer.isValid() || m_retryTimer.elapsed() >= m_retryIntervalMs;
+}
+
+bool AuditLogWriter::writeBatch(const QList<SysLogRecord> &batch)
+{
+    // 有暂存且未到重试时间：直接落盘，保持顺序且不在数据库不可用时反复等待连接超时
+    if (m_spool->hasPending() && (!retryDue() || !replaySpool())) {
+        return m_spool->append(batch);
+    }
+
+    LogDbHelper dbHelper;
+    int done = insertBatch(dbHelper, batch);
+    if (done == batch.size()) {
+        return true;
+    }
+
+    QList<SysLogRecord> rest = batch.mid(done);
+    qWarning() << QString("审计日志批量写入失败（数据库不可用），转存本地：%1条").arg(rest.size());
+    m_retryTimer.start();
+    return m_spool->append(rest);
+}
+
+bool AuditLogWriter::dbUnavailable()
+{
+    BaseDbHelper *baseDbHelper = BaseDbHelper::getInstance();
+    return isConnectionError(baseDbHelper->lastSqlError()) || !baseDbHelper->checkDbConn();
+}
+
+int AuditLogWriter::insertBatch(LogDbHelper &dbHelper, const QList<SysLogRecord> &batch)
+{
+    if (batch.isEmpty() || dbHelper.insertLogBatch(batch)) {
+        return batch.size();
+    }
+    QString error = BaseDbHelper::getInstance()->getLastError();
+    if (dbUnavailable()) {
+        return 0;
+    }
+
+    // 数据库可用但语句被拒绝：整批回滚，拆半定位坏记录，其余记录照常写入
+    if (batch.size() == 1) {
+        qWarning() << QString("审计日志记录被数据库拒绝，转入死信文件%1：%2")
+                      .arg(m_spool->quarantinePath(), error);
+        if (!m_spool->quarantine(batch, error)) {
+            qCritical() << "审计日志死信写入失败，丢弃1条记录";
+        }
+        return 1;
+    }
+    int half = batch.size() / 2;
+    int done = insertBatch(dbHelper, batch.mid(0, half));
+    if (done < half) {
+        return done;
+    }
+    return half + insertBatch(dbHelper, batch.mid(half));
+}
+
+bool AuditLogWriter::replaySpool()
+{
+    m_retryTimer.start();
+    if (!BaseDbHelper::getInstance()->checkDbConn()) {
+        return false;
+    }
+
+    LogDbHelper dbHelper;
+    int replayed = m_spool->replay(m_batchSize, [this, &dbHelper](const QList<SysLogRecord> &chunk) {
+        return insertBatch(dbHelper, chunk);
+    });
+    if (replayed > 0) {
+        qInfo() << QString("审计日志暂存回放完成：%1条").arg(replayed);
+    }
+    if (m_spool->hasPending()) {
+        return false;
+    }
+    m_retryTimer.invalidate();
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef AUDITLOGWRITER_H
+#define AUDITLOGWRITER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QElapsedTimer>
+#include "logdbhelper.h"
+
+class AuditLogSpool;
+
+// 队列满时的处理策略
+enum AuditOverflowPolicy {
+    OVERFLOW_DROP_OLDEST, // 丢弃最早的事件（默认，不阻塞调用方）
+    OVERFLOW_DROP_NEWEST, // 丢弃新事件
+    OVERFLOW_BLOCK        // 阻塞调用方直到有空位（最多m_blockTimeoutMs）
+};
+
+// 审计日志后台写入线程：调用方仅入队，由本线程按条数/时间阈值合并为多行INSERT写入sys_log
+class AuditLogWriter : public QThread
+{
+    Q_OBJECT
+public:
+    explicit AuditLogWriter(QObject *parent = nullptr);
+    ~AuditLogWriter() override;
+
+    // 入队（线程安全），返回false表示被丢弃或写入线程已停止
+    bool enqueue(const SysLogRecord &record);
+    // 阻塞直到当前已入队的事件全部写出
+    void flush();
+    // 停止线程：拒绝新事件，写完队列中剩余事件后退出
+    void stop();
+
+    quint64 droppedCount() const;
+
+protected:
+    void run() override;
+
+private:
+    // 读取config.ini的[AuditLog]节
+    void readWriterConfig();
+    // 写入一批事件（在写入线程调用），数据库不可用时转存本地暂存
+    bool writeBatch(const QList<SysLogRecord> &batch);
+    // 写入数据库：语句/数据错误时二分拆批，被拒绝的记录转入死信文件
+    // 返回已处理（写入或隔离）的前缀条数，小于batch条数表示数据库不可用
+    int insertBatch(LogDbHelper &dbHelper, const QList<SysLogRecord> &batch);
+    // 最近一次写入失败是否因为数据库不可用（连接类错误或连接检测失败）
+    bool dbUnavailable();
+    // 数据库恢复后回放暂存事件，返回暂存是否已清空
+    bool replaySpool();
+    // 是否到了重试数据库的时间
+    bool retryDue() const;
+
+    mutable QMutex m_queueMutex;
+    QWaitCondition m_queueReady;   // 达到批量阈值/请求刷新/停止
+    QWaitCondition m_queueNotFull; // 阻塞策略下等待空位
+    QWaitCondition m_queueDrained; // 队列写空（flush等待）
+    QQueue<SysLogRecord> m_queue;
+    bool m_stopping = false;
+    bool m_flushRequested = false;
+    bool m_writing = false;        // 写入线程是否持有未写完的批次
+    quint64 m_droppedCount = 0;
+    quint64 m_reportedDropped = 0;
+
+    // 配置
+    int m_batchSize = 50;          // 单批最大条数
+    int m_flushIntervalMs = 1000;  // 最长攒批时间
+    int m_queueCapacity = 10000;   // 队列容量
+    int m_blockTimeoutMs = 200;    // 阻塞策略最长等待
+    AuditOverflowPolicy m_overflowPolicy = OVERFLOW_DROP_OLDEST;
+
+    // 本地暂存（仅写入线程访问）
+    AuditLogSpool *m_spool = nullptr;
+    QElapsedTimer m_retryTimer;      // 距上次数据库写入失败的时间
+    int m_retryIntervalMs = 5000;    // 数据库重试间隔
+    QString m_spoolDir;
+    qint64 m_spoolSegmentBytes = 4 * 1024 * 1024;
+    qint64 m_spoolMaxBytes = 256 * 1024 * 1024;
+};
+
+#endif // AUDITLOGWRITER_H
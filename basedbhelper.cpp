@@ -1,79 +1,58 @@
 #include "BaseDbHelper.h"
-#include <QSettings>
 #include <QCoreApplication>
 #include <QSqlError>
 #include <QCryptographicHash>
 #include "loghelper.h"
 #include <QSqlQuery>
-#include <QFile>
+#include <QSqlRecord>
 
-// 定义常量
-const QString DB_CONNECT_NAME = "MYSQL_CONN";
+// 多行INSERT单条语句的最大行数（分块行数为2的幂，最多占用6条缓存语句）
+static const int MULTI_ROW_CHUNK = 32;
 
 // 初始化静态成员
 BaseDbHelper* BaseDbHelper::m_pInstance = nullptr;
 QMutex BaseDbHelper::m_mutex;
 
-// 私有构造函数：仅初始化连接+读取配置
+// 私有构造函数：连接参数与池参数由连接池读取配置文件
 BaseDbHelper::BaseDbHelper(QObject *parent) : QObject(parent)
 {
-    // 初始化数据库连接
-    if(QSqlDatabase::contains(DB_CONNECT_NAME))
-    {
-        m_db = QSqlDatabase::database(DB_CONNECT_NAME);
-        // 复用连接时，也重新读取配置（防止配置修改后不生效）
-        readDbConfig();
-    }
-    else
-    {
-        // 先创建连接 → 再读配置 → 配置参数直接绑定到已存在的m_db对象
-        m_db = QSqlDatabase::addDatabase("QMYSQL", DB_CONNECT_NAME);
-        readDbConfig(); // 读取配置文件
-    }
-    // 打印连接参数（调试用，确认配置生效）
-    LOG_DEBUG("数据库模块", "数据库连接参数绑定成功："
-             << "用户：" << m_db.userName()
-             << "主机：" << m_db.hostName()
-             << "库名：" << m_db.databaseName());
+    m_pool = DbConnectionPool::getInstance();
 }
 
-// 析构函数：安全关闭连接
+// 析构函数：连接由连接池统一关闭
 BaseDbHelper::~BaseDbHelper()
 {
-    if(m_db.isOpen())
-    {
-        m_db.close();
+}
+
+BaseDbHelper::ThreadState *BaseDbHelper::threadState()
+{
+    if (!m_threadState.hasLocalData()) {
+        m_threadState.setLocalData(new ThreadState);
     }
-    releaseInstance();
+    return m_threadState.localData();
 }
 
-// 读取数据库配置（通用层内部逻辑）
-void BaseDbHelper::readDbConfig()
+// 事务中复用事务连接，保证同一事务的语句落在同一连接上
+PooledConnection BaseDbHelper::connection()
 {
-    QString configPath = QCoreApplication::applicationDirPath() + "/config.ini";
-    if(!QFile::exists(configPath))
-    {
-        qCritical() << "配置文件不存在：" << configPath << "，使用默认参数！";
-        return;
+    ThreadState *state = threadState();
+    if (state->txConn.isValid()) {
+        return state->txConn;
+    }
+    PooledConnection conn = m_pool->acquire();
+    if (!conn.isValid()) {
+        state->lastError = QSqlError("", "获取数据库连接失败", QSqlError::ConnectionError);
     }
+    return conn;
+}
 
-    QSettings config(configPath, QSettings::IniFormat);
-    config.beginGroup("Database");
-    // 读取配置项，可带默认值兜底
-    QString hostName = config.value("HostName").toString();
-    int port = config.value("Port").toInt();
-    QString dbName = config.value("DatabaseName").toString();
-    QString userName = config.value("UserName").toString();
-    QString password = config.value("Password").toString();
-    config.endGroup();
-
-    // 设置连接参数
-    m_db.setHostName(hostName);
-    m_db.setPort(port);
-    m_db.setDatabaseName(dbName);
-    m_db.setUserName(userName);
-    m_db.setPassword(password);
-    m_db.setConnectOptions("MYSQL_OPT_CONNECT_TIMEOUT=30"); // 连接超时
+void BaseDbHelper::recordResult(const QSqlQuery &query, bool ok)
+{
+    ThreadState *state = threadState();
+    state->lastError = query.lastError();
+    if (ok) {
+        state->lastInsertId = query.lastInsertId();
+    }
 }
 
 // 线程安全的单例获取
@@ -103,16 +82,16 @@ void BaseDbHelper::releaseInstance()
     m_mutex.unlock();
 }
 
-// 连接检测+自动重连
+// 连接检测+自动重连（由连接池借出时完成）
 bool BaseDbHelper::checkDbConn()
 {
-    if(m_db.isOpen()) return true;
-    bool ok = m_db.open();
-    if(!ok)
+    PooledConnection conn = connection();
+    if (!conn.isValid())
     {
         qCritical() << "数据库连接失败：" << getLastError();
+        return false;
     }
-    return ok;
+    return true;
 }
 
 // MD5密码加密（通用工具）
@@ -132,60 +111,193 @@ QString BaseDbHelper::encryptPwd(const QString &pwd)
 // ========== 通用SQL执行接口（无业务逻辑） ==========
 bool BaseDbHelper::execSql(const QString &sql)
 {
-    if(!checkDbConn()) return false;
-    QSqlQuery query(m_db);
-    return query.exec(sql);
+    PooledConnection conn = connection();
+    if(!conn.isValid()) return false;
+    QSqlQuery query(conn.database());
+    bool ok = query.exec(sql);
+    recordResult(query, ok);
+    return ok;
 }
 
-QSqlQuery BaseDbHelper::execQuery(const QString &sql)
+// 返回的结果持有连接租约，调用方遍历完（DbQuery销毁）后才归还连接
+DbQuery BaseDbHelper::execQuery(const QString &sql)
 {
-    QSqlQuery query(m_db);
-    if(checkDbConn())
+    PooledConnection conn = connection();
+    if(!conn.isValid()) return DbQuery(threadState()->lastError);
+    QSqlQuery query(conn.database());
+    recordResult(query, query.exec(sql));
+    return DbQuery(query, conn);
+}
+
+// 使用连接的预处理语句缓存执行：命中时跳过prepare往返；命中语句执行失败（如重连后句柄失效）则重新prepare重试一次
+bool BaseDbHelper::execCachedStatement(const PooledConnection &conn, const QString &sql,
+                                       const QVariantList &params, QSqlQuery &query)
+{
+    bool hit = false;
+    query = conn.cachedStatement(sql, &hit);
+    for(int i=0; i<params.size(); i++)
     {
-        query.exec(sql);
+        query.bindValue(i, params.at(i));
     }
-    return query;
+    bool ok = query.exec();
+    if(!ok && hit)
+    {
+        conn.evictStatement(sql);
+        query = conn.cachedStatement(sql);
+        for(int i=0; i<params.size(); i++)
+        {
+            query.bindValue(i, params.at(i));
+        }
+        ok = query.exec();
+    }
+    recordResult(query, ok);
+    return ok;
 }
 
 bool BaseDbHelper::execPrepareSql(const QString &sql, const QVariantList &params)
 {
-    if(!checkDbConn()) return false;
-    QSqlQuery query(m_db);
+    PooledConnection conn = connection();
+    if(!conn.isValid()) return false;
+    QSqlQuery query;
+    bool ok = execCachedStatement(conn, sql, params, query);
+    query.finish(); // 释放结果集，语句留在缓存中复用
+    return ok;
+}
+
+bool BaseDbHelper::execPrepareSqlRows(const QString &sqlHead, const QString &rowHolder, int columns, const QVariantList &params)
+{
+    int rows = columns > 0 ? params.size() / columns : 0;
+    if(rows == 0) return true;
+    PooledConnection conn = connection();
+    if(!conn.isValid()) return false;
+
+    // 行数不是单块可容纳的2的幂时需要多条语句，未处于事务中则自行开启事务保证整体原子
+    ThreadState *state = threadState();
+    bool multiChunk = rows > MULTI_ROW_CHUNK || (rows & (rows - 1)) != 0;
+    bool ownTx = multiChunk && !state->txConn.isValid();
+    QSqlDatabase db = conn.database();
+    if(ownTx && !db.transaction())
+    {
+        state->lastError = db.lastError();
+        return false;
+    }
+
+    bool ok = true;
+    int offset = 0;
+    while(ok && offset < rows)
+    {
+        int chunk = MULTI_ROW_CHUNK;
+        while(chunk > rows - offset) chunk /= 2;
+        QStringList holders;
+        for(int i=0; i<chunk; i++) holders << rowHolder;
+        QSqlQuery query;
+        ok = execCachedStatement(conn, sqlHead + holders.join(", "),
+                                 params.mid(offset * columns, chunk * columns), query);
+        query.finish();
+        offset += chunk;
+    }
+
+    if(ownTx)
+    {
+        if(ok && !db.commit())
+        {
+            state->lastError = db.lastError();
+            ok = false;
+        }
+        if(!ok)
+        {
+            db.rollback(); // 保留语句的错误信息，供调用方区分连接错误与数据错误
+        }
+    }
+    return ok;
+}
+
+DbQuery BaseDbHelper::execPrepareQuery(const QString &sql, const QVariantList &params)
+{
+    PooledConnection conn = connection();
+    if(!conn.isValid()) return DbQuery(threadState()->lastError);
+    QSqlQuery query(conn.database());
     query.prepare(sql);
     for(int i=0; i<params.size(); i++)
     {
         query.bindValue(i, params.at(i));
     }
-    return query.exec();
+    recordResult(query, query.exec());
+    return DbQuery(query, conn);
 }
 
-QSqlQuery BaseDbHelper::execPrepareQuery(const QString &sql, const QVariantList &params)
+// 执行并物化结果（语句走缓存，结果集读完即释放，可安全复用语句）
+DbQueryResult BaseDbHelper::execPrepareQueryResult(const QString &sql, const QVariantList &params)
 {
-    QSqlQuery query(m_db);
-    if(checkDbConn())
+    DbQueryResult result;
+    PooledConnection conn = connection();
+    if(!conn.isValid())
     {
-        query.prepare(sql);
-        for(int i=0; i<params.size(); i++)
+        result.error = getLastError();
+        return result;
+    }
+
+    QSqlQuery query;
+    result.success = execCachedStatement(conn, sql, params, query);
+    if(result.success)
+    {
+        result.lastInsertId = query.lastInsertId();
+        result.numRowsAffected = query.numRowsAffected();
+        if(query.isSelect())
         {
-            query.bindValue(i, params.at(i));
+            while(query.next())
+            {
+                result.rows.append(query.record());
+            }
         }
-        query.exec();
     }
-    return query;
+    else
+    {
+        result.error = getLastError();
+    }
+    query.finish();
+    return result;
+}
+
+// ========== 异步SQL执行接口（转交异步执行器） ==========
+quint64 BaseDbHelper::execQueryAsync(const QString &sql, QObject *context, DbResultCallback callback, int timeoutMs)
+{
+    return execPrepareQueryAsync(sql, QVariantList(), context, callback, timeoutMs);
+}
+
+quint64 BaseDbHelper::execPrepareQueryAsync(const QString &sql, const QVariantList &params,
+                                            QObject *context, DbResultCallback callback, int timeoutMs)
+{
+    return DbAsyncExecutor::getInstance()->execPrepareQueryAsync(sql, params, context, callback, timeoutMs);
+}
+
+void BaseDbHelper::cancelAsync(quint64 requestId)
+{
+    DbAsyncExecutor::getInstance()->cancel(requestId);
 }
 
-// ========== 通用事务接口 ==========
+// ========== 通用事务接口（事务连接按线程固定） ==========
 bool BaseDbHelper::beginTransaction()
 {
-    QMutexLocker locker(&m_mutex);
-    if(!checkDbConn()) return false;
-    if(m_db.transaction())
+    ThreadState *state = threadState();
+    if(state->txConn.isValid())
     {
+        LOG_ERROR("数据库模块", "事务开始失败：当前线程已有未结束的事务");
+        return false;
+    }
+    PooledConnection conn = connection();
+    if(!conn.isValid()) return false;
+
+    QSqlDatabase db = conn.database();
+    if(db.transaction())
+    {
+        state->txConn = conn;
         LOG_INFO("数据库模块", "事务开始成功");
         return true;
     }
     else
     {
+        state->lastError = db.lastError();
         LOG_ERROR("数据库模块", "事务开始失败：" << getLastError());
         return false;
     }
@@ -193,35 +305,41 @@ bool BaseDbHelper::beginTransaction()
 
 bool BaseDbHelper::commitTransaction()
 {
-    QMutexLocker locker(&m_mutex);
-    if(!m_db.isOpen()) return false;
-    if(m_db.commit())
+    ThreadState *state = threadState();
+    if(!state->txConn.isValid()) return false;
+    QSqlDatabase db = state->txConn.database();
+    bool ok = db.commit();
+    if(ok)
     {
         LOG_DEBUG("数据库模块", "事务提交成功");
-        return true;
     }
     else
     {
+        state->lastError = db.lastError();
         LOG_ERROR("数据库模块", "事务提交失败，自动回滚：" << getLastError());
-        m_db.rollback();
-        return false;
+        db.rollback();
     }
+    state->txConn.release();
+    return ok;
 }
 
 bool BaseDbHelper::rollbackTransaction()
 {
-    QMutexLocker locker(&m_mutex);
-    if(!m_db.isOpen()) return false;
-    if(m_db.rollback())
+    ThreadState *state = threadState();
+    if(!state->txConn.isValid()) return false;
+    QSqlDatabase db = state->txConn.database();
+    bool ok = db.rollback();
+    if(ok)
     {
         LOG_DEBUG("数据库模块", "事务回滚成功");
-        return true;
     }
     else
     {
+        state->lastError = db.lastError();
         LOG_ERROR("数据库模块", "事务回滚失败：" << getLastError());
-        return false;
     }
+    state->txConn.release();
+    return ok;
 }
 
 bool BaseDbHelper::execBatchSql(const QStringList &sqlList)
@@ -229,13 +347,14 @@ bool BaseDbHelper::execBatchSql(const QStringList &sqlList)
     if(sqlList.isEmpty()) return false;
     if(!beginTransaction()) return false;
 
-    QSqlQuery query(m_db);
+    QSqlQuery query(connection().database());
     bool allSuccess = true;
     for(const QString &sql : sqlList)
     {
         if(!query.exec(sql))
         {
             allSuccess = false;
+            recordResult(query, false);
             qCritical() << "批量执行SQL失败：" << sql << "错误：" << query.lastError().text();
             break;
         }
@@ -249,8 +368,7 @@ bool BaseDbHelper::execBatchPrepareSql(const QString &sql, const QList<QVariantL
     if(sql.isEmpty() || paramsList.isEmpty()) return false;
     if(!beginTransaction()) return false;
 
-    QSqlQuery query(m_db);
-    query.prepare(sql);
+    QSqlQuery query = connection().cachedStatement(sql);
     bool allSuccess = true;
     for(const QVariantList &params : paramsList)
     {
@@ -261,6 +379,7 @@ bool BaseDbHelper::execBatchPrepareSql(const QString &sql, const QList<QVariantL
         if(!query.exec())
         {
             allSuccess = false;
+            recordResult(query, false);
             qCritical() << "批量预处理SQL失败：" << query.lastError().text();
             break;
         }
@@ -272,5 +391,16 @@ bool BaseDbHelper::execBatchPrepareSql(const QString &sql, const QList<QVariantL
 // 错误信息获取
 QString BaseDbHelper::getLastError()
 {
-    return QString("错误码：%1 \n错误信息：%2").arg(m_db.lastError().number()).arg(m_db.lastError().text());
+    const QSqlError &error = threadState()->lastError;
+    return QString("错误码：%1 \n错误信息：%2").arg(error.nativeErrorCode()).arg(error.text());
+}
+
+QSqlError BaseDbHelper::lastSqlError()
+{
+    return threadState()->lastError;
+}
+
+QVariant BaseDbHelper::lastInsertId()
+{
+    return threadState()->lastInsertId;
 }
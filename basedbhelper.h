@@ -6,8 +6,31 @@
 #include <QMutex>
 #include <QStringList>
 #include <QVariantList>
+#include <QSqlError>
+#include <QThreadStorage>
+#include "dbconnectionpool.h"
+#include "dbasyncexecutor.h"
+
+// 带连接租约的查询结果：遍历期间连接保持借出，不会被同线程再次借出或被空闲回收，
+// 该对象及其拷贝全部销毁后才归还连接池。须用DbQuery接收，赋值给QSqlQuery会丢失租约
+class DbQuery : public QSqlQuery
+{
+public:
+    DbQuery() = default;
+    DbQuery(const QSqlQuery &query, const PooledConnection &conn) : QSqlQuery(query), m_conn(conn) {}
+    // 未取得连接时构造：语句未执行，lastError()返回连接错误
+    explicit DbQuery(const QSqlError &connError) : m_connError(connError) {}
+
+    // 覆盖QSqlQuery::lastError：未取得连接时返回连接错误，避免调用方把连接失败当成空结果
+    QSqlError lastError() const { return m_connError.isValid() ? m_connError : QSqlQuery::lastError(); }
+
+private:
+    PooledConnection m_conn;
+    QSqlError m_connError;
+};
 
 // 通用数据库助手：仅处理连接、事务、通用SQL执行，无任何业务逻辑
+// 连接由DbConnectionPool按线程提供，各接口可在任意线程调用
 class BaseDbHelper : public QObject
 {
     Q_OBJECT
@@ -15,7 +38,15 @@ private:
     explicit BaseDbHelper(QObject *parent = nullptr);
     ~BaseDbHelper() override;
 
-    QSqlDatabase m_db;                  // 数据库连接对象
+    // 线程私有状态：错误信息、自增ID、事务期间固定的连接
+    struct ThreadState {
+        QSqlError lastError;
+        QVariant lastInsertId;
+        PooledConnection txConn;
+    };
+
+    DbConnectionPool *m_pool;                   // 连接池
+    QThreadStorage<ThreadState*> m_threadState; // 每线程状态
     static BaseDbHelper* m_pInstance;   // 单例对象
     static QMutex m_mutex;              // 线程安全锁
 
@@ -32,9 +63,20 @@ public:
 
     // ========== 通用SQL执行接口（所有业务层都依赖这些接口） ==========
     bool execSql(const QString &sql);
-    QSqlQuery execQuery(const QString &sql);
+    DbQuery execQuery(const QString &sql);
     bool execPrepareSql(const QString &sql, const QVariantList &params);
-    QSqlQuery execPrepareQuery(const QString &sql, const QVariantList &params);
+    // 多行INSERT：sqlHead为“INSERT ... VALUES ”，rowHolder为单行占位符，params按行展开（每行columns个）
+    // 按固定行数（32/16/8/4/2/1）分块执行，每种行数只占用一条缓存语句；多块时在同一事务内执行，整体成功或失败
+    bool execPrepareSqlRows(const QString &sqlHead, const QString &rowHolder, int columns, const QVariantList &params);
+    DbQuery execPrepareQuery(const QString &sql, const QVariantList &params);
+    // 执行并一次性读出结果（走预处理语句缓存，适合工作线程/热点语句）
+    DbQueryResult execPrepareQueryResult(const QString &sql, const QVariantList &params);
+
+    // ========== 异步SQL执行接口（数据库工作线程执行，结果回到context所在线程；超时语义见DbAsyncExecutor） ==========
+    quint64 execQueryAsync(const QString &sql, QObject *context, DbResultCallback callback, int timeoutMs = 0);
+    quint64 execPrepareQueryAsync(const QString &sql, const QVariantList &params,
+                                  QObject *context, DbResultCallback callback, int timeoutMs = 0);
+    void cancelAsync(quint64 requestId);
 
     // ========== 事务接口（通用） ==========
     bool beginTransaction();
@@ -43,12 +85,22 @@ public:
     bool execBatchSql(const QStringList &sqlList);
     bool execBatchPrepareSql(const QString &sql, const QList<QVariantList> &paramsList);
 
-    // 错误信息获取
+    // 错误信息获取（当前线程最近一次操作）
     QString getLastError();
+    QSqlError lastSqlError();
+    // 当前线程最近一次插入的自增ID（替代SELECT LAST_INSERT_ID()，与连接无关）
+    QVariant lastInsertId();
 
 private:
-    // 读取配置文件（通用层内部处理，业务层无需关心）
-    void readDbConfig();
+    // 当前线程状态（懒创建）
+    ThreadState* threadState();
+    // 获取连接：事务中返回事务连接，否则从连接池借出
+    PooledConnection connection();
+    // 记录执行结果到线程状态
+    void recordResult(const QSqlQuery &query, bool ok);
+    // 通过连接的预处理语句缓存绑定参数并执行
+    bool execCachedStatement(const PooledConnection &conn, const QString &sql,
+                             const QVariantList &params, QSqlQuery &query);
 };
 
 #endif // BASEDBHELPER_H
@@ -0,0 +1,23 @@
+# LLM对话链路基准测试：本地模拟 chat/completions 接口（非流式/SSE），统计请求组装、网络、解析、渲染耗时
+# 构建：qmake llm_bench.pro && make
+# 运行：llm_bench [--requests 10] [--delay 300] [--tps 50] [--history 10]（无显示环境时加 -platform offscreen）
+# 只启动模拟接口：llm_bench --serve 18080，再把API配置中的地址改为 http://127.0.0.1:18080/v4/chat/completions
+QT += core gui network
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = llm_bench
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    mockllmserver.cpp \
+    ../../llmstreamparser.cpp \
+    ../../markdownrenderer.cpp
+
+HEADERS += \
+    mockllmserver.h \
+    ../../llmstreamparser.h \
+    ../../markdownrenderer.h
@@ -0,0 +1,226 @@
+#include <QGuiApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextStream>
+#include "llmstreamparser.h"
+#include "markdownrenderer.h"
+#include "mockllmserver.h"
+
+// 单次请求的各阶段耗时（毫秒）
+struct RequestTiming {
+    double buildMs = 0;     // 组装并序列化请求
+    double firstByteMs = 0; // 发出请求到收到首个增量（非流式为收到完整响应）
+    double totalMs = 0;     // 发出请求到渲染完成
+    double parseMs = 0;     // SSE/JSON解析
+    double renderMs = 0;    // Markdown渲染 + 写入QTextDocument
+    int chars = 0;
+};
+
+// 与 LLMWidget::extractDeltaFromChunk 相同的解析
+static QString extractDelta(const QString &data)
+{
+    QJsonDocument doc = QJsonDocument::fromJson(data.toUtf8());
+    QJsonArray choices = doc.object()["choices"].toArray();
+    if (choices.isEmpty()) return "";
+    return choices[0].toObject()["delta"].toObject()["content"].toString();
+}
+
+// 与 LLMWidget::extractFullContentFromResponse 相同的解析
+static QString extractContent(const QByteArray &data)
+{
+    QJsonArray choices = QJsonDocument::fromJson(data).object()["choices"].toArray();
+    if (choices.isEmpty()) return "";
+    return choices[0].toObject()["message"].toObject()["content"].toString();
+}
+
+// 模拟history轮历史对话的请求体
+static QByteArray buildRequest(int history, bool stream)
+{
+    QJsonArray messages;
+    QJsonObject systemMsg;
+    systemMsg["role"] = "system";
+    systemMsg["content"] = "你是一个有用的AI助手，专注于李雅普诺夫函数控制器算法的数据分析。";
+    messages.append(systemMsg);
+    for (int i = 0; i < history; i++) {
+        QJsonObject user;
+        user["role"] = "user";
+        user["content"] = QString("第%1轮：请分析本次训练的收敛情况和验证结果。").arg(i + 1);
+        QJsonObject assistant;
+        assistant["role"] = "assistant";
+        assistant["content"] = QString("## 分析\n收敛轮次为 **%1**，验证通过率 98.7%。\n").arg(1000 + i).repeated(8);
+        messages.append(user);
+        messages.append(assistant);
+    }
+    QJsonObject user;
+    user["role"] = "user";
+    user["content"] = "请给出下一步的调参建议。";
+    messages.append(user);
+
+    QJsonObject req;
+    req["model"] = "mock-model";
+    req["temperature"] = 0.0;
+    req["stream"] = stream;
+    req["messages"] = messages;
+    return QJsonDocument(req).toJson(QJsonDocument::Compact);
+}
+
+// 按LLMWidget的方式执行一次请求：流式时已完整的块插入富文本，未完整部分暂按纯文本显示
+static RequestTiming runRequest(QNetworkAccessManager &manager, const QUrl &url, int history, bool stream)
+{
+    RequestTiming timing;
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer stage;
+
+    stage.start();
+    QByteArray body = buildRequest(history, stream);
+    timing.buildMs = stage.nsecsElapsed() / 1e6;
+
+    QNetworkRequest req(url);
+    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    req.setRawHeader("Authorization", "Bearer mock");
+    if (stream) req.setRawHeader("Accept", "text/event-stream");
+
+    QTextDocument doc;
+    QTextCursor cursor(&doc);
+    LlmSseParser parser;
+    MarkdownRenderer renderer;
+    int anchor = 0;
+    QString content;
+
+    auto appendDelta = [&](const QString &delta) {
+        if (delta.isEmpty()) return;
+        if (timing.firstByteMs == 0) timing.firstByteMs = total.nsecsElapsed() / 1e6;
+        content += delta;
+        stage.start();
+        QString html = renderer.append(delta);
+        cursor.movePosition(QTextCursor::End);
+        if (html.isEmpty()) {
+            cursor.insertText(delta);
+        } else {
+            cursor.setPosition(anchor);
+            cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+            cursor.removeSelectedText();
+            cursor.insertHtml(html);
+            cursor.movePosition(QTextCursor::End);
+            anchor = cursor.position();
+            cursor.insertText(renderer.pendingSource());
+        }
+        timing.renderMs += stage.nsecsElapsed() / 1e6;
+    };
+    auto parseEvents = [&](const QByteArray &data) {
+        stage.start();
+        QStringList deltas;
+        for (const QString &event : parser.feed(data)) {
+            deltas << extractDelta(event);
+        }
+        timing.parseMs += stage.nsecsElapsed() / 1e6;
+        for (const QString &delta : deltas) appendDelta(delta);
+    };
+
+    QNetworkReply *reply = manager.post(req, body);
+    QEventLoop loop;
+    if (stream) {
+        QObject::connect(reply, &QNetworkReply::readyRead, [&]() { parseEvents(reply->readAll()); });
+    }
+    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    if (stream) {
+        parseEvents(reply->readAll());
+        stage.start();
+        cursor.setPosition(anchor);
+        cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+        cursor.removeSelectedText();
+        cursor.insertHtml(renderer.finish());
+        timing.renderMs += stage.nsecsElapsed() / 1e6;
+    } else {
+        timing.firstByteMs = total.nsecsElapsed() / 1e6;
+        QByteArray data = reply->readAll();
+        stage.start();
+        content = extractContent(data);
+        timing.parseMs = stage.nsecsElapsed() / 1e6;
+        stage.start();
+        cursor.insertHtml(MarkdownRenderer::render(content));
+        timing.renderMs = stage.nsecsElapsed() / 1e6;
+    }
+    reply->deleteLater();
+
+    timing.totalMs = total.nsecsElapsed() / 1e6;
+    timing.chars = content.size();
+    return timing;
+}
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+    QCommandLineParser cli;
+    cli.setApplicationDescription("LLM对话链路基准测试（本地模拟接口）");
+    cli.addHelpOption();
+    QCommandLineOption serveOpt("serve", "只启动模拟接口，监听指定端口（供主程序把api_url指向本机）", "port");
+    QCommandLineOption requestsOpt("requests", "每种模式的请求次数", "n", "10");
+    QCommandLineOption delayOpt("delay", "首字延迟（毫秒）", "ms", "300");
+    QCommandLineOption tpsOpt("tps", "输出速率（token/秒，0=不限速）", "n", "50");
+    QCommandLineOption historyOpt("history", "请求中携带的历史轮数", "n", "10");
+    cli.addOptions({ serveOpt, requestsOpt, delayOpt, tpsOpt, historyOpt });
+    cli.process(app);
+
+    MockLlmOptions options;
+    options.firstTokenDelayMs = cli.value(delayOpt).toInt();
+    options.tokensPerSecond = cli.value(tpsOpt).toInt();
+    MockLlmServer server(options);
+    QTextStream out(stdout);
+
+    if (cli.isSet(serveOpt)) {
+        quint16 port = static_cast<quint16>(cli.value(serveOpt).toUInt());
+        if (!server.listen(QHostAddress::LocalHost, port)) {
+            out << "监听失败：" << server.errorString() << "\n";
+            return 1;
+        }
+        out << "模拟接口已启动：http://127.0.0.1:" << server.serverPort() << "/v4/chat/completions\n";
+        out.flush();
+        return app.exec();
+    }
+
+    if (!server.listen(QHostAddress::LocalHost, 0)) {
+        out << "监听失败：" << server.errorString() << "\n";
+        return 1;
+    }
+    QUrl url(QString("http://127.0.0.1:%1/v4/chat/completions").arg(server.serverPort()));
+    QNetworkAccessManager manager;
+    int requests = qMax(1, cli.value(requestsOpt).toInt());
+    int history = cli.value(historyOpt).toInt();
+
+    out << "delay=" << options.firstTokenDelayMs << "ms tps=" << options.tokensPerSecond
+        << " history=" << history << " requests=" << requests << "\n";
+    out << "mode\tbuild(ms)\tfirst(ms)\ttotal(ms)\tparse(ms)\trender(ms)\tchars\n";
+    for (bool stream : { false, true }) {
+        RequestTiming sum;
+        for (int i = 0; i < requests; i++) {
+            RequestTiming t = runRequest(manager, url, history, stream);
+            sum.buildMs += t.buildMs;
+            sum.firstByteMs += t.firstByteMs;
+            sum.totalMs += t.totalMs;
+            sum.parseMs += t.parseMs;
+            sum.renderMs += t.renderMs;
+            sum.chars = t.chars;
+        }
+        out << (stream ? "stream" : "buffered") << '\t'
+            << QString::number(sum.buildMs / requests, 'f', 3) << '\t'
+            << QString::number(sum.firstByteMs / requests, 'f', 1) << '\t'
+            << QString::number(sum.totalMs / requests, 'f', 1) << '\t'
+            << QString::number(sum.parseMs / requests, 'f', 3) << '\t'
+            << QString::number(sum.renderMs / requests, 'f', 3) << '\t'
+            << sum.chars << '\n';
+        out.flush();
+    }
+    return 0;
+}
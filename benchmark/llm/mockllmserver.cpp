@@ -0,0 +1,179 @@
+#include "mockllmserver.h"
+#include <QTcpSocket>
+#include <QTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QSharedPointer>
+#include <functional>
+
+// 内置回复：覆盖标题、列表、代码块、公式等渲染路径
+static const char *DEFAULT_REPLY =
+    "## 训练结果分析\n"
+    "本次实验的 **学习率** 为 `0.01`，李雅普诺夫函数满足 $V(x) > 0$ 且 $\\dot{V}(x) < 0$。\n"
+    "- 收敛轮次：*1200*\n"
+    "- 最终损失：**0.0031**\n"
+    "- 验证通过率：98.7%\n"
+    "> 注意：验证阶段使用 dReal 求解器，边界区域仍有少量反例。\n"
+    "```\n"
+    "for i in range(N):\n"
+    "    loss = model(x) + alpha * reg\n"
+    "```\n"
+    "$$\n"
+    "V(x) = x^T P x\n"
+    "$$\n"
+    "### 建议\n"
+    "1. 适当增大正则项系数，抑制边界区域的振荡；\n"
+    "2. 对反例附近加密采样后重新训练；\n"
+    "3. 参考：[文档](https://example.com/lyapunov)\n";
+
+static QByteArray sseEvent(const QString &token)
+{
+    QJsonObject delta;
+    delta["content"] = token;
+    QJsonObject choice;
+    choice["index"] = 0;
+    choice["delta"] = delta;
+    QJsonObject root;
+    root["id"] = "mock-chunk";
+    root["object"] = "chat.completion.chunk";
+    root["choices"] = QJsonArray() << choice;
+    return "data: " + QJsonDocument(root).toJson(QJsonDocument::Compact) + "\n\n";
+}
+
+MockLlmServer::MockLlmServer(const MockLlmOptions &options, QObject *parent)
+    : QTcpServer(parent),
+      m_options(options)
+{
+    if (m_options.replyText.isEmpty()) {
+        m_options.replyText = QString::fromUtf8(DEFAULT_REPLY);
+    }
+    m_options.charsPerToken = qMax(1, m_options.charsPerToken);
+    connect(this, &QTcpServer::newConnection, this, &MockLlmServer::onNewConnection);
+}
+
+void MockLlmServer::onNewConnection()
+{
+    while (QTcpSocket *socket = nextPendingConnection()) {
+        connect(socket, &QTcpSocket::readyRead, this, &MockLlmServer::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockLlmServer::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
+    if (!socket) return;
+
+    m_buffers[socket] += socket->readAll();
+    QByteArray body;
+    if (!parseRequest(socket, &body)) return;
+
+    // 每个连接只处理一个请求，响应后关闭
+    m_buffers.remove(socket);
+    disconnect(socket, &QTcpSocket::readyRead, this, &MockLlmServer::onReadyRead);
+    m_requestCount++;
+
+    QJsonObject request = QJsonDocument::fromJson(body).object();
+    if (request["stream"].toBool()) {
+        sendStream(socket);
+    } else {
+        sendBuffered(socket);
+    }
+}
+
+bool MockLlmServer::parseRequest(QTcpSocket *socket, QByteArray *body)
+{
+    const QByteArray &buffer = m_buffers[socket];
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) return false;
+
+    int contentLength = 0;
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    for (const QByteArray &line : lines) {
+        int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "content-length") {
+            contentLength = line.mid(colon + 1).trimmed().toInt();
+        }
+    }
+    if (buffer.size() < headerEnd + 4 + contentLength) return false;
+    *body = buffer.mid(headerEnd + 4, contentLength);
+    return true;
+}
+
+QStringList MockLlmServer::splitTokens() const
+{
+    QStringList tokens;
+    const QString &text = m_options.replyText;
+    for (int pos = 0; pos < text.size(); pos += m_options.charsPerToken) {
+        tokens << text.mid(pos, m_options.charsPerToken);
+    }
+    return tokens;
+}
+
+void MockLlmServer::sendBuffered(QTcpSocket *socket)
+{
+    int tokenCount = splitTokens().size();
+    int delayMs = m_options.firstTokenDelayMs;
+    if (m_options.tokensPerSecond > 0) {
+        delayMs += tokenCount * 1000 / m_options.tokensPerSecond;
+    }
+
+    QString text = m_options.replyText;
+    QTimer::singleShot(delayMs, socket, [socket, text]() {
+        QJsonObject message;
+        message["role"] = "assistant";
+        message["content"] = text;
+        QJsonObject choice;
+        choice["index"] = 0;
+        choice["message"] = message;
+        choice["finish_reason"] = "stop";
+        QJsonObject root;
+        root["id"] = "mock-completion";
+        root["object"] = "chat.completion";
+        root["choices"] = QJsonArray() << choice;
+
+        QByteArray body = QJsonDocument(root).toJson(QJsonDocument::Compact);
+        QByteArray header = "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: application/json; charset=utf-8\r\n"
+                            "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                            "Connection: close\r\n\r\n";
+        socket->write(header + body);
+        socket->disconnectFromHost();
+    });
+}
+
+void MockLlmServer::sendStream(QTcpSocket *socket)
+{
+    socket->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: text/event-stream; charset=utf-8\r\n"
+                  "Cache-Control: no-cache\r\n"
+                  "Connection: close\r\n\r\n");
+
+    const QStringList tokens = splitTokens();
+    QSharedPointer<int> next(new int(0));
+    bool unlimited = m_options.tokensPerSecond <= 0;
+    QTimer *timer = new QTimer(socket);
+    timer->setInterval(unlimited ? 0 : qMax(1, 1000 / m_options.tokensPerSecond));
+
+    // 每次输出一个token（不限速时一次输出全部）
+    std::function<void()> step = [socket, timer, tokens, next, unlimited]() {
+        int burst = unlimited ? tokens.size() : 1;
+        while (burst-- > 0 && *next < tokens.size()) {
+            socket->write(sseEvent(tokens.at((*next)++)));
+        }
+        if (*next >= tokens.size()) {
+            timer->stop();
+            socket->write("data: [DONE]\n\n");
+            socket->disconnectFromHost();
+        }
+    };
+    connect(timer, &QTimer::timeout, socket, step);
+    QTimer::singleShot(m_options.firstTokenDelayMs, timer, [timer, step, next, tokens]() {
+        step();
+        if (*next < tokens.size()) timer->start();
+    });
+}
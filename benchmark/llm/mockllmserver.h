@@ -0,0 +1,50 @@
+#ifndef MOCKLLMSERVER_H
+#define MOCKLLMSERVER_H
+
+#include <QTcpServer>
+#include <QHash>
+#include <QByteArray>
+
+class QTcpSocket;
+
+// 模拟服务的延迟与输出速率
+struct MockLlmOptions {
+    int firstTokenDelayMs = 300;  // 收到请求到输出第一个token的延迟
+    int tokensPerSecond = 50;     // 输出速率（0=不限速，一次性输出）
+    int charsPerToken = 2;        // 每个token对应的字符数（SSE每个事件一个token）
+    QString replyText;            // 回复内容（为空时使用内置的Markdown样例）
+};
+
+/**
+ * @brief 本地模拟的 chat/completions 接口（OpenAI/智谱兼容格式）
+ * 接受任意路径的POST，按请求体中的"stream"字段返回：
+ *  - false：等待 首字延迟 + 全部token的输出时间 后一次性返回JSON
+ *  - true ：text/event-stream，按速率逐个token推送 choices[0].delta.content，最后 data: [DONE]
+ * 响应以关闭连接结束（Connection: close），用于离线测试与基准测试。
+ */
+class MockLlmServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit MockLlmServer(const MockLlmOptions &options, QObject *parent = nullptr);
+
+    // 已处理的请求数
+    int requestCount() const { return m_requestCount; }
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    // 解析出完整请求（头+Content-Length长度的body）后返回true
+    bool parseRequest(QTcpSocket *socket, QByteArray *body);
+    void sendBuffered(QTcpSocket *socket);
+    void sendStream(QTcpSocket *socket);
+    QStringList splitTokens() const;
+
+    MockLlmOptions m_options;
+    QHash<QTcpSocket*, QByteArray> m_buffers;
+    int m_requestCount = 0;
+};
+
+#endif // MOCKLLMSERVER_H
@@ -0,0 +1,135 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QTextStream>
+#include "markdownrenderer.h"
+
+// ========== 原实现（LLMWidget::convertMarkdownToRichText 的正则替换链，仅用于对比） ==========
+static QString legacyProcessLatexFormulas(const QString &text)
+{
+    if (text.isEmpty()) return "";
+    QString result = text;
+    result.replace(QRegularExpression("\\$(.*?)\\$"), "\\\\(\\1\\\\)");
+    result.replace(QRegularExpression("\\$\\$(.*?)\\$\\$", QRegularExpression::DotMatchesEverythingOption), "\\\\[\\1\\\\]");
+    return result;
+}
+
+static QString legacyConvertMarkdownToRichText(const QString &markdown)
+{
+    if (markdown.isEmpty()) return "";
+
+    QString html = legacyProcessLatexFormulas(markdown);
+    html.replace(QRegularExpression("^#{1}\\s+(.*)$", QRegularExpression::MultilineOption),
+                 "<h1 style='color:#2c3e50; margin:8px 0; font-size:18px; font-weight:bold;'>\\1</h1>");
+    html.replace(QRegularExpression("^#{2}\\s+(.*)$", QRegularExpression::MultilineOption),
+                 "<h2 style='color:#34495e; margin:6px 0; font-size:16px; font-weight:bold;'>\\1</h2>");
+    html.replace(QRegularExpression("^#{3}\\s+(.*)$", QRegularExpression::MultilineOption),
+                 "<h3 style='color:#415a77; margin:5px 0; font-size:14px; font-weight:bold;'>\\1</h3>");
+    html.replace(QRegularExpression("^#{4,6}\\s+(.*)$", QRegularExpression::MultilineOption),
+                 "<h4 style='color:#596e8b; margin:4px 0; font-size:13px; font-weight:bold;'>\\1</h4>");
+    html.replace(QRegularExpression("\\*\\*(.*?)\\*\\*"), "<b>\\1</b>");
+    html.replace(QRegularExpression("^(?!\\*)\\*(.*?)\\*(?!\\*)"), "<i>\\1</i>");
+    html.replace(QRegularExpression("```([\\s\\S]*?)```"),
+                 "<pre style='background-color:#f5f5f5; padding:8px; border-radius:4px; margin:8px 0; font-family:Consolas,Monospace; font-size:12px;'>\\1</pre>");
+    html.replace(QRegularExpression("`(.*?)`"),
+                 "<code style='background-color:#f0f0f0; padding:2px 4px; border-radius:2px; font-family:Consolas; font-size:12px;'>\\1</code>");
+    html.replace(QRegularExpression("^(\\s*)-\\s+(.*)$", QRegularExpression::MultilineOption),
+                 "\\1<li style='margin:2px 0; list-style:disc;'>\\2</li>");
+    html.replace(QRegularExpression("^(\\s*)\\*\\s+(.*)$", QRegularExpression::MultilineOption),
+                 "\\1<li style='margin:2px 0; list-style:disc;'>\\2</li>");
+    html.replace(QRegularExpression("(<li>.*?</li>)+", QRegularExpression::DotMatchesEverythingOption),
+                 "<ul style='margin:6px 0; padding-left:25px;'>\\1</ul>");
+    html.replace(QRegularExpression("^---$", QRegularExpression::MultilineOption),
+                 "<hr style='border:0; border-top:1px solid #eee; margin:10px 0;'>");
+    html.replace(QRegularExpression("^>\\s+(.*)$", QRegularExpression::MultilineOption),
+                 "<blockquote style='margin:6px 0; padding:6px 10px; background-color:#f8f9fa; border-left:3px solid #6c757d;'>\\1</blockquote>");
+    html.replace("\n", "<br/>");
+    html.replace(QRegularExpression("\\[([^\\]]+)\\]\\(([^)]+)\\)"),
+                 "<a href='\\2' style='color:#3498db; text-decoration:none;'>\\1</a>");
+    return html;
+}
+
+// ========== 测试数据：模拟较长的AI分析回复 ==========
+static QString makeReply(int targetChars)
+{
+    static const char *section =
+        "## 训练结果分析\n"
+        "本次实验的 **学习率** 为 `0.01`，李雅普诺夫函数满足 $V(x) > 0$ 且 $\\dot{V}(x) < 0$。\n"
+        "- 收敛轮次：*1200*\n"
+        "- 最终损失：**0.0031**\n"
+        "- 参考：[文档](https://example.com/lyapunov)\n"
+        "> 注意：验证阶段使用 dReal 求解器。\n"
+        "```\n"
+        "for i in range(N):\n"
+        "    loss = model(x) + alpha * reg\n"
+        "```\n"
+        "$$\n"
+        "V(x) = x^T P x\n"
+        "$$\n"
+        "---\n";
+    QString unit = QString::fromUtf8(section);
+    QString text;
+    text.reserve(targetChars + unit.size());
+    while (text.size() < targetChars) {
+        text += unit;
+    }
+    return text;
+}
+
+template <typename Fn>
+static double timeMs(int iterations, Fn fn)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; i++) {
+        fn();
+    }
+    return timer.nsecsElapsed() / 1e6 / iterations;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    const int chunkSize = 16; // 流式场景：每个SSE增量约16个字符
+
+    out << "chars\tlegacy_full(ms)\tsinglepass_full(ms)\tlegacy_stream(ms)\tincremental_stream(ms)\n";
+    const QList<int> sizes = { 2000, 8000, 32000, 128000 };
+    for (int size : sizes) {
+        QString reply = makeReply(size);
+        int iterations = qMax(1, 400000 / size);
+
+        volatile int sink = 0;
+        double legacyFull = timeMs(iterations, [&]() { sink += legacyConvertMarkdownToRichText(reply).size(); });
+        double newFull = timeMs(iterations, [&]() { sink += MarkdownRenderer::render(reply).size(); });
+
+        // 流式：原实现只能每来一个增量就整体重渲染；新实现只处理增量
+        QString legacyStream = "-";
+        if (size <= 32000) {
+            double ms = timeMs(1, [&]() {
+                QString acc;
+                for (int pos = 0; pos < reply.size(); pos += chunkSize) {
+                    acc += reply.mid(pos, chunkSize);
+                    sink += legacyConvertMarkdownToRichText(acc).size();
+                }
+            });
+            legacyStream = QString::number(ms, 'f', 2);
+        }
+        double incremental = timeMs(iterations, [&]() {
+            MarkdownRenderer renderer;
+            for (int pos = 0; pos < reply.size(); pos += chunkSize) {
+                sink += renderer.append(reply.mid(pos, chunkSize)).size();
+            }
+            sink += renderer.finish().size();
+        });
+
+        out << reply.size() << '\t'
+            << QString::number(legacyFull, 'f', 3) << '\t'
+            << QString::number(newFull, 'f', 3) << '\t'
+            << legacyStream << '\t'
+            << QString::number(incremental, 'f', 3) << '\n';
+        out.flush();
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+# Markdown渲染性能对比：原正则替换实现 vs MarkdownRenderer单遍渲染
+# 构建：qmake markdown_bench.pro && make，运行输出各长度下的耗时对比
+QT -= gui
+QT += core
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = markdown_bench
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    main.cpp \
+    ../../markdownrenderer.cpp
+
+HEADERS += \
+    ../../markdownrenderer.h
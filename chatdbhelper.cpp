@@ -0,0 +1,250 @@
+#include "chatdbhelper.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include "loghelper.h"
+
+ChatDbHelper::ChatDbHelper(QObject *parent) : QObject(parent)
+{
+    m_baseDbHelper = BaseDbHelper::getInstance();
+}
+
+QList<ChatDialogSummary> ChatDbHelper::loadDialogPage(int userId, const QDateTime &afterTime, int afterId, int pageSize, bool *ok)
+{
+    QList<ChatDialogSummary> dialogs;
+    QString sql;
+    QVariantList params;
+    if (afterId <= 0) {
+        sql = "SELECT id, dialog_title, update_time FROM chat_dialog WHERE user_id = ? "
+              "ORDER BY update_time DESC, id DESC LIMIT ?";
+        params << userId << pageSize;
+    } else {
+        // 用上一页最后一行作为游标，走(user_id, update_time, id)索引，不随页数增加而变慢
+        sql = "SELECT id, dialog_title, update_time FROM chat_dialog WHERE user_id = ? "
+              "AND (update_time < ? OR (update_time = ? AND id < ?)) "
+              "ORDER BY update_time DESC, id DESC LIMIT ?";
+        params << userId << afterTime << afterTime << afterId << pageSize;
+    }
+
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, params);
+    bool success = !query.lastError().isValid();
+    if (ok) *ok = success;
+    if (!success) {
+        LOG_ERROR("LLM模块", "读取对话列表失败：" << query.lastError().text());
+        return dialogs;
+    }
+
+    while (query.next()) {
+        ChatDialogSummary dialog;
+        dialog.id = query.value(0).toInt();
+        dialog.title = query.value(1).toString();
+        dialog.update_time = query.value(2).toDateTime();
+        dialogs.append(dialog);
+    }
+    return dialogs;
+}
+
+QStringList ChatDbHelper::searchTerms(const QString &keyword)
+{
+    QString cleaned = keyword;
+    cleaned.replace(QRegularExpression("[+\\-<>()~*\"@]"), " ");
+    return cleaned.simplified().split(' ', QString::SkipEmptyParts);
+}
+
+QList<ChatSearchHit> ChatDbHelper::searchDialogs(int userId, const QString &keyword, int limit, bool *ok)
+{
+    QList<ChatSearchHit> hits;
+    const QStringList terms = searchTerms(keyword);
+    if (ok) *ok = true;
+    if (terms.isEmpty() || limit <= 0) return hits;
+
+    bool fulltext = true;
+    QStringList booleanTerms;
+    for (const QString &term : terms) {
+        if (term.size() < 2) fulltext = false;
+        booleanTerms << QString("+\"%1\"").arg(term);
+    }
+
+    // 片段：第一个关键词前后约160字，在数据库端截取，不传输整条消息
+    QString select = "SELECT m.dialog_id, d.dialog_title, d.update_time, "
+                     "SUBSTRING(m.content, GREATEST(1, LOCATE(?, m.content) - 40), 160), ";
+    QString sql;
+    QVariantList params;
+    params << terms.first();
+    if (fulltext) {
+        QString against = booleanTerms.join(' ');
+        sql = select + "MATCH(m.content) AGAINST(? IN BOOLEAN MODE) AS score "
+              "FROM chat_message m JOIN chat_dialog d ON d.id = m.dialog_id "
+              "WHERE d.user_id = ? AND MATCH(m.content) AGAINST(? IN BOOLEAN MODE) "
+              "ORDER BY score DESC LIMIT ?";
+        params << against << userId << against;
+    } else {
+        QStringList conditions;
+        for (int i = 0; i < terms.size(); i++) conditions << "m.content LIKE ?";
+        sql = select + "0 AS score "
+              "FROM chat_message m JOIN chat_dialog d ON d.id = m.dialog_id "
+              "WHERE d.user_id = ? AND " + conditions.join(" AND ") + " "
+              "ORDER BY d.update_time DESC, m.seq DESC LIMIT ?";
+        params << userId;
+        for (QString term : terms) {
+            term.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+            params << QString("%%1%").arg(term);
+        }
+    }
+    // 同一对话可能多条消息命中，多取一些再按对话聚合
+    params << limit * 5;
+
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, params);
+    if (query.lastError().isValid()) {
+        if (ok) *ok = false;
+        LOG_ERROR("LLM模块", "搜索对话失败：" << query.lastError().text());
+        return hits;
+    }
+
+    QHash<int, int> indexOfDialog;
+    while (query.next()) {
+        int dialogId = query.value(0).toInt();
+        auto it = indexOfDialog.find(dialogId);
+        if (it != indexOfDialog.end()) {
+            hits[it.value()].hits++;
+            continue;
+        }
+        if (hits.size() >= limit) continue;
+
+        ChatSearchHit hit;
+        hit.dialog_id = dialogId;
+        hit.title = query.value(1).toString();
+        hit.update_time = query.value(2).toDateTime();
+        hit.snippet = query.value(3).toString().simplified();
+        hit.score = query.value(4).toDouble();
+        hit.hits = 1;
+        indexOfDialog.insert(dialogId, hits.size());
+        hits.append(hit);
+    }
+    return hits;
+}
+
+int ChatDbHelper::createDialog(int userId, const QString &title)
+{
+    // dialog_content仅保留给旧数据，新对话的消息写入chat_message
+    QString sql = "INSERT INTO chat_dialog (user_id, dialog_title, dialog_content, update_time) VALUES (?, ?, '', CURRENT_TIMESTAMP)";
+    if (!m_baseDbHelper->execPrepareSql(sql, {userId, title})) {
+        LOG_ERROR("LLM模块", "新建对话失败：" << m_baseDbHelper->getLastError());
+        return -1;
+    }
+    return m_baseDbHelper->lastInsertId().toInt();
+}
+
+bool ChatDbHelper::appendMessages(int dialogId, int userId, const QList<ChatMessage> &messages, bool touchDialog)
+{
+    if (messages.isEmpty()) return true;
+
+    // 按固定行数分块的多行INSERT，避免每种消息条数各占一条缓存语句
+    const QString sqlHead = "INSERT INTO chat_message (dialog_id, seq, role, content, tokens) VALUES ";
+    const QString rowHolder = "(?, ?, ?, ?, ?)";
+    QVariantList params;
+    for (const ChatMessage &message : messages) {
+        params << dialogId << message.seq << message.role << message.content << message.tokens;
+    }
+
+    if (!touchDialog) {
+        return m_baseDbHelper->execPrepareSqlRows(sqlHead, rowHolder, 5, params);
+    }
+
+    // 消息与对话的更新时间在同一事务内提交
+    if (!m_baseDbHelper->beginTransaction()) {
+        return false;
+    }
+    bool ok = m_baseDbHelper->execPrepareSqlRows(sqlHead, rowHolder, 5, params)
+              && m_baseDbHelper->execPrepareSql("UPDATE chat_dialog SET update_time = CURRENT_TIMESTAMP WHERE id = ? AND user_id = ?",
+                                                {dialogId, userId});
+    if (!ok) {
+        LOG_ERROR("LLM模块", "追加对话消息失败：" << m_baseDbHelper->getLastError());
+        m_baseDbHelper->rollbackTransaction();
+        return false;
+    }
+    return m_baseDbHelper->commitTransaction();
+}
+
+QList<ChatMessage> ChatDbHelper::loadMessages(int dialogId, int userId, bool *ok)
+{
+    QList<ChatMessage> messages;
+    QString sql = "SELECT m.id, m.seq, m.role, m.content, m.tokens, m.created_at "
+                  "FROM chat_message m JOIN chat_dialog d ON d.id = m.dialog_id "
+                  "WHERE m.dialog_id = ? AND d.user_id = ? ORDER BY m.seq";
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, {dialogId, userId});
+    bool success = !query.lastError().isValid();
+    if (ok) *ok = success;
+    if (!success) {
+        LOG_ERROR("LLM模块", "读取对话消息失败：" << query.lastError().text());
+        return messages;
+    }
+
+    while (query.next()) {
+        ChatMessage message;
+        message.id = query.value(0).toLongLong();
+        message.dialog_id = dialogId;
+        message.seq = query.value(1).toInt();
+        message.role = query.value(2).toString();
+        message.content = query.value(3).toString();
+        message.tokens = query.value(4).toInt();
+        message.created_at = query.value(5).toDateTime();
+        messages.append(message);
+    }
+    return messages;
+}
+
+QList<ChatMessage> ChatDbHelper::importLegacyDialog(int dialogId, int userId, bool *ok)
+{
+    QList<ChatMessage> messages;
+    DbQuery query = m_baseDbHelper->execPrepareQuery("SELECT dialog_content FROM chat_dialog WHERE id = ? AND user_id = ?",
+                                                       {dialogId, userId});
+    bool success = !query.lastError().isValid();
+    if (ok) *ok = success;
+    if (!success) {
+        LOG_ERROR("LLM模块", "读取旧对话内容失败：" << query.lastError().text());
+        return messages;
+    }
+    if (!query.next()) {
+        return messages;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(query.value(0).toString().toUtf8());
+    if (!doc.isObject()) {
+        return messages;
+    }
+
+    const QJsonArray array = doc.object()["messages"].toArray();
+    for (const QJsonValue &value : array) {
+        QJsonObject obj = value.toObject();
+        QString role = obj["role"].toString();
+        if (role != "user" && role != "assistant") continue; // system提示词不入库
+        ChatMessage message;
+        message.dialog_id = dialogId;
+        message.seq = messages.size() + 1;
+        message.role = role;
+        message.content = obj["content"].toString();
+        message.tokens = estimateTokens(message.content);
+        messages.append(message);
+    }
+
+    // 迁移不改变对话在列表中的顺序
+    if (!messages.isEmpty() && !appendMessages(dialogId, userId, messages, false)) {
+        LOG_WARN("LLM模块", "旧对话迁移失败，对话ID=" << dialogId);
+    }
+    return messages;
+}
+
+int ChatDbHelper::estimateTokens(const QString &text)
+{
+    int ascii = 0;
+    int other = 0;
+    for (QChar c : text) {
+        if (c.unicode() < 128) ascii++;
+        else other++;
+    }
+    return (ascii + 3) / 4 + other;
+}
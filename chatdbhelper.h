@@ -0,0 +1,70 @@
+#ifndef CHATDBHELPER_H
+#define CHATDBHELPER_H
+
+#include <QObject>
+#include <QList>
+#include <QDateTime>
+#include "BaseDbHelper.h"
+
+// chat_message单条消息（对话内按seq递增，只追加不改写）
+struct ChatMessage {
+    qint64 id = 0;
+    int dialog_id = 0;
+    int seq = 0;             // 对话内序号，从1开始
+    QString role;            // user / assistant
+    QString content;         // 原始内容（AI回复为Markdown原文，显示时再渲染）
+    int tokens = 0;          // 估算token数
+    QDateTime created_at;
+};
+
+// 全文搜索结果（按对话聚合）
+struct ChatSearchHit {
+    int dialog_id = 0;
+    QString title;
+    QDateTime update_time;
+    QString snippet;      // 相关度最高的命中消息中关键词附近的片段
+    double score = 0;     // 相关度（取该对话命中消息中的最高分）
+    int hits = 0;         // 命中的消息条数
+};
+
+// 对话列表项（列表只需要标题和排序字段，不读取消息内容）
+struct ChatDialogSummary {
+    int id = 0;
+    QString title;
+    QDateTime update_time;
+};
+
+// 大模型对话业务助手：chat_dialog（对话元数据）+ chat_message（逐条消息）
+class ChatDbHelper : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ChatDbHelper(QObject *parent = nullptr);
+
+    // 按(update_time, id)倒序分页读取对话列表（keyset分页）：
+    // afterId<=0时读第一页，否则读排在(afterTime, afterId)之后的一页
+    QList<ChatDialogSummary> loadDialogPage(int userId, const QDateTime &afterTime, int afterId, int pageSize, bool *ok = nullptr);
+
+    // 全文搜索消息内容（chat_message.content的FULLTEXT ngram索引），按相关度返回最多limit个对话
+    // 关键词以空格分隔、需全部命中；单字关键词低于ngram最小长度，退化为LIKE匹配
+    QList<ChatSearchHit> searchDialogs(int userId, const QString &keyword, int limit, bool *ok = nullptr);
+    // 拆分搜索关键词（去掉全文检索的布尔运算符）
+    static QStringList searchTerms(const QString &keyword);
+
+    // 新建对话，返回对话ID（失败返回-1）
+    int createDialog(int userId, const QString &title);
+    // 追加消息（单条多行INSERT），touchDialog=true时同时刷新对话的update_time
+    bool appendMessages(int dialogId, int userId, const QList<ChatMessage> &messages, bool touchDialog = true);
+    // 按seq顺序读取对话的全部消息
+    QList<ChatMessage> loadMessages(int dialogId, int userId, bool *ok = nullptr);
+    // 旧数据迁移：把dialog_content中的JSON消息导入chat_message（仅在该对话还没有消息行时调用）
+    QList<ChatMessage> importLegacyDialog(int dialogId, int userId, bool *ok = nullptr);
+
+    // 粗略估算token数：ASCII约4字符/token，中文等非ASCII字符约1字符/token
+    static int estimateTokens(const QString &text);
+
+private:
+    BaseDbHelper *m_baseDbHelper; // 依赖通用数据库层
+};
+
+#endif // CHATDBHELPER_H
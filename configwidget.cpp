@@ -4,11 +4,17 @@
 #include "logmanager.h"
 #include "iphelper.h"
 #include "usersession.h"
+#include "pythonrunner.h"
 #include <QMessageBox>
 #include <QDesktopServices>
 #include <QFileDialog>
 #include <QTableView>
 #include <QHeaderView>
+#include <QFile>
+#include <QPlainTextEdit>
+#include <QTableWidget>
+#include <QSettings>
+#include <QStandardPaths>
 
 ConfigWidget::ConfigWidget(TestTableModel *testTableModel, QWidget *parent) :
     QWidget(parent),
@@ -19,20 +25,68 @@ ConfigWidget::ConfigWidget(TestTableModel *testTableModel, QWidget *parent) :
     bindParamsToUI(); // 此处为空，仅保留接口，实际映射在load/get中完成
 
     m_testDbHelper = TestDbHelper::getInstance();
-    m_pythonRunner = new PythonRunner(this);
+    m_runScheduler = RunScheduler::getInstance();
     m_testTableModel = testTableModel;
 
+    // 并行运行设置（插在“启动运行算法”按钮之前）
+    m_spinWorkers = new QSpinBox(this);
+    m_spinWorkers->setRange(1, 256);
+    m_spinWorkers->setPrefix("并行进程：");
+    m_spinWorkers->setValue(m_runScheduler->maxWorkers());
+    m_spinWorkers->setToolTip("同时运行的Python进程数，每个进程绑定一组CPU核");
+    m_checkSplitRuns = new QCheckBox("按tot_runs拆分", this);
+    m_checkSplitRuns->setChecked(true);
+    m_checkSplitRuns->setToolTip("每次运行作为单独的进程并行执行（tot_runs=1，种子和运行编号依次递增）");
+    m_checkForceRerun = new QCheckBox("强制重新运行", this);
+    m_checkForceRerun->setToolTip("不勾选时，参数和脚本都与已成功的测试相同则直接复用其结果，不再运行脚本");
+    m_labelQueue = new QLabel(this);
+    m_progressJobs = new QProgressBar(this);
+    m_progressJobs->setRange(0, 1000);
+    m_progressJobs->setTextVisible(true);
+    m_progressJobs->setMaximumWidth(160);
+    m_progressJobs->setVisible(false);
+    m_labelProgress = new QLabel(this);
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setSingleShot(true);
+    m_progressTimer->setInterval(300);
+    connect(m_progressTimer, &QTimer::timeout, this, &ConfigWidget::refreshJobProgress);
+    m_recordsTimer = new QTimer(this);
+    m_recordsTimer->setSingleShot(true);
+    m_recordsTimer->setInterval(500);
+    connect(m_recordsTimer, &QTimer::timeout, this, &ConfigWidget::loadTestRecords);
+    ui->horizontalLayout_4->insertWidget(2, m_spinWorkers);
+    ui->horizontalLayout_4->insertWidget(3, m_checkSplitRuns);
+    ui->horizontalLayout_4->insertWidget(4, m_checkForceRerun);
+    ui->horizontalLayout_4->addWidget(m_labelQueue);
+    ui->horizontalLayout_4->addWidget(m_progressJobs);
+    ui->horizontalLayout_4->addWidget(m_labelProgress);
+
+    // 参数扫描（展开为多组配置交给运行调度器并行执行）
+    m_btnSweep = new QPushButton("参数扫描", this);
+    m_btnSweep->setToolTip("按网格/随机/拉丁超立方展开多组参数，完成后汇总各组指标对比");
+    ui->horizontalLayout_4->insertWidget(ui->horizontalLayout_4->indexOf(m_labelQueue), m_btnSweep);
+    m_sweepDefinition = QString::fromUtf8(QJsonDocument(ParameterSweep::exampleDefinition()).toJson(QJsonDocument::Indented));
+    QSettings config(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+    m_sweepMaxPoints = qMax(1, config.value("Sweep/MaxPoints", 500).toInt());
+
     // 绑定信号槽
     connect(ui->btnStartAlgorithm, &QPushButton::clicked, this, &ConfigWidget::onBtnStartAlgorithmClicked);
     connect(ui->btnInterrupt, &QPushButton::clicked, this, &ConfigWidget::onBtnInterruptClicked);
     connect(ui->btnResetDefault, &QPushButton::clicked, this, &ConfigWidget::onBtnResetDefaultClicked);
     connect(ui->btnSelectScript, &QPushButton::clicked, this, &ConfigWidget::onBtnSelectScriptClicked);
-
-    // 绑定Python Runner信号
-    connect(m_pythonRunner, &PythonRunner::finished, this, &ConfigWidget::onPythonScriptFinished);
-    connect(m_pythonRunner, &PythonRunner::logOutput, this, &ConfigWidget::onPythonLogOutput);
-
-    connect(m_pythonRunner, &PythonRunner::logOutput, this, &ConfigWidget::onPythonLogOutput);
+    connect(m_btnSweep, &QPushButton::clicked, this, &ConfigWidget::onBtnSweepClicked);
+
+    // 绑定运行调度器信号（任务在调度器中运行，切换界面不影响）
+    connect(m_runScheduler, &RunScheduler::jobStarted, this, &ConfigWidget::onRunJobStarted);
+    connect(m_runScheduler, &RunScheduler::jobFinished, this, &ConfigWidget::onRunJobFinished);
+    connect(m_runScheduler, &RunScheduler::jobLog, this, &ConfigWidget::onRunJobLog);
+    connect(m_runScheduler, &RunScheduler::queueChanged, this, &ConfigWidget::onRunQueueChanged);
+    connect(m_runScheduler, &RunScheduler::jobProgress, this, &ConfigWidget::onRunJobProgress);
+    connect(m_runScheduler, &RunScheduler::jobLoss, this, &ConfigWidget::onRunJobLoss);
+    connect(m_runScheduler, &RunScheduler::jobMetrics, this, &ConfigWidget::onRunJobMetrics);
+    connect(m_spinWorkers, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+            m_runScheduler, &RunScheduler::setMaxWorkers);
+    onRunQueueChanged(m_runScheduler->runningCount(), m_runScheduler->pendingCount());
 
     // 绑定配置控件信号
     connect(this, &ConfigWidget::confirmConfig, this, &ConfigWidget::onConfigConfirmed);
@@ -445,17 +499,28 @@ void ConfigWidget::on_btnCancel_clicked() {
 }
 
 // ========== 核心业务逻辑槽函数 ==========
+void ConfigWidget::scheduleLoadTestRecords()
+{
+    if (!m_recordsTimer->isActive()) m_recordsTimer->start();
+}
+
 void ConfigWidget::loadTestRecords()
 {
-    QList<TestRecord> records;
-    if(UserSession::instance()->userRole() == "超级管理员") {
-        records = m_testDbHelper->getAllTestRecords();
-    }else {
-        records = m_testDbHelper->getAllTestRecords(UserSession::instance()->userId());
+    // 异步加载，重复刷新时取消上一次未完成的请求
+    if (m_recordsRequestId != 0) {
+        BaseDbHelper::getInstance()->cancelAsync(m_recordsRequestId);
     }
+    int UUID = (UserSession::instance()->userRole() == "超级管理员") ? -1 : UserSession::instance()->userId();
 
-    m_testTableModel->loadTestRecords(records);
-    ui->textEditLog->append(QString("[%1] 已加载 %2 条测试记录").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")).arg(records.size()));
+    m_recordsRequestId = m_testDbHelper->getAllTestRecordsAsync(UUID, this, [this](bool success, const QList<TestRecord>& records) {
+        m_recordsRequestId = 0;
+        if (!success) {
+            ui->textEditLog->append(QString("[%1] 加载测试记录失败").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")));
+            return;
+        }
+        m_testTableModel->loadTestRecords(records);
+        ui->textEditLog->append(QString("[%1] 已加载 %2 条测试记录").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")).arg(records.size()));
+    });
 }
 
 void ConfigWidget::onConfigConfirmed(const ConfigParams& params)
@@ -470,126 +535,256 @@ void ConfigWidget::onConfigConfirmed(const ConfigParams& params)
         return;
     }
 
-    // 保存配置参数到数据库
+    // 日志提示：仅输出信息，不修改布局
+    ui->textEditLog->append(QString("[%1] 配置参数已确认，提交Python脚本...").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")));
+    if (!enqueueCampaign(params, ui->lineEditPythonScript->text().trimmed())) {
+        this->setEditLocked(false); // 解锁编辑
+    }
+}
+
+// ========== 保存配置并提交运行任务 ==========
+bool ConfigWidget::enqueueCampaign(const ConfigParams& params, const QString& scriptPath)
+{
+    // 1. 保存配置参数到数据库
     int configId = -1;
-//    qDebug() << m_UUID << ": I am user id.";
     if (!m_testDbHelper->saveConfigParams(params, UserSession::instance()->userId(), configId)) {
         QMessageBox::critical(this, "数据库错误", "保存配置参数失败！");
-        this->setEditLocked(false); // 解锁编辑
-        return;
+        return false;
     }
     m_currentConfigId = configId;
 
-    // 转换配置参数为JSON字符串
-    QJsonObject paramsJson = params.toJson();
-    QString paramsDetail = QJsonDocument(paramsJson).toJson(QJsonDocument::Indented);
+    // 2. 按tot_runs拆分时每次运行单独一个进程：tot_runs=1，种子和运行编号依次递增
+    int runs = (m_checkSplitRuns->isChecked() && params.tot_runs > 1) ? params.tot_runs : 1;
+    if (m_runScheduler->runningCount() == 0 && m_runScheduler->pendingCount() == 0) {
+        m_campaignSucceeded = 0;
+        m_campaignFailed = 0;
+        m_campaignCached = 0;
+    }
+    QString scriptHash = PythonRunner::scriptHash(scriptPath);
+
+    // 3. 每个任务一条测试记录（排队中），由调度器按test_id更新状态和结果；命中结果缓存的直接复用
+    int cached = 0;
+    for (int i = 0; i < runs; i++) {
+        ConfigParams runParams = params;
+        QString testCode = m_currentTestCode;
+        if (runs > 1) {
+            runParams.tot_runs = 1;
+            runParams.init_seed = params.init_seed + i;
+            runParams.campaign_run = params.campaign_run + i;
+            testCode = QString("%1_R%2").arg(m_currentTestCode).arg(i + 1, 2, 10, QChar('0'));
+        }
+        int jobId = enqueueRun(runParams, configId, testCode, scriptPath, scriptHash);
+        if (jobId < 0) {
+            QMessageBox::critical(this, "数据库错误", "保存测试记录失败！");
+            loadTestRecords();
+            return false;
+        }
+        if (jobId == 0) cached++;
+    }
+
+    ui->textEditLog->append(QString("[%1] 已提交算法测试：%2（代号：%3），共%4个任务（复用已有结果%5个），并行进程数：%6").arg(
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"),
+        m_currentTestName,
+        m_currentTestCode,
+        QString::number(runs),
+        QString::number(cached),
+        QString::number(m_runScheduler->maxWorkers())
+    ));
+    ui->textEditLog->append(QString("[%1] 脚本路径：%2").arg(
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"),
+        scriptPath
+    ));
+    scheduleLoadTestRecords();
+
+    // 全部命中缓存时没有任务运行，直接结束
+    if (m_runScheduler->runningCount() == 0 && m_runScheduler->pendingCount() == 0) {
+        this->setEditLocked(false);
+        QMessageBox::information(this, "执行完成", QString("%1个任务的参数和脚本均与已成功的测试相同，已直接复用结果（可勾选“强制重新运行”重新执行）。").arg(cached));
+    }
+    return true;
+}
+
+// ========== 新建测试记录并提交一个运行任务，返回任务ID（命中结果缓存返回0，失败返回-1） ==========
+int ConfigWidget::enqueueRun(const ConfigParams& runParams, int configId, const QString& testCode,
+                             const QString& scriptPath, const QString& scriptHash, TestRecord* cachedRecord)
+{
+    QJsonObject paramsJson = runParams.toJson();
 
-    // 保存测试记录（基础信息）
     TestRecord record;
     record.UUID = UserSession::instance()->userId();
     record.test_name = m_currentTestName;
-    record.test_code = m_currentTestCode;
-    record.params_detail = paramsDetail;
+    record.test_code = testCode;
+    record.params_detail = QJsonDocument(paramsJson).toJson(QJsonDocument::Indented);
     record.config_id = configId;
+    record.execute_time = QDateTime::currentDateTime();
+    record.remark = "排队中";
+    record.config_hash = runParams.hash();
+    record.script_hash = scriptHash;
+
+    // 参数和脚本都相同且已成功执行过：新记录直接引用原结果目录和指标
+    TestRecord cached;
+    if (!m_checkForceRerun->isChecked() &&
+        m_testDbHelper->findCachedResult(record.UUID, record.config_hash, record.script_hash, cached)) {
+        record.result_path = cached.result_path;
+        record.metrics_data = cached.metrics_data;
+        record.remark = "缓存命中";
+        if (!m_testDbHelper->addTestRecord(record, &record.test_id)) {
+            return -1;
+        }
+        m_campaignCached++;
+        ui->textEditLog->append(QString("[%1] 任务%2复用test_id=%3的结果：%4").arg(
+            QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"),
+            testCode,
+            QString::number(cached.test_id),
+            cached.result_path
+        ));
+        if (cachedRecord) *cachedRecord = record;
+        return 0;
+    }
 
-    if (!m_testDbHelper->addTestRecord(record)) {
-        QMessageBox::critical(this, "数据库错误", "保存测试记录失败！");
-        this->setEditLocked(false); // 解锁编辑
-        return;
+    int testId = -1;
+    if (!m_testDbHelper->addTestRecord(record, &testId) || testId <= 0) {
+        return -1;
     }
+    record.test_id = testId;
+    int jobId = m_runScheduler->enqueue(scriptPath, paramsJson, record);
+    m_jobTags.insert(jobId, testCode);
+    return jobId;
+}
 
-    // 启动Python脚本
-    m_pythonRunner->setScriptPath(ui->lineEditPythonScript->text().trimmed());
-    m_pythonRunner->setScriptParams(paramsJson);
+void ConfigWidget::onRunJobStarted(int jobId, int testId)
+{
+    ui->textEditLog->append(QString("[%1] 任务开始：%2（test_id=%3）").arg(
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"),
+        m_jobTags.value(jobId),
+        QString::number(testId)
+    ));
+    scheduleLoadTestRecords();
+}
 
-    ui->textEditLog->append(QString("[%1] 启动Python脚本：%2").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")).arg(ui->lineEditPythonScript->text()));
-    if (!m_pythonRunner->start()) {
-        QMessageBox::critical(this, "脚本启动失败", "无法启动Python脚本，请检查脚本路径和环境配置！");
-        this->setEditLocked(false); // 解锁编辑
+void ConfigWidget::onRunJobFinished(int jobId, int testId, bool success)
+{
+    QString testCode = m_jobTags.take(jobId);
+    QString execTime = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+    m_jobProgress.remove(jobId);
+    if (m_lastProgressJob == jobId) m_lastProgressJob = -1;
+    refreshJobProgress();
+    if (success) {
+        m_campaignSucceeded++;
+        ADD_BASE_LOG("算法模块",
+                     QString("[%1] ✅ 算法测试执行成功（测试名称：%2，代号：%3）").arg(
+                                     execTime,
+                                     m_currentTestName,
+                                     testCode),
+                     UserSession::instance()->userId(),
+                     "algorithms",
+                     IPHelper::getLocalIP());
+        ui->textEditLog->append(QString("[%1] ✅ 任务执行成功：%2（test_id=%3）").arg(execTime, testCode, QString::number(testId)));
+    } else {
+        m_campaignFailed++;
+        ADD_BASE_LOG("算法模块",
+                     QString("[%1] 算法测试执行失败（测试名称：%2，代号：%3）").arg(
+                                     execTime,
+                                     m_currentTestName,
+                                     testCode),
+                     UserSession::instance()->userId(),
+                     "Algorithms",
+                     IPHelper::getLocalIP());
+        ui->textEditLog->append(QString("[%1] 任务执行失败或已中断：%2（test_id=%3）").arg(execTime, testCode, QString::number(testId)));
     }
 
-    // 日志提示：仅输出信息，不修改布局
-    ui->textEditLog->append(QString("[%1] 配置参数已确认，启动Python脚本...").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")));
-    ui->textEditLog->append(QString("测试名称：%1，测试代号：%2").arg(m_currentTestName).arg(m_currentTestCode));
+    // 刷新表格（结果已由调度器写入测试记录）
+    scheduleLoadTestRecords();
 
-    if (!m_pythonRunner->start()) {
-        QMessageBox::critical(this, "脚本启动失败", "无法启动Python脚本，请检查脚本路径和环境配置！");
-        this->setEditLocked(false); // 解锁编辑
+    // 全部任务结束后汇总提示（手动中断时不提示）
+    if (m_runScheduler->runningCount() == 0 && m_runScheduler->pendingCount() == 0) {
+        this->setEditLocked(false);
+        if (!m_interrupting) {
+            QMessageBox::information(this, "执行完成", QString("全部任务已结束：成功 %1 个，失败 %2 个，复用已有结果 %3 个。")
+                                     .arg(m_campaignSucceeded).arg(m_campaignFailed).arg(m_campaignCached));
+        }
     }
 }
 
-void ConfigWidget::onPythonScriptFinished(bool success, const QDateTime& execTime, const QString& metricsData)
+void ConfigWidget::onRunJobLog(int jobId, const QString& log)
 {
-    // 1. 恢复按钮状态：启用启动，禁用中断
-    ui->btnStartAlgorithm->setEnabled(true);
-    ui->btnInterrupt->setDisabled(true);
+    onPythonLogOutput(QString("[%1] %2").arg(m_jobTags.value(jobId, QString::number(jobId)), log));
+}
 
-    // 2. 解锁配置控件
-    this->setEditLocked(false);
+void ConfigWidget::onRunQueueChanged(int running, int pending)
+{
+    ui->btnInterrupt->setEnabled(running + pending > 0);
+    m_labelQueue->setText(QString("运行中 %1 / 排队 %2").arg(running).arg(pending));
+}
 
-    // 3. 更新测试记录
-    QList<TestRecord> records = m_testDbHelper->getAllTestRecords(UserSession::instance()->userId());
-    TestRecord targetRecord;
-    for (const TestRecord& record : records) {
-        if (record.test_name == m_currentTestName && record.test_code == m_currentTestCode && record.config_id == m_currentConfigId) {
-            targetRecord = record;
-            break;
-        }
+void ConfigWidget::onRunJobProgress(int jobId, int iteration, int total, const QString& phase)
+{
+    JobProgress& progress = m_jobProgress[jobId];
+    progress.iteration = iteration;
+    progress.total = total;
+    progress.phase = phase;
+    m_lastProgressJob = jobId;
+    if (!m_progressTimer->isActive()) m_progressTimer->start();
+}
+
+void ConfigWidget::onRunJobLoss(int jobId, int iteration, const QJsonObject& values)
+{
+    QStringList parts;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it) {
+        parts << QString("%1=%2").arg(it.key(), QString::number(it.value().toDouble(), 'g', 4));
     }
+    JobProgress& progress = m_jobProgress[jobId];
+    progress.iteration = qMax(progress.iteration, iteration);
+    progress.loss = parts.join(" ");
+    m_lastProgressJob = jobId;
+    if (!m_progressTimer->isActive()) m_progressTimer->start();
+}
+
+void ConfigWidget::onRunJobMetrics(int jobId, const QJsonObject& metrics)
+{
+    m_jobProgress[jobId].metrics = QString::fromUtf8(QJsonDocument(metrics).toJson(QJsonDocument::Compact));
+    if (!m_progressTimer->isActive()) m_progressTimer->start();
+}
 
-    if (targetRecord.test_id == -1) {
-        ui->textEditLog->append(QString("[%1] 错误：未找到对应的测试记录").arg(QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")));
-        QMessageBox::warning(this, "提示", "未找到对应的测试记录！");
+void ConfigWidget::refreshJobProgress()
+{
+    if (m_jobProgress.isEmpty()) {
+        m_progressJobs->setVisible(false);
+        m_labelProgress->clear();
+        m_labelProgress->setToolTip("");
         return;
     }
 
-    // 更新测试记录
-    targetRecord.UUID = UserSession::instance()->userId();
-    targetRecord.execute_time = execTime;
-    targetRecord.metrics_data = metricsData;
-    targetRecord.result_path = m_pythonRunner->getResultPath();
-    targetRecord.remark = success ? "执行成功" : "执行失败";
-
-    if (m_testDbHelper->updateTestRecord(targetRecord)) {
-        loadTestRecords(); // 刷新表格
-        if (success) {
-            ADD_BASE_LOG("算法模块",
-                         QString("[%1] ✅ 算法测试执行成功（测试名称：%2，代号：%3）").arg(
-                                         execTime.toString("yyyy-MM-dd HH:mm:ss"),
-                                         m_currentTestName,
-                                         m_currentTestCode),
-                         UserSession::instance()->userId(),
-                         "algorithms",
-                         IPHelper::getLocalIP());
-            ui->textEditLog->append(QString("[%1] ✅ 算法测试执行成功（测试名称：%2，代号：%3）").arg(
-                execTime.toString("yyyy-MM-dd HH:mm:ss"),
-                m_currentTestName,
-                m_currentTestCode
-            ));
-            ui->textEditLog->append(QString("[%1] 结果路径：%2").arg(
-                execTime.toString("yyyy-MM-dd HH:mm:ss"),
-                targetRecord.result_path
-            ));
-            QMessageBox::information(this, "执行成功", "Python脚本执行完成，结果已保存！");
-        } else {
-            ADD_BASE_LOG("算法模块",
-                         QString("[%1] 算法测试执行失败（测试名称：%2，代号：%3）").arg(
-                                         execTime.toString("yyyy-MM-dd HH:mm:ss"),
-                                         m_currentTestName,
-                                         m_currentTestCode),
-                         UserSession::instance()->userId(),
-                         "Algorithms",
-                         IPHelper::getLocalIP());
-            ui->textEditLog->append(QString("[%1] 算法测试执行失败（测试名称：%2，代号：%3）").arg(
-                execTime.toString("yyyy-MM-dd HH:mm:ss"),
-                m_currentTestName,
-                m_currentTestCode
-            ));
-            QMessageBox::critical(this, "执行失败", "Python脚本执行失败，请查看日志！");
+    // 总体进度：已知总迭代数的任务按迭代数合计
+    qint64 done = 0;
+    qint64 total = 0;
+    QStringList details;
+    for (auto it = m_jobProgress.constBegin(); it != m_jobProgress.constEnd(); ++it) {
+        const JobProgress& progress = it.value();
+        if (progress.total > 0) {
+            done += qMin(progress.iteration, progress.total);
+            total += progress.total;
         }
-    } else {
-        QMessageBox::critical(this, "数据库错误", "更新测试记录失败！");
+        QString line = QString("%1：%2 %3/%4").arg(m_jobTags.value(it.key()), progress.phase)
+                           .arg(progress.iteration).arg(progress.total > 0 ? QString::number(progress.total) : "?");
+        if (!progress.loss.isEmpty()) line += "  " + progress.loss;
+        if (!progress.metrics.isEmpty()) line += "\n    指标：" + progress.metrics;
+        details << line;
+    }
+    m_progressJobs->setVisible(total > 0);
+    if (total > 0) {
+        m_progressJobs->setValue(static_cast<int>(done * 1000 / total));
+        m_progressJobs->setFormat(QString("%1%").arg(done * 100.0 / total, 0, 'f', 1));
     }
+
+    if (m_jobProgress.contains(m_lastProgressJob)) {
+        const JobProgress& last = m_jobProgress.value(m_lastProgressJob);
+        QString text = QString("%1 %2 %3").arg(m_jobTags.value(m_lastProgressJob), last.phase).arg(last.iteration);
+        if (last.total > 0) text += "/" + QString::number(last.total);
+        if (!last.loss.isEmpty()) text += "  " + last.loss;
+        m_labelProgress->setText(text);
+    }
+    m_labelProgress->setToolTip(details.join("\n"));
 }
 
 void ConfigWidget::onPythonLogOutput(const QString& log)
@@ -797,110 +992,29 @@ void ConfigWidget::onBtnStartAlgorithmClicked()
     // 2. 从ConfigWidget获取配置参数
     ConfigParams params = this->getConfigParams();
 
-    // 3. 锁定配置控件（防止运行中修改）
-    this->setEditLocked(true);
-
-    // 4. 更新按钮状态：禁用启动，启用中断
-    ui->btnStartAlgorithm->setDisabled(true);
-    ui->btnInterrupt->setEnabled(true);
-
-    // 5. 保存配置参数到数据库
-    int configId = -1;
-    if (!m_testDbHelper->saveConfigParams(params, UserSession::instance()->userId(), configId)) {
-        QMessageBox::critical(this, "数据库错误", "保存配置参数失败！");
-        // 恢复状态
-        this->setEditLocked(false);
-        ui->btnStartAlgorithm->setEnabled(true);
-        ui->btnInterrupt->setDisabled(true);
-        return;
-    }
-    m_currentConfigId = configId;
-
-    // 6. 转换配置参数为JSON
-    QJsonObject paramsJson = params.toJson();
-    QString paramsDetail = QJsonDocument(paramsJson).toJson(QJsonDocument::Indented);
-
-    // 7. 保存测试记录（基础信息）
-    TestRecord record;
-    record.UUID = UserSession::instance()->userId();
-    record.test_name = m_currentTestName;
-    record.test_code = m_currentTestCode;
-    record.params_detail = paramsDetail;
-    record.config_id = configId;
-    record.execute_time = QDateTime::currentDateTime();
-    record.remark = "运行中";
-
-    if (!m_testDbHelper->addTestRecord(record)) {
-        QMessageBox::critical(this, "数据库错误", "保存测试记录失败！");
-        // 恢复状态
-        this->setEditLocked(false);
-        ui->btnStartAlgorithm->setEnabled(true);
-        ui->btnInterrupt->setDisabled(true);
-        return;
-    }
-
-    // 8. 启动Python脚本
-    m_pythonRunner->setScriptPath(scriptPath);
-    m_pythonRunner->setScriptParams(paramsJson);
-
-    ui->textEditLog->append(QString("[%1] 启动算法测试：%2（代号：%3）").arg(
-        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"),
-        m_currentTestName,
-        m_currentTestCode
-    ));
-    ui->textEditLog->append(QString("[%1] 脚本路径：%2").arg(
-        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"),
-        scriptPath
-    ));
-
-    if (!m_pythonRunner->start()) {
-        QMessageBox::critical(this, "脚本启动失败", "无法启动Python脚本，请检查脚本路径和环境配置！");
-        // 恢复状态
-        this->setEditLocked(false);
-        ui->btnStartAlgorithm->setEnabled(true);
-        ui->btnInterrupt->setDisabled(true);
-        // 更新测试记录备注
-        record.remark = "启动失败";
-        m_testDbHelper->updateTestRecord(record);
-    }
+    // 3. 保存配置并排队运行（运行期间可继续修改参数提交新的测试）
+    enqueueCampaign(params, scriptPath);
 }
 
 // ========== 中断算法按钮槽函数 ==========
 void ConfigWidget::onBtnInterruptClicked()
 {
     // 1. 确认中断
-    if (QMessageBox::question(this, "确认中断", "确定要中断当前运行的算法吗？",
+    if (QMessageBox::question(this, "确认中断", "确定要中断全部排队和运行中的算法任务吗？",
         QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes) {
         return;
     }
 
-    // 2. 停止Python脚本
-    m_pythonRunner->stop();
-
-    // 3. 更新按钮状态：启用启动，禁用中断
-    ui->btnStartAlgorithm->setEnabled(true);
-    ui->btnInterrupt->setDisabled(true);
-
-    // 4. 解锁配置控件
-    this->setEditLocked(false);
+    // 2. 终止运行中的进程、移除排队的任务（测试记录备注由调度器更新为“手动中断”）
+    m_interrupting = true;
+    m_runScheduler->cancelAll();
+    m_interrupting = false;
 
-    // 5. 日志提示
-    ui->textEditLog->append(QString("[%1] 算法测试已手动中断（测试名称：%2，代号：%3）").arg(
-        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"),
-        m_currentTestName,
-        m_currentTestCode
+    // 3. 日志提示
+    ui->textEditLog->append(QString("[%1] 算法任务已全部手动中断").arg(
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")
     ));
 
-    // 6. 更新测试记录备注
-    QList<TestRecord> records = m_testDbHelper->getAllTestRecords(UserSession::instance()->userId());
-    for (TestRecord& record : records) {
-        if (record.test_name == m_currentTestName && record.test_code == m_currentTestCode && record.config_id == m_currentConfigId) {
-            record.remark = "手动中断";
-            m_testDbHelper->updateTestRecord(record);
-            break;
-        }
-    }
-
     // 刷新测试记录列表
     loadTestRecords();
 }
@@ -954,3 +1068,232 @@ void ConfigWidget::onBtnSelectScriptClicked()
                                   ));
     }
 }
+
+// ========== 参数扫描按钮槽函数 ==========
+void ConfigWidget::onBtnSweepClicked()
+{
+    if (m_sweep && !m_sweep->isFinished()) {
+        QMessageBox::information(this, "参数扫描", QString("参数扫描“%1”正在运行（%2/%3），请等待完成或中断后再开始新的扫描。")
+                                 .arg(m_sweep->name()).arg(m_sweep->finishedCount()).arg(m_sweep->totalCount()));
+        return;
+    }
+
+    QDialog* dialog = new QDialog(this);
+    dialog->setWindowTitle("参数扫描（以当前界面配置为基础）");
+    dialog->resize(640, 480);
+    dialog->setModal(true);
+
+    QPlainTextEdit* editDefinition = new QPlainTextEdit(m_sweepDefinition, dialog);
+    QLabel* labelInfo = new QLabel("method：grid网格 / random随机 / lhs拉丁超立方；params中为取值列表或{min,max,step,log}区间", dialog);
+    labelInfo->setWordWrap(true);
+
+    QPushButton* btnOpen = new QPushButton("打开...", dialog);
+    QPushButton* btnPreview = new QPushButton("预览", dialog);
+    QPushButton* btnStart = new QPushButton("开始扫描", dialog);
+    QPushButton* btnCancel = new QPushButton("取消", dialog);
+
+    // 解析并展开当前定义
+    auto expandDefinition = [=](ParameterSweep& sweep, QList<SweepPoint>& points, int& duplicates) {
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(editDefinition->toPlainText().toUtf8(), &parseError);
+        if (!doc.isObject()) {
+            QMessageBox::warning(dialog, "扫描定义错误", "JSON格式错误：" + parseError.errorString());
+            return false;
+        }
+        QString error;
+        if (!sweep.parse(doc.object(), &error) ||
+            !sweep.expand(getConfigParams(), m_sweepMaxPoints, points, &error, &duplicates)) {
+            QMessageBox::warning(dialog, "扫描定义错误", error);
+            return false;
+        }
+        return true;
+    };
+
+    connect(btnOpen, &QPushButton::clicked, dialog, [=]() {
+        QString fileName = QFileDialog::getOpenFileName(dialog, "打开扫描定义",
+                                                        QCoreApplication::applicationDirPath(),
+                                                        "JSON Files (*.json);;All Files (*.*)");
+        if (fileName.isEmpty()) return;
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            editDefinition->setPlainText(QString::fromUtf8(file.readAll()));
+        }
+    });
+    connect(btnPreview, &QPushButton::clicked, dialog, [=]() {
+        ParameterSweep sweep;
+        QList<SweepPoint> points;
+        int duplicates = 0;
+        if (!expandDefinition(sweep, points, duplicates)) return;
+        labelInfo->setText(QString("扫描“%1”：%2组配置（去除重复%3组），参数：%4")
+                           .arg(sweep.name()).arg(points.size()).arg(duplicates).arg(sweep.keys().join(", ")));
+    });
+    connect(btnStart, &QPushButton::clicked, dialog, [=]() {
+        ParameterSweep sweep;
+        QList<SweepPoint> points;
+        int duplicates = 0;
+        if (!expandDefinition(sweep, points, duplicates)) return;
+        m_sweepDefinition = editDefinition->toPlainText();
+        if (startSweep(sweep, points)) {
+            dialog->accept();
+        }
+    });
+    connect(btnCancel, &QPushButton::clicked, dialog, &QDialog::reject);
+
+    QHBoxLayout* btnLayout = new QHBoxLayout();
+    btnLayout->addWidget(btnOpen);
+    btnLayout->addStretch();
+    btnLayout->addWidget(btnPreview);
+    btnLayout->addWidget(btnStart);
+    btnLayout->addWidget(btnCancel);
+
+    QVBoxLayout* layout = new QVBoxLayout(dialog);
+    layout->addWidget(editDefinition);
+    layout->addWidget(labelInfo);
+    layout->addLayout(btnLayout);
+
+    dialog->exec();
+    dialog->deleteLater();
+}
+
+// ========== 提交参数扫描的全部任务 ==========
+bool ConfigWidget::startSweep(const ParameterSweep& sweep, const QList<SweepPoint>& points)
+{
+    m_currentTestName = ui->lineEditTestName->text().trimmed();
+    m_currentTestCode = ui->lineEditTestCode->text().trimmed();
+    QString scriptPath = ui->lineEditPythonScript->text().trimmed();
+    if (m_currentTestName.isEmpty() || m_currentTestCode.isEmpty()) {
+        QMessageBox::warning(this, "输入校验", "测试名称和测试代号不能为空！");
+        return false;
+    }
+    if (scriptPath.isEmpty()) {
+        QMessageBox::warning(this, "输入校验", "Python脚本路径不能为空！");
+        return false;
+    }
+    if (points.isEmpty()) {
+        QMessageBox::warning(this, "参数扫描", "扫描定义没有展开出任何配置！");
+        return false;
+    }
+    // 上一次扫描仍有任务未结束时不能替换，否则其余结果不会汇总到它的summary.csv
+    if (m_sweep && !m_sweep->isFinished()) {
+        QMessageBox::information(this, "参数扫描", QString("参数扫描“%1”尚未完成（%2/%3），请等待完成或中断后再开始新的扫描。")
+                                 .arg(m_sweep->name()).arg(m_sweep->finishedCount()).arg(m_sweep->totalCount()));
+        return false;
+    }
+
+    if (m_runScheduler->runningCount() == 0 && m_runScheduler->pendingCount() == 0) {
+        m_campaignSucceeded = 0;
+        m_campaignFailed = 0;
+        m_campaignCached = 0;
+    }
+    QString scriptHash = PythonRunner::scriptHash(scriptPath);
+
+    QString resultDir = QString("%1/TestResults/sweeps/%2_%3").arg(
+        QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation),
+        sweep.name(),
+        QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+    // 此时上一次扫描已全部结束（汇总表已写出），可以释放
+    if (m_sweep) m_sweep->deleteLater();
+    m_sweep = new SweepCampaign(sweep.name(), sweep.keys(), resultDir, this);
+    connect(m_sweep, &SweepCampaign::progress, this, [this](int finished, int total) {
+        m_labelQueue->setToolTip(QString("参数扫描：%1/%2").arg(finished).arg(total));
+    });
+    connect(m_sweep, &SweepCampaign::finished, this, [this](const QString& csvPath) {
+        ui->textEditLog->append(QString("[%1] 参数扫描“%2”完成，汇总表：%3").arg(
+            QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"), m_sweep->name(), csvPath));
+        showSweepResults();
+    });
+
+    // 每组配置单独保存并作为一个任务提交（不再按tot_runs拆分，需要多个种子时把init_seed加入扫描参数）
+    for (int i = 0; i < points.size(); i++) {
+        const SweepPoint& point = points.at(i);
+        int configId = -1;
+        if (!m_testDbHelper->saveConfigParams(point.params, UserSession::instance()->userId(), configId)) {
+            QMessageBox::critical(this, "数据库错误", QString("保存第%1组配置参数失败，已提交%1组之前的任务！").arg(i + 1));
+            break;
+        }
+        QString testCode = QString("%1_S%2").arg(m_currentTestCode).arg(i + 1, 3, 10, QChar('0'));
+        TestRecord cachedRecord;
+        int jobId = enqueueRun(point.params, configId, testCode, scriptPath, scriptHash, &cachedRecord);
+        if (jobId < 0) {
+            QMessageBox::critical(this, "数据库错误", QString("保存第%1组测试记录失败，已提交%1组之前的任务！").arg(i + 1));
+            break;
+        }
+        if (jobId == 0) {
+            m_sweep->addResult(testCode, point.values, cachedRecord);
+        } else {
+            m_sweep->addJob(jobId, testCode, point.values);
+        }
+    }
+
+    ui->textEditLog->append(QString("[%1] 已提交参数扫描“%2”：%3组配置，参数：%4，并行进程数：%5").arg(
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"),
+        sweep.name(),
+        QString::number(m_sweep->totalCount()),
+        sweep.keys().join(", "),
+        QString::number(m_runScheduler->maxWorkers())
+    ));
+    ui->textEditLog->append(QString("[%1] 扫描结果目录：%2").arg(
+        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"), resultDir));
+    scheduleLoadTestRecords();
+
+    // 全部命中结果缓存时没有任务运行，直接给出对比表
+    if (m_sweep->totalCount() > 0 && m_sweep->isFinished()) {
+        ui->textEditLog->append(QString("[%1] 参数扫描“%2”全部复用已有结果").arg(
+            QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss"), sweep.name()));
+        showSweepResults();
+    }
+    return m_sweep->totalCount() > 0;
+}
+
+// ========== 参数扫描结果对比表 ==========
+void ConfigWidget::showSweepResults()
+{
+    if (!m_sweep) return;
+
+    QDialog* dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(QString("参数扫描结果：%1").arg(m_sweep->name()));
+    dialog->resize(900, 500);
+
+    QStringList headers = m_sweep->headers();
+    QList<QStringList> rows = m_sweep->rows();
+    QTableWidget* table = new QTableWidget(rows.size(), headers.size(), dialog);
+    table->setHorizontalHeaderLabels(headers);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    for (int r = 0; r < rows.size(); r++) {
+        for (int c = 0; c < rows.at(r).size(); c++) {
+            QTableWidgetItem* item = new QTableWidgetItem();
+            // 数值列按数值排序
+            bool isNumber = false;
+            double number = rows.at(r).at(c).toDouble(&isNumber);
+            if (isNumber) {
+                item->setData(Qt::DisplayRole, number);
+            } else {
+                item->setText(rows.at(r).at(c));
+            }
+            table->setItem(r, c, item);
+        }
+    }
+    table->setSortingEnabled(true);
+    table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    QString resultDir = m_sweep->resultDir();
+    QPushButton* btnOpenDir = new QPushButton("打开结果目录", dialog);
+    QPushButton* btnClose = new QPushButton("关闭", dialog);
+    connect(btnOpenDir, &QPushButton::clicked, dialog, [resultDir]() {
+        QDesktopServices::openUrl(QUrl::fromLocalFile(resultDir));
+    });
+    connect(btnClose, &QPushButton::clicked, dialog, &QDialog::close);
+
+    QHBoxLayout* btnLayout = new QHBoxLayout();
+    btnLayout->addWidget(btnOpenDir);
+    btnLayout->addStretch();
+    btnLayout->addWidget(btnClose);
+
+    QVBoxLayout* layout = new QVBoxLayout(dialog);
+    layout->addWidget(table);
+    layout->addLayout(btnLayout);
+
+    // 非模态显示，不打断后续操作
+    dialog->show();
+}
@@ -9,7 +9,12 @@
 #include <QPushButton>
 #include "TestDbHelper.h"
 #include "testtablemodel.h"
-#include "pythonrunner.h"
+#include "runscheduler.h"
+#include "parametersweep.h"
+#include <QLabel>
+#include <QProgressBar>
+#include <QTimer>
+#include <QHash>
 #include <QString>
 #include <QJsonDocument>
 
@@ -36,14 +41,25 @@ public:
 private slots:
      // 配置确认后的处理
      void onConfigConfirmed(const ConfigParams& params);
-     // Python脚本执行完成
-     void onPythonScriptFinished(bool success, const QDateTime& execTime, const QString& metricsData);
+     // 运行调度器：任务开始/结束/输出/队列变化
+     void onRunJobStarted(int jobId, int testId);
+     void onRunJobFinished(int jobId, int testId, bool success);
+     void onRunJobLog(int jobId, const QString& log);
+     void onRunQueueChanged(int running, int pending);
+     // 运行调度器：脚本上报的进度/损失/部分指标
+     void onRunJobProgress(int jobId, int iteration, int total, const QString& phase);
+     void onRunJobLoss(int jobId, int iteration, const QJsonObject& values);
+     void onRunJobMetrics(int jobId, const QJsonObject& metrics);
+     // 刷新进度条和进度说明（合并短时间内的多次上报）
+     void refreshJobProgress();
      // Python日志输出
      void onPythonLogOutput(const QString& log);
      // 表格点击事件
      void onTableViewClicked(const QModelIndex& index);
      // 加载测试记录
      void loadTestRecords();
+     // 合并短时间内的多次刷新请求（任务开始/结束频繁时避免反复全表查询）
+     void scheduleLoadTestRecords();
      // 显示参数详情弹窗
      void showParamsDetailDialog(const QString& paramsJson);
      // 显示指标分析弹窗
@@ -54,6 +70,7 @@ private slots:
      void onBtnInterruptClicked();      // 中断算法
      void onBtnResetDefaultClicked();   // 恢复默认配置
      void onBtnSelectScriptClicked();   // 选择执行脚本
+     void onBtnSweepClicked();          // 参数扫描
 
 signals:
     // 确定按钮点击（传递配置参数）
@@ -70,12 +87,50 @@ private:
     bool m_isLocked = false;
 
     TestTableModel *m_testTableModel;      // 测试结果表格模型
-    PythonRunner *m_pythonRunner;          // Python脚本运行器
+    RunScheduler *m_runScheduler;          // Python脚本运行调度器（全局单例）
+    QSpinBox *m_spinWorkers;               // 并行进程数
+    QCheckBox *m_checkSplitRuns;           // 按tot_runs拆分为多个进程
+    QCheckBox *m_checkForceRerun;          // 忽略结果缓存，强制重新运行
+    QLabel *m_labelQueue;                  // 运行中/排队任务数
+    QProgressBar *m_progressJobs;          // 运行中任务的总体进度
+    QLabel *m_labelProgress;               // 最近上报进度的任务
+    QTimer *m_progressTimer;               // 进度刷新节流
+    QTimer *m_recordsTimer;                // 测试记录刷新节流
+    struct JobProgress {
+        int iteration = 0;
+        int total = 0;
+        QString phase;
+        QString loss;                      // 最近一次损失值（已格式化）
+        QString metrics;                   // 已上报的部分指标（紧凑JSON）
+    };
+    QHash<int, JobProgress> m_jobProgress; // 任务ID -> 进度
+    int m_lastProgressJob = -1;
+    QHash<int, QString> m_jobTags;         // 任务ID -> 测试代号（日志前缀）
+    int m_campaignSucceeded = 0;           // 本批任务的成功/失败数
+    int m_campaignFailed = 0;
+    int m_campaignCached = 0;              // 本批命中结果缓存的任务数
+    bool m_interrupting = false;           // 手动中断中（不弹出汇总提示）
+    QPushButton *m_btnSweep;               // 参数扫描
+    QString m_sweepDefinition;             // 上次使用的扫描定义（JSON）
+    int m_sweepMaxPoints = 500;            // 一次扫描最多展开的配置组数
+    SweepCampaign *m_sweep = nullptr;      // 最近一次参数扫描
     TestDbHelper *m_testDbHelper;          // 数据库操作类
     // 临时变量
     int m_currentConfigId;                 // 当前配置ID
     QString m_currentTestName;             // 当前测试名称
     QString m_currentTestCode;             // 当前测试代号
+    quint64 m_recordsRequestId = 0;        // 进行中的测试记录加载请求
+
+    // 保存配置并把测试（按tot_runs拆分后的各次运行）提交到运行调度器
+    bool enqueueCampaign(const ConfigParams& params, const QString& scriptPath);
+    // 新建测试记录并提交一个运行任务，返回任务ID；参数和脚本与已成功的测试相同时直接复用结果，
+    // 返回0并输出新记录（勾选强制重新运行时不查缓存）；失败返回-1
+    int enqueueRun(const ConfigParams& runParams, int configId, const QString& testCode,
+                   const QString& scriptPath, const QString& scriptHash, TestRecord* cachedRecord = nullptr);
+    // 提交参数扫描的全部配置
+    bool startSweep(const ParameterSweep& sweep, const QList<SweepPoint>& points);
+    // 参数扫描结果对比表
+    void showSweepResults();
 public:
     // 初始化UI控件
     void initUI();
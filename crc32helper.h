@@ -0,0 +1,32 @@
+#ifndef CRC32HELPER_H
+#define CRC32HELPER_H
+
+#include <QByteArray>
+#include <array>
+
+/**
+ * @brief CRC32（IEEE 802.3，与gzip/zlib一致）
+ * 查表在首次调用时由局部静态变量构造，C++11保证多线程下只初始化一次。
+ */
+inline quint32 crc32Ieee(const QByteArray &data)
+{
+    static const std::array<quint32, 256> table = []() {
+        std::array<quint32, 256> t;
+        for (quint32 i = 0; i < 256; i++) {
+            quint32 c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (int i = 0; i < data.size(); i++) {
+        crc = table[(crc ^ static_cast<quint8>(data.at(i))) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+#endif // CRC32HELPER_H
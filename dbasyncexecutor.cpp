@@ -0,0 +1,256 @@
+#include "dbasyncexecutor.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QFile>
+#include <QTimer>
+#include <QRunnable>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include "basedbhelper.h"
+#include "loghelper.h"
+
+// 初始化静态成员
+DbAsyncExecutor* DbAsyncExecutor::m_pInstance = nullptr;
+QMutex DbAsyncExecutor::m_mutex;
+
+// 为SELECT语句注入MySQL执行时长上限（优化器提示，不增加额外往返）
+static QString applyExecutionTimeHint(const QString &sql, int timeoutMs)
+{
+    static const QRegularExpression selectHead("^\\s*SELECT\\s", QRegularExpression::CaseInsensitiveOption);
+    if (timeoutMs <= 0 || !selectHead.match(sql).hasMatch()) {
+        return sql;
+    }
+    QString hinted = sql;
+    int pos = hinted.indexOf(QRegularExpression("SELECT", QRegularExpression::CaseInsensitiveOption)) + 6;
+    hinted.insert(pos, QString(" /*+ MAX_EXECUTION_TIME(%1) */").arg(timeoutMs));
+    return hinted;
+}
+
+// ========== 工作线程任务 ==========
+class DbQueryTask : public QRunnable
+{
+public:
+    DbQueryTask(DbAsyncExecutor *executor, quint64 requestId,
+                const QSharedPointer<DbAsyncExecutor::Request> &request,
+                const QString &sql, const QVariantList &params, bool prepared, int timeoutMs)
+        : m_executor(executor), m_requestId(requestId), m_request(request),
+          m_sql(sql), m_params(params), m_prepared(prepared), m_timeoutMs(timeoutMs)
+    {
+    }
+
+    void run() override
+    {
+        // 排队期间已被取消/超时：直接丢弃
+        if (m_request->cancelled.loadAcquire() || !m_request->state.testAndSetOrdered(0, 1)) {
+            return;
+        }
+
+        BaseDbHelper *db = BaseDbHelper::getInstance();
+        QString sql = applyExecutionTimeHint(m_sql, m_timeoutMs);
+        DbQueryResult result;
+        if (m_prepared) {
+            // 结果在工作线程内读完，可走预处理语句缓存
+            result = db->execPrepareQueryResult(sql, m_params);
+        } else {
+            DbQuery query = db->execQuery(sql);
+            result.success = query.isActive() && query.lastError().type() == QSqlError::NoError;
+            if (result.success) {
+                result.lastInsertId = query.lastInsertId();
+                result.numRowsAffected = query.numRowsAffected();
+                if (query.isSelect()) {
+                    while (query.next()) {
+                        result.rows.append(query.record());
+                    }
+                }
+            } else {
+                result.error = db->getLastError();
+            }
+        }
+
+        QMetaObject::invokeMethod(m_executor, "onTaskFinished", Qt::QueuedConnection,
+                                  Q_ARG(quint64, m_requestId), Q_ARG(DbQueryResult, result));
+    }
+
+private:
+    DbAsyncExecutor *m_executor;
+    quint64 m_requestId;
+    QSharedPointer<DbAsyncExecutor::Request> m_request; // 共享请求状态，保活到任务结束
+    QString m_sql;
+    QVariantList m_params;
+    bool m_prepared;
+    int m_timeoutMs;
+};
+
+// ========== DbAsyncExecutor ==========
+DbAsyncExecutor::DbAsyncExecutor(QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<DbQueryResult>("DbQueryResult");
+
+    int workers = 4;
+    int idleTimeout = 300;
+    QString configPath = QCoreApplication::applicationDirPath() + "/config.ini";
+    if (QFile::exists(configPath)) {
+        QSettings config(configPath, QSettings::IniFormat);
+        config.beginGroup("Database");
+        workers = qMax(1, config.value("AsyncWorkers", workers).toInt());
+        idleTimeout = qMax(1, config.value("PoolIdleTimeout", idleTimeout).toInt());
+        config.endGroup();
+    }
+    // 工作线程随连接一同空闲回收，保持连接预热
+    m_threadPool.setMaxThreadCount(workers);
+    m_threadPool.setExpiryTimeout(idleTimeout * 1000);
+    LOG_DEBUG("数据库模块", "异步执行器初始化，工作线程数：" << workers);
+}
+
+DbAsyncExecutor::~DbAsyncExecutor()
+{
+    {
+        QMutexLocker locker(&m_requestMutex);
+        for (auto it = m_requests.begin(); it != m_requests.end(); ++it) {
+            it.value()->cancelled.storeRelease(1);
+        }
+    }
+    m_threadPool.waitForDone();
+}
+
+DbAsyncExecutor *DbAsyncExecutor::getInstance()
+{
+    if (m_pInstance == nullptr) {
+        m_mutex.lock();
+        if (m_pInstance == nullptr) {
+            m_pInstance = new DbAsyncExecutor();
+        }
+        m_mutex.unlock();
+    }
+    return m_pInstance;
+}
+
+void DbAsyncExecutor::releaseInstance()
+{
+    m_mutex.lock();
+    if (m_pInstance != nullptr) {
+        delete m_pInstance;
+        m_pInstance = nullptr;
+    }
+    m_mutex.unlock();
+}
+
+quint64 DbAsyncExecutor::execQueryAsync(const QString &sql, int timeoutMs)
+{
+    return submit(sql, QVariantList(), false, nullptr, DbResultCallback(), timeoutMs);
+}
+
+quint64 DbAsyncExecutor::execPrepareQueryAsync(const QString &sql, const QVariantList &params, int timeoutMs)
+{
+    return submit(sql, params, true, nullptr, DbResultCallback(), timeoutMs);
+}
+
+quint64 DbAsyncExecutor::execPrepareQueryAsync(const QString &sql, const QVariantList &params,
+                                               QObject *context, DbResultCallback callback, int timeoutMs)
+{
+    return submit(sql, params, true, context, callback, timeoutMs);
+}
+
+quint64 DbAsyncExecutor::submit(const QString &sql, const QVariantList &params, bool prepared,
+                                QObject *context, DbResultCallback callback, int timeoutMs)
+{
+    QSharedPointer<Request> request(new Request);
+    request->context = context;
+    request->hasContext = (context != nullptr);
+    request->callback = callback;
+    request->timer.start();
+
+    quint64 requestId;
+    {
+        QMutexLocker locker(&m_requestMutex);
+        requestId = ++m_nextRequestId;
+        m_requests.insert(requestId, request);
+    }
+
+    DbQueryTask *task = new DbQueryTask(this, requestId, request, sql, params, prepared, timeoutMs);
+    task->setAutoDelete(true);
+    m_threadPool.start(task);
+
+    if (timeoutMs > 0) {
+        QTimer::singleShot(timeoutMs, this, [this, requestId]() {
+            DbQueryResult result;
+            result.timedOut = true;
+            result.error = "数据库请求超时";
+            finishRequest(requestId, result);
+        });
+    }
+    return requestId;
+}
+
+void DbAsyncExecutor::cancel(quint64 requestId)
+{
+    DbQueryResult result;
+    result.cancelled = true;
+    result.error = "数据库请求已取消";
+    finishRequest(requestId, result);
+}
+
+void DbAsyncExecutor::cancelAll(QObject *context)
+{
+    QList<quint64> ids;
+    {
+        QMutexLocker locker(&m_requestMutex);
+        for (auto it = m_requests.constBegin(); it != m_requests.constEnd(); ++it) {
+            if (it.value()->hasContext && it.value()->context == context) {
+                ids << it.key();
+            }
+        }
+    }
+    for (quint64 id : ids) {
+        cancel(id);
+    }
+}
+
+void DbAsyncExecutor::onTaskFinished(quint64 requestId, const DbQueryResult &result)
+{
+    finishRequest(requestId, result);
+}
+
+void DbAsyncExecutor::finishRequest(quint64 requestId, const DbQueryResult &result)
+{
+    QSharedPointer<Request> request;
+    {
+        QMutexLocker locker(&m_requestMutex);
+        request = m_requests.take(requestId);
+    }
+    // 已结束（取消/超时后任务才返回等情况）
+    if (request.isNull()) {
+        return;
+    }
+    request->state.storeRelease(2);
+    if (result.cancelled || result.timedOut) {
+        request->cancelled.storeRelease(1);
+    }
+
+    DbQueryResult finalResult = result;
+    finalResult.elapsedMs = request->timer.elapsed();
+    if (result.timedOut) {
+        LOG_WARN("数据库模块", "异步请求超时，请求ID：" << requestId << "耗时(毫秒)：" << finalResult.elapsedMs);
+    }
+
+    emit queryFinished(requestId, finalResult);
+
+    // 取消的请求不再回调
+    if (result.cancelled || !request->callback) {
+        return;
+    }
+    if (!request->hasContext) {
+        request->callback(finalResult);
+        return;
+    }
+    // 投递到context所在线程执行（同线程时直接调用）；context在投递前后销毁都不会回调
+    QObject *context = request->context.data();
+    if (context) {
+        DbResultCallback callback = request->callback;
+        QMetaObject::invokeMethod(context, [callback, finalResult]() {
+            callback(finalResult);
+        }, Qt::AutoConnection);
+    }
+}
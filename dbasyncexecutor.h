@@ -0,0 +1,94 @@
+#ifndef DBASYNCEXECUTOR_H
+#define DBASYNCEXECUTOR_H
+
+#include <QObject>
+#include <QThreadPool>
+#include <QMutex>
+#include <QHash>
+#include <QPointer>
+#include <QSqlRecord>
+#include <QVector>
+#include <QVariantList>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <functional>
+
+// 异步查询结果：跨线程传递时已物化为记录集（QSqlQuery不可跨线程）
+struct DbQueryResult {
+    bool success = false;       // 是否执行成功
+    bool cancelled = false;     // 是否被取消
+    bool timedOut = false;      // 是否超时
+    QString error;              // 错误信息
+    QVector<QSqlRecord> rows;   // 查询结果行
+    QVariant lastInsertId;      // 插入语句的自增ID
+    int numRowsAffected = -1;   // 影响行数
+    qint64 elapsedMs = 0;       // 提交到完成的耗时（毫秒）
+};
+Q_DECLARE_METATYPE(DbQueryResult)
+
+// 结果回调：有context时投递到context所在线程执行，context销毁后不再回调；无context时在执行器线程执行
+// context不在执行器线程时须用deleteLater销毁，直接delete与投递存在竞争
+typedef std::function<void(const DbQueryResult&)> DbResultCallback;
+
+// 异步SQL执行器：独立数据库工作线程池执行SQL，结果通过信号/回调投递回调用方线程
+// 工作线程的连接由DbConnectionPool按线程提供
+class DbAsyncExecutor : public QObject
+{
+    Q_OBJECT
+public:
+    static DbAsyncExecutor* getInstance();
+    static void releaseInstance();
+
+    // 提交异步任务，返回请求ID；timeoutMs<=0表示不限时
+    // 超时后不再投递该请求的结果：SELECT附加MAX_EXECUTION_TIME提示由服务端中止，
+    // 非SELECT语句（INSERT/UPDATE/DELETE等）仍会在服务端执行完成，只是调用方收到超时结果
+    quint64 execQueryAsync(const QString &sql, int timeoutMs = 0);
+    quint64 execPrepareQueryAsync(const QString &sql, const QVariantList &params, int timeoutMs = 0);
+    // 回调版本：结果直接交给callback，同时仍会发出queryFinished信号
+    quint64 execPrepareQueryAsync(const QString &sql, const QVariantList &params,
+                                  QObject *context, DbResultCallback callback, int timeoutMs = 0);
+
+    // 取消请求：未开始的任务直接丢弃，已开始的任务结果不再投递
+    void cancel(quint64 requestId);
+    // 取消某个context关联的全部请求（界面销毁/重新加载时使用）
+    void cancelAll(QObject *context);
+
+signals:
+    // 查询完成（成功/失败/取消/超时都会发出，且每个请求只发一次）
+    void queryFinished(quint64 requestId, const DbQueryResult &result);
+
+private slots:
+    // 工作线程完成后在本对象线程内投递结果
+    void onTaskFinished(quint64 requestId, const DbQueryResult &result);
+
+private:
+    explicit DbAsyncExecutor(QObject *parent = nullptr);
+    ~DbAsyncExecutor() override;
+
+    // 请求状态（state：0=排队 1=执行中 2=已结束），工作线程与本线程共享
+    struct Request {
+        QAtomicInt state;
+        QAtomicInt cancelled;
+        QPointer<QObject> context;
+        bool hasContext = false;
+        DbResultCallback callback;
+        QElapsedTimer timer;
+    };
+    friend class DbQueryTask;
+
+    quint64 submit(const QString &sql, const QVariantList &params, bool prepared,
+                   QObject *context, DbResultCallback callback, int timeoutMs);
+    // 结束请求并投递结果（每个请求只生效一次）
+    void finishRequest(quint64 requestId, const DbQueryResult &result);
+
+    static DbAsyncExecutor* m_pInstance;
+    static QMutex m_mutex;
+
+    QThreadPool m_threadPool;                              // 数据库工作线程池
+    QMutex m_requestMutex;                                 // 保护m_requests
+    QHash<quint64, QSharedPointer<Request>> m_requests;    // 未结束的请求
+    quint64 m_nextRequestId = 0;
+};
+
+#endif // DBASYNCEXECUTOR_H
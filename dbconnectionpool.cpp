@@ -0,0 +1,431 @@
+#include "dbconnectionpool.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QFile>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QSqlError>
+#include "loghelper.h"
+
+// 连接名前缀（与历史单连接名保持一致，便于排查）
+const QString DB_CONN_PREFIX = "MYSQL_CONN";
+
+// 初始化静态成员
+DbConnectionPool* DbConnectionPool::m_pInstance = nullptr;
+QMutex DbConnectionPool::m_mutex;
+
+// ========== PooledConnection（租约句柄） ==========
+PooledConnection::PooledConnection(DbConnectionPool *pool, const QString &connName)
+    : m_lease(new Lease)
+{
+    m_lease->pool = pool;
+    m_lease->connName = connName;
+}
+
+PooledConnection::Lease::~Lease()
+{
+    if (pool) {
+        pool->release(connName);
+    }
+}
+
+bool PooledConnection::isValid() const
+{
+    return !m_lease.isNull();
+}
+
+QSqlDatabase PooledConnection::database() const
+{
+    if (m_lease.isNull()) {
+        return QSqlDatabase();
+    }
+    return QSqlDatabase::database(m_lease->connName, false);
+}
+
+QString PooledConnection::connectionName() const
+{
+    return m_lease.isNull() ? QString() : m_lease->connName;
+}
+
+QSqlQuery PooledConnection::cachedStatement(const QString &sql, bool *hit) const
+{
+    if (m_lease.isNull()) {
+        if (hit) *hit = false;
+        return QSqlQuery();
+    }
+    DbConnectionPool *pool = m_lease->pool;
+    PreparedStatementCache *cache = pool->statementCache(m_lease->connName);
+    bool cacheHit = false;
+    QSqlQuery query;
+    if (cache) {
+        query = cache->statement(database(), sql, &cacheHit);
+    } else {
+        query = QSqlQuery(database());
+        query.prepare(sql);
+    }
+    if (cacheHit) {
+        pool->m_stmtHits.fetchAndAddRelaxed(1);
+    } else {
+        pool->m_stmtMisses.fetchAndAddRelaxed(1);
+    }
+    if (hit) *hit = cacheHit;
+    return query;
+}
+
+void PooledConnection::evictStatement(const QString &sql) const
+{
+    if (m_lease.isNull()) {
+        return;
+    }
+    PreparedStatementCache *cache = m_lease->pool->statementCache(m_lease->connName);
+    if (cache) {
+        cache->evict(sql);
+    }
+}
+
+void PooledConnection::release()
+{
+    m_lease.reset();
+}
+
+// ========== DbConnectionPool ==========
+DbConnectionPool::DbConnectionPool(QObject *parent) : QObject(parent)
+{
+    readPoolConfig();
+    LOG_DEBUG("数据库模块", "连接池初始化：" << "最小空闲" << m_minSize
+              << "最大连接" << m_maxSize << "空闲回收(秒)" << m_idleTimeout
+              << "等待超时(毫秒)" << m_waitTimeout);
+}
+
+// 析构：程序退出时关闭剩余连接
+DbConnectionPool::~DbConnectionPool()
+{
+    QStringList connNames;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        for (auto it = m_threadConns.begin(); it != m_threadConns.end(); ++it) {
+            for (const ConnEntry &entry : it.value()) {
+                connNames << entry.connName;
+            }
+        }
+        m_threadConns.clear();
+        m_totalCount = 0;
+        m_inUseCount = 0;
+    }
+    for (const QString &name : connNames) {
+        closeConnection(name);
+    }
+}
+
+// 线程安全的单例获取
+DbConnectionPool *DbConnectionPool::getInstance()
+{
+    if (m_pInstance == nullptr) {
+        m_mutex.lock();
+        if (m_pInstance == nullptr) {
+            m_pInstance = new DbConnectionPool();
+        }
+        m_mutex.unlock();
+    }
+    return m_pInstance;
+}
+
+void DbConnectionPool::releaseInstance()
+{
+    m_mutex.lock();
+    if (m_pInstance != nullptr) {
+        delete m_pInstance;
+        m_pInstance = nullptr;
+    }
+    m_mutex.unlock();
+}
+
+// 读取配置：连接参数 + 池参数（均位于[Database]节）
+void DbConnectionPool::readPoolConfig()
+{
+    QString configPath = QCoreApplication::applicationDirPath() + "/config.ini";
+    if (!QFile::exists(configPath)) {
+        qCritical() << "配置文件不存在：" << configPath << "，使用默认参数！";
+        return;
+    }
+
+    QSettings config(configPath, QSettings::IniFormat);
+    config.beginGroup("Database");
+    m_hostName = config.value("HostName").toString();
+    m_port = config.value("Port", 3306).toInt();
+    m_dbName = config.value("DatabaseName").toString();
+    m_userName = config.value("UserName").toString();
+    m_password = config.value("Password").toString();
+    m_connectTimeout = config.value("ConnectTimeout", 30).toInt();
+
+    m_minSize = qMax(0, config.value("PoolMinIdle", 1).toInt());
+    m_maxSize = qMax(1, config.value("PoolMaxSize", 8).toInt());
+    m_idleTimeout = qMax(1, config.value("PoolIdleTimeout", 300).toInt());
+    m_waitTimeout = qMax(0, config.value("PoolWaitTimeout", 5000).toInt());
+    m_stmtCacheSize = qMax(0, config.value("StatementCacheSize", 32).toInt());
+    config.endGroup();
+}
+
+QString DbConnectionPool::nextConnectionName()
+{
+    return QString("%1_%2_%3")
+            .arg(DB_CONN_PREFIX)
+            .arg(reinterpret_cast<quintptr>(QThread::currentThreadId()), 0, 16)
+            .arg(++m_connSerial);
+}
+
+// 在当前线程创建并打开连接（不持有池锁，避免建连阻塞其他线程）
+bool DbConnectionPool::openConnection(const QString &connName)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connName);
+    db.setHostName(m_hostName);
+    db.setPort(m_port);
+    db.setDatabaseName(m_dbName);
+    db.setUserName(m_userName);
+    db.setPassword(m_password);
+    db.setConnectOptions(QString("MYSQL_OPT_CONNECT_TIMEOUT=%1;MYSQL_OPT_RECONNECT=1").arg(m_connectTimeout));
+
+    if (!db.open()) {
+        qCritical() << "数据库连接失败：" << connName << db.lastError().text();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connName);
+        return false;
+    }
+    return true;
+}
+
+// 回收当前线程超时的空闲连接，保留至少m_minSize条空闲连接
+void DbConnectionPool::reapIdleConnections(Qt::HANDLE threadId, QStringList &toClose)
+{
+    auto it = m_threadConns.find(threadId);
+    if (it == m_threadConns.end()) {
+        return;
+    }
+
+    QList<ConnEntry> &conns = it.value();
+    int idle = 0;
+    for (const ConnEntry &entry : conns) {
+        if (!entry.inUse) idle++;
+    }
+
+    QDateTime now = QDateTime::currentDateTime();
+    // 从最早归还的连接开始回收（列表头部）
+    for (int i = 0; i < conns.size() && idle > m_minSize; ) {
+        const ConnEntry &entry = conns.at(i);
+        if (!entry.inUse && entry.lastUsed.secsTo(now) >= m_idleTimeout) {
+            toClose << entry.connName;
+            conns.removeAt(i);
+            m_totalCount--;
+            idle--;
+        } else {
+            i++;
+        }
+    }
+
+    if (!toClose.isEmpty()) {
+        m_connReleased.wakeAll();
+    }
+}
+
+// 子线程退出时自动清理其连接（finished信号在退出线程内发出，直连即可在所属线程关闭）
+void DbConnectionPool::watchThread()
+{
+    QThread *thread = QThread::currentThread();
+    if (thread == qApp->thread()) {
+        return;
+    }
+
+    Qt::HANDLE threadId = QThread::currentThreadId();
+    {
+        QMutexLocker locker(&m_poolMutex);
+        if (m_watchedThreads.contains(threadId)) {
+            return;
+        }
+        m_watchedThreads.insert(threadId, true);
+    }
+    connect(thread, &QThread::finished, this, [this]() {
+        closeThreadConnections();
+    }, Qt::DirectConnection);
+}
+
+// 借出连接：优先复用本线程最近归还的空闲连接，其次新建，达到上限则等待归还
+PooledConnection DbConnectionPool::acquire()
+{
+    Qt::HANDLE threadId = QThread::currentThreadId();
+    QStringList toClose;
+    QString connName;
+    bool needCreate = false;
+
+    QElapsedTimer waitTimer;
+    waitTimer.start();
+    {
+        QMutexLocker locker(&m_poolMutex);
+        forever {
+            reapIdleConnections(threadId, toClose);
+
+            // 上限只限制同时借出的连接：其他线程的空闲连接只能由其所属线程关闭，不应占用名额
+            if (m_inUseCount < m_maxSize) {
+                QList<ConnEntry> &conns = m_threadConns[threadId];
+                for (int i = conns.size() - 1; i >= 0; i--) {
+                    if (!conns.at(i).inUse) {
+                        conns[i].inUse = true;
+                        connName = conns.at(i).connName;
+                        break;
+                    }
+                }
+                if (connName.isEmpty()) {
+                    m_totalCount++; // 先占位，建连在锁外完成
+                    connName = nextConnectionName();
+                    needCreate = true;
+                }
+                m_inUseCount++;
+                break;
+            }
+
+            qint64 remaining = m_waitTimeout - waitTimer.elapsed();
+            if (remaining <= 0) {
+                break;
+            }
+            m_connReleased.wait(&m_poolMutex, static_cast<unsigned long>(remaining));
+        }
+    }
+
+    // 关闭被回收的连接（同属当前线程）
+    for (const QString &name : toClose) {
+        closeConnection(name);
+    }
+
+    if (connName.isEmpty()) {
+        LOG_WARN("数据库模块", "获取数据库连接超时，借出连接数已达上限：" << m_maxSize);
+        return PooledConnection();
+    }
+
+    if (needCreate) {
+        if (!openConnection(connName)) {
+            QMutexLocker locker(&m_poolMutex);
+            m_totalCount--;
+            m_inUseCount--;
+            m_connReleased.wakeAll();
+            return PooledConnection();
+        }
+        ConnEntry entry;
+        entry.connName = connName;
+        entry.inUse = true;
+        entry.lastUsed = QDateTime::currentDateTime();
+        {
+            QMutexLocker locker(&m_poolMutex);
+            m_threadConns[threadId].append(entry);
+            if (m_stmtCacheSize > 0) {
+                m_stmtCaches.insert(connName, new PreparedStatementCache(m_stmtCacheSize));
+            }
+        }
+        watchThread();
+        return PooledConnection(this, connName);
+    }
+
+    // 复用连接：断开则尝试重连
+    PooledConnection handle(this, connName);
+    QSqlDatabase db = handle.database();
+    if (!db.isOpen()) {
+        // 重连后服务端预处理语句失效
+        PreparedStatementCache *cache = statementCache(connName);
+        if (cache) cache->clear();
+        if (!db.open()) {
+            qCritical() << "数据库重连失败：" << connName << db.lastError().text();
+            return PooledConnection();
+        }
+    }
+    return handle;
+}
+
+// 归还连接：标记空闲并唤醒等待者
+void DbConnectionPool::release(const QString &connName)
+{
+    QMutexLocker locker(&m_poolMutex);
+    for (auto it = m_threadConns.begin(); it != m_threadConns.end(); ++it) {
+        QList<ConnEntry> &conns = it.value();
+        for (int i = 0; i < conns.size(); i++) {
+            if (conns.at(i).connName == connName) {
+                // 移到列表尾部，保证LIFO复用与头部回收
+                ConnEntry entry = conns.takeAt(i);
+                if (entry.inUse) {
+                    m_inUseCount--;
+                }
+                entry.inUse = false;
+                entry.lastUsed = QDateTime::currentDateTime();
+                conns.append(entry);
+                m_connReleased.wakeAll();
+                return;
+            }
+        }
+    }
+}
+
+void DbConnectionPool::closeThreadConnections()
+{
+    Qt::HANDLE threadId = QThread::currentThreadId();
+    QList<ConnEntry> conns;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        conns = m_threadConns.take(threadId);
+        m_watchedThreads.remove(threadId);
+        m_totalCount -= conns.size();
+        for (const ConnEntry &entry : conns) {
+            if (entry.inUse) m_inUseCount--;
+        }
+        m_connReleased.wakeAll();
+    }
+
+    for (const ConnEntry &entry : conns) {
+        closeConnection(entry.connName);
+    }
+}
+
+void DbConnectionPool::closeConnection(const QString &connName)
+{
+    PreparedStatementCache *cache = nullptr;
+    {
+        QMutexLocker locker(&m_poolMutex);
+        cache = m_stmtCaches.take(connName);
+    }
+    delete cache;
+    {
+        QSqlDatabase db = QSqlDatabase::database(connName, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connName);
+}
+
+PreparedStatementCache *DbConnectionPool::statementCache(const QString &connName)
+{
+    QMutexLocker locker(&m_poolMutex);
+    return m_stmtCaches.value(connName, nullptr);
+}
+
+quint64 DbConnectionPool::statementCacheHits() const
+{
+    return m_stmtHits.loadAcquire();
+}
+
+quint64 DbConnectionPool::statementCacheMisses() const
+{
+    return m_stmtMisses.loadAcquire();
+}
+
+int DbConnectionPool::totalCount()
+{
+    QMutexLocker locker(&m_poolMutex);
+    return m_totalCount;
+}
+
+int DbConnectionPool::idleCount()
+{
+    QMutexLocker locker(&m_poolMutex);
+    int idle = 0;
+    for (auto it = m_threadConns.constBegin(); it != m_threadConns.constEnd(); ++it) {
+        for (const ConnEntry &entry : it.value()) {
+            if (!entry.inUse) idle++;
+        }
+    }
+    return idle;
+}
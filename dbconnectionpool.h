@@ -0,0 +1,126 @@
+#ifndef DBCONNECTIONPOOL_H
+#define DBCONNECTIONPOOL_H
+
+#include <QObject>
+#include <QSqlDatabase>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QHash>
+#include <QList>
+#include <QDateTime>
+#include <QSharedPointer>
+#include <QSqlQuery>
+#include <QAtomicInteger>
+#include "preparedstatementcache.h"
+
+class DbConnectionPool;
+
+// 连接租约句柄（RAII）：析构时自动归还连接，可拷贝（共享同一租约）
+class PooledConnection
+{
+public:
+    PooledConnection() = default;
+
+    bool isValid() const;
+    QSqlDatabase database() const;
+    QString connectionName() const;
+    // 从本连接的预处理语句缓存获取语句（仅限当前线程内执行完即用，不可交给调用方长期持有）
+    QSqlQuery cachedStatement(const QString &sql, bool *hit = nullptr) const;
+    void evictStatement(const QString &sql) const;
+    // 主动归还（之后句柄失效）
+    void release();
+
+private:
+    friend class DbConnectionPool;
+    struct Lease {
+        DbConnectionPool *pool = nullptr;
+        QString connName;
+        ~Lease();
+    };
+    explicit PooledConnection(DbConnectionPool *pool, const QString &connName);
+
+    QSharedPointer<Lease> m_lease;
+};
+
+// 数据库连接池：按线程创建命名连接（QSqlDatabase不可跨线程使用），
+// 支持每线程最少空闲连接、同时借出上限、空闲回收、借出等待超时，参数读取config.ini的[Database]节
+class DbConnectionPool : public QObject
+{
+    Q_OBJECT
+public:
+    static DbConnectionPool* getInstance();
+    static void releaseInstance();
+
+    // 借出当前线程可用的连接（已打开），失败返回无效句柄
+    PooledConnection acquire();
+    // 关闭并移除当前线程的全部连接（线程退出前调用）
+    void closeThreadConnections();
+
+    // 连接池状态（调试/监控用）
+    int totalCount();
+    int idleCount();
+    // 预处理语句缓存命中/未命中次数
+    quint64 statementCacheHits() const;
+    quint64 statementCacheMisses() const;
+
+private:
+    explicit DbConnectionPool(QObject *parent = nullptr);
+    ~DbConnectionPool() override;
+
+    friend class PooledConnection;
+    // 归还连接（由租约析构调用）
+    void release(const QString &connName);
+    // 获取连接的语句缓存（由所属线程使用）
+    PreparedStatementCache* statementCache(const QString &connName);
+    // 关闭并移除连接（先释放语句缓存对连接的引用）
+    void closeConnection(const QString &connName);
+
+    // 连接条目（仅属于创建它的线程）
+    struct ConnEntry {
+        QString connName;
+        bool inUse = false;
+        QDateTime lastUsed;
+    };
+
+    // 读取配置文件中的连接参数与池参数
+    void readPoolConfig();
+    // 创建并打开一条新连接（在当前线程）
+    bool openConnection(const QString &connName);
+    // 回收当前线程超时空闲的连接（调用方需持有m_poolMutex）
+    void reapIdleConnections(Qt::HANDLE threadId, QStringList &toClose);
+    // 首次在子线程建连时挂接线程结束清理
+    void watchThread();
+    // 生成连接名：MYSQL_CONN_<线程>_<序号>
+    QString nextConnectionName();
+
+    static DbConnectionPool* m_pInstance;
+    static QMutex m_mutex;
+
+    QMutex m_poolMutex;                               // 保护以下池状态
+    QWaitCondition m_connReleased;                    // 连接归还通知
+    QHash<Qt::HANDLE, QList<ConnEntry>> m_threadConns;// 线程 -> 该线程创建的连接
+    QHash<Qt::HANDLE, bool> m_watchedThreads;         // 已挂接退出清理的线程
+    int m_totalCount = 0;                             // 已创建（含正在创建）的连接数
+    int m_inUseCount = 0;                             // 已借出（含正在创建）的连接数，受m_maxSize限制
+    quint64 m_connSerial = 0;                         // 连接名序号
+    QHash<QString, PreparedStatementCache*> m_stmtCaches; // 连接名 -> 语句缓存
+    QAtomicInteger<quint64> m_stmtHits;               // 语句缓存命中次数
+    QAtomicInteger<quint64> m_stmtMisses;             // 语句缓存未命中次数
+
+    // 连接参数
+    QString m_hostName;
+    int m_port = 3306;
+    QString m_dbName;
+    QString m_userName;
+    QString m_password;
+    int m_connectTimeout = 30;                        // 秒
+
+    // 池参数
+    int m_minSize = 1;                                // 每线程保留的最少空闲连接数
+    int m_maxSize = 8;                                // 全局同时借出的最大连接数
+    int m_idleTimeout = 300;                          // 空闲回收阈值（秒）
+    int m_waitTimeout = 5000;                         // 借出等待超时（毫秒）
+    int m_stmtCacheSize = 32;                         // 每连接缓存的预处理语句数（0=关闭）
+};
+
+#endif // DBCONNECTIONPOOL_H
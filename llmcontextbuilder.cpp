@@ -0,0 +1,113 @@
+#include "llmcontextbuilder.h"
+#include <QStringList>
+
+// 每条消息的格式开销（role、分隔符等）
+static const int MESSAGE_OVERHEAD = 4;
+// 输入预算的下限，防止配置过小导致连本轮提问都装不下
+static const int MIN_INPUT_BUDGET = 256;
+// 摘要中每次提问保留的字符数
+static const int SUMMARY_QUESTION_CHARS = 40;
+static const char *TRUNCATED_MARK = "\n……（内容过长，已截断）";
+
+LlmContextBuilder::LlmContextBuilder(int budgetTokens, int replyReserveTokens)
+    : m_budget(budgetTokens),
+      m_replyReserve(replyReserveTokens)
+{
+}
+
+int LlmContextBuilder::inputBudget() const
+{
+    return qMax(MIN_INPUT_BUDGET, m_budget - m_replyReserve);
+}
+
+int LlmContextBuilder::messageTokens(const QString &content)
+{
+    return ChatDbHelper::estimateTokens(content) + MESSAGE_OVERHEAD;
+}
+
+QJsonObject LlmContextBuilder::makeMessage(const QString &role, const QString &content)
+{
+    QJsonObject message;
+    message["role"] = role;
+    message["content"] = content;
+    return message;
+}
+
+int LlmContextBuilder::attachmentRoom(const QString &systemPrompt, const QString &question) const
+{
+    int room = inputBudget() * 3 / 4 - messageTokens(systemPrompt) - messageTokens(question);
+    return qMax(0, room);
+}
+
+QString LlmContextBuilder::truncateToTokens(const QString &text, int maxTokens)
+{
+    if (ChatDbHelper::estimateTokens(text) <= maxTokens) return text;
+
+    const QString mark = QString::fromUtf8(TRUNCATED_MARK);
+    int limit = maxTokens - ChatDbHelper::estimateTokens(mark);
+    int ascii = 0;
+    int other = 0;
+    int pos = 0;
+    for (; pos < text.size(); pos++) {
+        if (text.at(pos).unicode() < 128) ascii++;
+        else other++;
+        if ((ascii + 3) / 4 + other > limit) break;
+    }
+    return text.left(pos) + mark;
+}
+
+LlmContextBuilder::Result LlmContextBuilder::build(const QString &systemPrompt, const QList<ChatMessage> &history,
+                                                   const QString &question) const
+{
+    Result result;
+    int remaining = inputBudget() - messageTokens(systemPrompt) - messageTokens(question);
+
+    // 1. 历史从新到旧装入，单条最多占输入预算的1/4
+    int perMessageCap = qMax(64, inputBudget() / 4);
+    QList<QJsonObject> kept;
+    int index = history.size() - 1;
+    for (; index >= 0; index--) {
+        const ChatMessage &message = history.at(index);
+        QString content = message.content;
+        int tokens = message.tokens > 0 ? message.tokens : ChatDbHelper::estimateTokens(content);
+        if (tokens > perMessageCap) {
+            content = truncateToTokens(content, perMessageCap);
+            tokens = ChatDbHelper::estimateTokens(content);
+        }
+        if (tokens + MESSAGE_OVERHEAD > remaining) break;
+        remaining -= tokens + MESSAGE_OVERHEAD;
+        kept.prepend(makeMessage(message.role, content));
+    }
+
+    // 2. 装不下的更早消息：按提问生成摘要，优先保留较新的提问
+    QStringList summaryLines;
+    const QString summaryHead = "以下为更早对话中用户提问的摘要（原文已省略）：";
+    int summaryBudget = remaining - messageTokens(summaryHead);
+    for (int i = index; i >= 0 && summaryBudget > 0; i--) {
+        const ChatMessage &message = history.at(i);
+        if (message.role != "user") continue;
+        QString line = "- " + message.content.left(SUMMARY_QUESTION_CHARS).simplified();
+        if (message.content.size() > SUMMARY_QUESTION_CHARS) line += "…";
+        int tokens = ChatDbHelper::estimateTokens(line) + 1;
+        if (tokens > summaryBudget) break;
+        summaryBudget -= tokens;
+        summaryLines.prepend(line);
+    }
+
+    // 3. 组装：system → 摘要 → 历史 → 本轮提问
+    result.messages.append(makeMessage("system", systemPrompt));
+    if (!summaryLines.isEmpty()) {
+        QString summary = summaryHead + "\n" + summaryLines.join("\n");
+        result.messages.append(makeMessage("system", summary));
+        remaining -= messageTokens(summary);
+    }
+    for (const QJsonObject &message : kept) {
+        result.messages.append(message);
+    }
+    result.messages.append(makeMessage("user", question));
+
+    result.tokens = inputBudget() - remaining;
+    result.keptMessages = kept.size();
+    result.summarizedMessages = index + 1;
+    return result;
+}
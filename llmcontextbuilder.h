@@ -0,0 +1,45 @@
+#ifndef LLMCONTEXTBUILDER_H
+#define LLMCONTEXTBUILDER_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include "chatdbhelper.h"
+
+/**
+ * @brief 按token预算组装大模型请求的messages
+ * 必选部分：system提示词 + 本轮提问；其余预算按从新到旧装入历史消息，
+ * 单条过长的历史消息（如带附件的提问）截断后再装入；
+ * 装不下的更早消息压缩为一条摘要（只保留每次提问的开头），摘要同样受预算限制。
+ * token数按ChatDbHelper::estimateTokens估算，只用于控制请求规模的量级。
+ */
+class LlmContextBuilder
+{
+public:
+    struct Result {
+        QJsonArray messages;
+        int tokens = 0;             // 估算的请求token数
+        int keptMessages = 0;       // 带上的历史消息数
+        int summarizedMessages = 0; // 压缩进摘要的历史消息数
+    };
+
+    LlmContextBuilder(int budgetTokens, int replyReserveTokens);
+
+    // 本轮附件最多可占用的token数（为历史对话至少留出1/4预算）
+    int attachmentRoom(const QString &systemPrompt, const QString &question) const;
+    Result build(const QString &systemPrompt, const QList<ChatMessage> &history, const QString &question) const;
+
+    // 按估算token数截断文本（保留开头，末尾注明已截断）
+    static QString truncateToTokens(const QString &text, int maxTokens);
+
+private:
+    // 可用于输入的token数（总预算扣除给回复预留的部分）
+    int inputBudget() const;
+    static int messageTokens(const QString &content);
+    static QJsonObject makeMessage(const QString &role, const QString &content);
+
+    int m_budget;
+    int m_replyReserve;
+};
+
+#endif // LLMCONTEXTBUILDER_H
@@ -0,0 +1,133 @@
+#include "llmfileloader.h"
+#include <QFile>
+#include "chatdbhelper.h"
+#include "llmcontextbuilder.h"
+#include "loghelper.h"
+
+LlmFileLoader::LlmFileLoader(const QString &filePath, int chunkTokens, int maxChunks, QObject *parent)
+    : QThread(parent),
+      m_filePath(filePath),
+      m_chunkTokens(qMax(64, chunkTokens)),
+      m_maxChunks(qMax(1, maxChunks))
+{
+}
+
+LlmFileLoader::~LlmFileLoader()
+{
+    requestInterruption();
+    wait();
+}
+
+void LlmFileLoader::run()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        emit loadFinished(QStringList(), false, "文件打开失败：" + file.errorString());
+        return;
+    }
+
+    // ASCII约4字节/token、中文约3字节/token：按4字节估算仍超过段数上限时，必然放不下，直接抽样
+    bool partial = false;
+    QStringList chunks;
+    if (file.size() / 4 > qint64(m_chunkTokens) * m_maxChunks) {
+        chunks = readSampled(file);
+        partial = true;
+    } else {
+        chunks = readSequential(file, &partial);
+    }
+    if (isInterruptionRequested()) return;
+
+    LOG_INFO("LLM模块", "【文件】读取完成：" << m_filePath << "，大小=" << file.size()
+             << "，分段=" << chunks.size() << "，部分纳入=" << partial);
+    emit loadFinished(chunks, partial, QString());
+}
+
+QByteArray LlmFileLoader::readLimitedLine(QFile &file) const
+{
+    // 单段预算按4字节/token换算即足够截断，无需读出整行
+    const qint64 maxBytes = qint64(m_chunkTokens) * 4;
+    QByteArray line = file.readLine(maxBytes);
+    if (!line.endsWith('\n')) {
+        // 跳过该行剩余部分（如无换行的JSON、只用\r刷新的进度日志）
+        QByteArray rest;
+        do {
+            rest = file.readLine(maxBytes);
+        } while (!rest.isEmpty() && !rest.endsWith('\n'));
+    }
+    return line;
+}
+
+QString LlmFileLoader::fitLine(const QByteArray &raw, int *tokens) const
+{
+    QString line = QString::fromUtf8(raw);
+    *tokens = ChatDbHelper::estimateTokens(line);
+    // 留出抽样段标题的余量
+    int limit = m_chunkTokens * 3 / 4;
+    if (*tokens > limit) {
+        line = LlmContextBuilder::truncateToTokens(line, limit) + "\n";
+        *tokens = ChatDbHelper::estimateTokens(line);
+    }
+    return line;
+}
+
+QStringList LlmFileLoader::readSequential(QFile &file, bool *partial)
+{
+    QStringList chunks;
+    QString chunk;
+    int chunkTokens = 0;
+    qint64 total = qMax<qint64>(1, file.size());
+    int lastPercent = -1;
+
+    while (!file.atEnd() && !isInterruptionRequested()) {
+        int lineTokens = 0;
+        QString line = fitLine(readLimitedLine(file), &lineTokens);
+        if (chunkTokens + lineTokens > m_chunkTokens && !chunk.isEmpty()) {
+            chunks << chunk;
+            chunk.clear();
+            chunkTokens = 0;
+            if (chunks.size() >= m_maxChunks) {
+                *partial = true;
+                return chunks;
+            }
+        }
+        chunk += line;
+        chunkTokens += lineTokens;
+
+        int percent = static_cast<int>(file.pos() * 100 / total);
+        if (percent != lastPercent) {
+            lastPercent = percent;
+            emit progressChanged(percent);
+        }
+    }
+    if (!chunk.isEmpty()) {
+        chunks << chunk;
+    }
+    return chunks;
+}
+
+QStringList LlmFileLoader::readSampled(QFile &file)
+{
+    QStringList chunks;
+    qint64 total = file.size();
+    for (int i = 0; i < m_maxChunks && !isInterruptionRequested(); i++) {
+        qint64 begin = total * i / m_maxChunks;
+        qint64 end = total * (i + 1) / m_maxChunks;
+        if (!file.seek(begin)) break;
+        if (i > 0) {
+            readLimitedLine(file); // 跳过被区间起点截断的行
+        }
+
+        QString chunk = QString("（文件第%1/%2部分，约从%3%处开始）\n").arg(i + 1).arg(m_maxChunks).arg(begin * 100 / total);
+        int chunkTokens = ChatDbHelper::estimateTokens(chunk);
+        while (file.pos() < end && !file.atEnd()) {
+            int lineTokens = 0;
+            QString line = fitLine(readLimitedLine(file), &lineTokens);
+            if (chunkTokens + lineTokens > m_chunkTokens) break;
+            chunk += line;
+            chunkTokens += lineTokens;
+        }
+        chunks << chunk;
+        emit progressChanged((i + 1) * 100 / m_maxChunks);
+    }
+    return chunks;
+}
@@ -0,0 +1,46 @@
+#ifndef LLMFILELOADER_H
+#define LLMFILELOADER_H
+
+#include <QThread>
+#include <QStringList>
+
+class QFile;
+
+/**
+ * @brief 上传文件的后台读取与分段
+ * 在工作线程中按行流式读取，按token上限切成若干段（不在界面线程readAll）；
+ * 文件大到超过maxChunks段时改为均匀抽样：把文件等分为maxChunks个区间，每个区间从行首起取满一段。
+ * 单行超过一段上限的3/4时截断该行。
+ */
+class LlmFileLoader : public QThread
+{
+    Q_OBJECT
+public:
+    LlmFileLoader(const QString &filePath, int chunkTokens, int maxChunks, QObject *parent = nullptr);
+    ~LlmFileLoader() override;
+
+signals:
+    // 读取进度（0~100）
+    void progressChanged(int percent);
+    // 读取完成：partial=true表示文件未全部纳入（抽样或达到段数上限）；出错时errorText非空
+    void loadFinished(const QStringList &chunks, bool partial, const QString &errorText);
+
+protected:
+    void run() override;
+
+private:
+    // 顺序读取全部内容，达到段数上限时停止
+    QStringList readSequential(QFile &file, bool *partial);
+    // 均匀抽样读取
+    QStringList readSampled(QFile &file);
+    // 读出一行，最多读取单段预算约4倍的字节，超出部分直接跳过（超长行不整行载入内存）
+    QByteArray readLimitedLine(QFile &file) const;
+    // 读出一行并估算token，过长时截断
+    QString fitLine(const QByteArray &raw, int *tokens) const;
+
+    QString m_filePath;
+    int m_chunkTokens;
+    int m_maxChunks;
+};
+
+#endif // LLMFILELOADER_H
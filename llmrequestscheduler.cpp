@@ -0,0 +1,143 @@
+#include "llmrequestscheduler.h"
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTimer>
+#include "loghelper.h"
+
+LlmRequestScheduler::LlmRequestScheduler(QObject *parent)
+    : QObject(parent),
+      m_manager(new QNetworkAccessManager(this))
+{
+}
+
+LlmRequestScheduler::~LlmRequestScheduler()
+{
+    // 析构时中止进行中的请求，不再通知接收方
+    blockSignals(true);
+    m_pending.clear();
+    const QList<QNetworkReply*> replies = m_running.values();
+    for (QNetworkReply *reply : replies) {
+        disconnect(reply, nullptr, this, nullptr);
+        reply->abort();
+        reply->deleteLater();
+    }
+    m_running.clear();
+}
+
+void LlmRequestScheduler::setDefaultLimit(int limit)
+{
+    m_defaultLimit = qMax(1, limit);
+    scheduleDispatch();
+}
+
+void LlmRequestScheduler::setModelLimit(const QString &model, int limit)
+{
+    m_modelLimits[model] = qMax(1, limit);
+    scheduleDispatch();
+}
+
+int LlmRequestScheduler::limitOf(const QString &model) const
+{
+    return m_modelLimits.value(model, m_defaultLimit);
+}
+
+int LlmRequestScheduler::submit(const QString &model, const QNetworkRequest &request, const QByteArray &body, Priority priority)
+{
+    PendingRequest pending;
+    pending.id = m_nextId++;
+    pending.model = model;
+    pending.request = request;
+    pending.body = body;
+    pending.priority = priority;
+
+    // 插到第一个优先级更低的请求之前，同优先级保持先进先出
+    int pos = 0;
+    while (pos < m_pending.size() && m_pending.at(pos).priority >= priority) {
+        pos++;
+    }
+    m_pending.insert(pos, pending);
+    if (m_runningPerModel.value(model) >= limitOf(model)) {
+        LOG_DEBUG("LLM模块", "【调度】请求排队：ID=" << pending.id << "，模型=" << model << "，优先级=" << priority
+                  << "，排队数=" << m_pending.size());
+    }
+    scheduleDispatch();
+    return pending.id;
+}
+
+bool LlmRequestScheduler::cancel(int requestId)
+{
+    for (int i = 0; i < m_pending.size(); i++) {
+        if (m_pending.at(i).id == requestId) {
+            m_pending.removeAt(i);
+            emit requestFinished(requestId, nullptr);
+            return true;
+        }
+    }
+    QNetworkReply *reply = m_running.value(requestId);
+    if (!reply) return false;
+    // 以OperationCanceledError结束，经onReplyFinished发出requestFinished
+    reply->abort();
+    return true;
+}
+
+void LlmRequestScheduler::cancelAll()
+{
+    // 先清空队列，避免中止进行中的请求时又发出排队的请求
+    const QList<PendingRequest> pending = m_pending;
+    m_pending.clear();
+    for (const PendingRequest &request : pending) {
+        emit requestFinished(request.id, nullptr);
+    }
+    const QList<int> running = m_running.keys();
+    for (int requestId : running) {
+        cancel(requestId);
+    }
+}
+
+void LlmRequestScheduler::scheduleDispatch()
+{
+    if (m_dispatchScheduled) return;
+    m_dispatchScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_dispatchScheduled = false;
+        dispatch();
+    });
+}
+
+void LlmRequestScheduler::dispatch()
+{
+    for (int i = 0; i < m_pending.size();) {
+        const PendingRequest &pending = m_pending.at(i);
+        if (m_runningPerModel.value(pending.model) >= limitOf(pending.model)) {
+            i++;
+            continue;
+        }
+
+        PendingRequest request = m_pending.takeAt(i);
+        QNetworkReply *reply = m_manager->post(request.request, request.body);
+        reply->setProperty("llmRequestId", request.id);
+        m_running.insert(request.id, reply);
+        m_runningModel.insert(request.id, request.model);
+        m_runningPerModel[request.model]++;
+        connect(reply, &QNetworkReply::finished, this, &LlmRequestScheduler::onReplyFinished, Qt::QueuedConnection);
+        emit requestStarted(request.id, reply);
+    }
+}
+
+void LlmRequestScheduler::onReplyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) return;
+    int requestId = reply->property("llmRequestId").toInt();
+    if (m_running.value(requestId) != reply) return;
+
+    m_running.remove(requestId);
+    QString model = m_runningModel.take(requestId);
+    if (--m_runningPerModel[model] <= 0) {
+        m_runningPerModel.remove(model);
+    }
+
+    emit requestFinished(requestId, reply);
+    reply->deleteLater();
+    dispatch();
+}
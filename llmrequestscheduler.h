@@ -0,0 +1,81 @@
+#ifndef LLMREQUESTSCHEDULER_H
+#define LLMREQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QNetworkRequest>
+#include <QByteArray>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/**
+ * @brief 大模型请求调度器
+ * 所有请求共用一个QNetworkAccessManager（同一接口地址复用keep-alive连接），
+ * 按模型限制并发数，超出的请求排队：优先级高的先发，同优先级先进先出。
+ * 每个请求有独立的ID，可单独取消；排队中的请求取消时以reply=nullptr发出requestFinished。
+ * 提交的请求在下一次事件循环才发出，调用方可在submit返回后再按ID记录请求状态。
+ */
+class LlmRequestScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    enum Priority {
+        Low = 0,     // 后台批量请求（如大文件分段分析）
+        Normal = 1,
+        High = 2     // 用户交互请求
+    };
+
+    explicit LlmRequestScheduler(QObject *parent = nullptr);
+    ~LlmRequestScheduler() override;
+
+    // 未单独设置的模型的并发上限
+    void setDefaultLimit(int limit);
+    void setModelLimit(const QString &model, int limit);
+
+    // 提交POST请求，返回请求ID；有空闲并发名额时在下一次事件循环发出
+    int submit(const QString &model, const QNetworkRequest &request, const QByteArray &body, Priority priority = Normal);
+    // 取消单个请求：排队中的直接移除，已发出的abort；请求不存在时返回false
+    bool cancel(int requestId);
+    void cancelAll();
+
+    bool isRunning(int requestId) const { return m_running.contains(requestId); }
+    int pendingCount() const { return m_pending.size(); }
+    int runningCount() const { return m_running.size(); }
+
+signals:
+    // 请求已发出（流式请求在此连接readyRead）
+    void requestStarted(int requestId, QNetworkReply *reply);
+    // 请求结束（成功/失败/取消）；reply在槽函数返回后由调度器释放，排队中被取消时为nullptr
+    void requestFinished(int requestId, QNetworkReply *reply);
+
+private slots:
+    void onReplyFinished();
+
+private:
+    struct PendingRequest {
+        int id = 0;
+        QString model;
+        QNetworkRequest request;
+        QByteArray body;
+        Priority priority = Normal;
+    };
+
+    int limitOf(const QString &model) const;
+    // 按优先级发出所有有空闲名额的排队请求
+    void dispatch();
+    void scheduleDispatch();
+
+    QNetworkAccessManager *m_manager;
+    QList<PendingRequest> m_pending;          // 按优先级降序、同优先级按提交顺序
+    QHash<int, QNetworkReply*> m_running;
+    QHash<int, QString> m_runningModel;
+    QHash<QString, int> m_runningPerModel;
+    QHash<QString, int> m_modelLimits;
+    int m_defaultLimit = 2;
+    int m_nextId = 1;
+    bool m_dispatchScheduled = false;
+};
+
+#endif // LLMREQUESTSCHEDULER_H
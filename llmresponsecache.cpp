@@ -0,0 +1,165 @@
+#include "llmresponsecache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "loghelper.h"
+
+LlmResponseCache::LlmResponseCache(const QString &cacheDir, int memoryEntries, qint64 maxDiskBytes, qint64 ttlSecs)
+    : m_cacheDir(cacheDir),
+      m_memoryEntries(memoryEntries),
+      m_maxDiskBytes(maxDiskBytes),
+      m_ttlSecs(ttlSecs)
+{
+}
+
+QString LlmResponseCache::makeKey(const QString &apiUrl, const QString &model, double temperature, const QJsonArray &messages)
+{
+    // 同名模型在不同服务商/部署下回复不同，API地址也计入键
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(apiUrl.toUtf8());
+    hash.addData("\n", 1);
+    hash.addData(model.toUtf8());
+    hash.addData("\n", 1);
+    hash.addData(QByteArray::number(temperature, 'g', 6));
+    hash.addData("\n", 1);
+    hash.addData(QJsonDocument(messages).toJson(QJsonDocument::Compact));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool LlmResponseCache::lookup(const QString &key, QString *content)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        if (!isExpired(it->createdSecs)) {
+            m_lruOrder.removeOne(key);
+            m_lruOrder.append(key);
+            if (content) *content = it->content;
+            return true;
+        }
+        // 过期：磁盘上的同名文件也已过期，交给readDisk删除
+        m_entries.erase(it);
+        m_lruOrder.removeOne(key);
+    }
+
+    Entry entry;
+    if (!readDisk(key, &entry)) return false;
+    insertMemory(key, entry);
+    if (content) *content = entry.content;
+    return true;
+}
+
+void LlmResponseCache::insert(const QString &key, const QString &content)
+{
+    if (key.isEmpty() || content.isEmpty()) return;
+    Entry entry;
+    entry.content = content;
+    entry.createdSecs = QDateTime::currentSecsSinceEpoch();
+    insertMemory(key, entry);
+    writeDisk(key, entry);
+}
+
+void LlmResponseCache::clear()
+{
+    m_entries.clear();
+    m_lruOrder.clear();
+    QDir dir(m_cacheDir);
+    for (const QString &name : dir.entryList(QStringList() << "*.json", QDir::Files)) {
+        dir.remove(name);
+    }
+    m_diskBytes = 0;
+}
+
+QString LlmResponseCache::filePath(const QString &key) const
+{
+    return m_cacheDir + "/" + key + ".json";
+}
+
+bool LlmResponseCache::isExpired(qint64 createdSecs) const
+{
+    return m_ttlSecs > 0 && QDateTime::currentSecsSinceEpoch() - createdSecs > m_ttlSecs;
+}
+
+void LlmResponseCache::insertMemory(const QString &key, const Entry &entry)
+{
+    if (m_memoryEntries <= 0) return;
+    if (m_entries.contains(key)) {
+        m_lruOrder.removeOne(key);
+    }
+    while (m_entries.size() >= m_memoryEntries && !m_lruOrder.isEmpty()) {
+        m_entries.remove(m_lruOrder.takeFirst());
+    }
+    m_entries.insert(key, entry);
+    m_lruOrder.append(key);
+}
+
+bool LlmResponseCache::readDisk(const QString &key, Entry *entry)
+{
+    if (m_maxDiskBytes <= 0) return false;
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QJsonObject obj = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    entry->content = obj["content"].toString();
+    entry->createdSecs = static_cast<qint64>(obj["created"].toDouble());
+    if (entry->content.isEmpty() || isExpired(entry->createdSecs)) {
+        if (m_diskBytes >= 0) m_diskBytes -= file.size();
+        file.remove();
+        return false;
+    }
+    return true;
+}
+
+void LlmResponseCache::writeDisk(const QString &key, const Entry &entry)
+{
+    if (m_maxDiskBytes <= 0) return;
+    if (!QDir().mkpath(m_cacheDir)) {
+        LOG_WARN("LLM模块", "【缓存】创建缓存目录失败：" << m_cacheDir);
+        return;
+    }
+
+    QJsonObject obj;
+    obj["created"] = static_cast<double>(entry.createdSecs);
+    obj["content"] = entry.content;
+    QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+
+    QFile file(filePath(key));
+    qint64 oldSize = file.exists() ? file.size() : 0;
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(data) != data.size()) {
+        LOG_WARN("LLM模块", "【缓存】写入缓存文件失败：" << file.fileName());
+        return;
+    }
+    file.close();
+
+    if (m_diskBytes >= 0) m_diskBytes += data.size() - oldSize;
+    enforceDiskLimit();
+}
+
+void LlmResponseCache::enforceDiskLimit()
+{
+    QDir dir(m_cacheDir);
+    if (m_diskBytes < 0) {
+        m_diskBytes = 0;
+        for (const QFileInfo &info : dir.entryInfoList(QStringList() << "*.json", QDir::Files)) {
+            m_diskBytes += info.size();
+        }
+    }
+    if (m_diskBytes <= m_maxDiskBytes) return;
+
+    // 按修改时间从旧到新删除，直到降到容量的90%以下，避免每次写入都触发扫描
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.json", QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 target = m_maxDiskBytes * 9 / 10;
+    for (const QFileInfo &info : files) {
+        if (m_diskBytes <= target) break;
+        if (dir.remove(info.fileName())) {
+            m_diskBytes -= info.size();
+            QString key = info.completeBaseName();
+            m_entries.remove(key);
+            m_lruOrder.removeOne(key);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef LLMRESPONSECACHE_H
+#define LLMRESPONSECACHE_H
+
+#include <QHash>
+#include <QStringList>
+#include <QJsonArray>
+
+/**
+ * @brief 大模型回复缓存：内存LRU + 磁盘文件两级
+ * 键为(API地址, 模型, temperature, 完整messages)的SHA-256，相同上下文的相同提问直接返回上次的回复。
+ * 磁盘每条一个文件（<key>.json），超过总容量时按写入时间淘汰最早的；
+ * 两级都按TTL过期。非线程安全，仅由界面线程使用。
+ */
+class LlmResponseCache
+{
+public:
+    LlmResponseCache(const QString &cacheDir, int memoryEntries, qint64 maxDiskBytes, qint64 ttlSecs);
+
+    static QString makeKey(const QString &apiUrl, const QString &model, double temperature, const QJsonArray &messages);
+
+    // 命中返回true并写出回复内容（磁盘命中会同时载入内存）
+    bool lookup(const QString &key, QString *content);
+    void insert(const QString &key, const QString &content);
+    void clear();
+
+private:
+    struct Entry {
+        QString content;
+        qint64 createdSecs = 0;
+    };
+
+    QString filePath(const QString &key) const;
+    bool isExpired(qint64 createdSecs) const;
+    // 放入内存并淘汰最久未使用的条目
+    void insertMemory(const QString &key, const Entry &entry);
+    bool readDisk(const QString &key, Entry *entry);
+    void writeDisk(const QString &key, const Entry &entry);
+    // 磁盘总量超限时删除最早写入的文件
+    void enforceDiskLimit();
+
+    QString m_cacheDir;
+    int m_memoryEntries;
+    qint64 m_maxDiskBytes;
+    qint64 m_ttlSecs;
+    QHash<QString, Entry> m_entries;
+    QStringList m_lruOrder;   // 尾部为最近使用
+    qint64 m_diskBytes = -1;  // 磁盘占用（-1=尚未统计）
+};
+
+#endif // LLMRESPONSECACHE_H
@@ -0,0 +1,80 @@
+#include "llmstreamparser.h"
+
+QStringList LlmSseParser::feed(const QByteArray &chunk)
+{
+    QStringList events;
+    m_buffer.append(chunk);
+
+    int start = 0;
+    int newline;
+    while ((newline = m_buffer.indexOf('\n', start)) >= 0) {
+        processLine(m_buffer.mid(start, newline - start), events);
+        start = newline + 1;
+    }
+    m_buffer.remove(0, start);
+    return events;
+}
+
+QStringList LlmSseParser::flush()
+{
+    QStringList events;
+    if (!m_buffer.isEmpty()) {
+        processLine(m_buffer, events);
+        m_buffer.clear();
+    }
+    dispatchEvent(events);
+    return events;
+}
+
+void LlmSseParser::reset()
+{
+    m_buffer.clear();
+    m_eventData.clear();
+    m_hasData = false;
+    m_done = false;
+    m_eventCount = 0;
+}
+
+void LlmSseParser::processLine(QByteArray line, QStringList &events)
+{
+    if (line.endsWith('\r')) {
+        line.chop(1);
+    }
+
+    // 空行：事件结束
+    if (line.isEmpty()) {
+        dispatchEvent(events);
+        return;
+    }
+    // 注释行（常用作心跳）
+    if (line.startsWith(':')) {
+        return;
+    }
+    // 只关心data字段，event/id/retry忽略
+    if (line.startsWith("data:")) {
+        QByteArray value = line.mid(5);
+        if (value.startsWith(' ')) {
+            value.remove(0, 1);
+        }
+        if (m_hasData) {
+            m_eventData.append('\n');
+        }
+        m_eventData.append(value);
+        m_hasData = true;
+    }
+}
+
+void LlmSseParser::dispatchEvent(QStringList &events)
+{
+    if (!m_hasData) {
+        return;
+    }
+    if (m_eventData == "[DONE]") {
+        m_done = true;
+    } else {
+        events << QString::fromUtf8(m_eventData);
+    }
+    m_eventCount++;
+    m_eventData.clear();
+    m_hasData = false;
+}
@@ -0,0 +1,36 @@
+#ifndef LLMSTREAMPARSER_H
+#define LLMSTREAMPARSER_H
+
+#include <QByteArray>
+#include <QStringList>
+
+/**
+ * @brief SSE（server-sent events）增量解析器
+ * 按QNetworkReply::readyRead收到的任意字节块喂入，跨块的半行保留到下次；
+ * 空行结束一个事件，返回该事件所有data行（多行以\n连接）。
+ * 收到 "data: [DONE]" 时置完成标记，不作为事件返回。
+ */
+class LlmSseParser
+{
+public:
+    // 追加字节，返回本次凑齐的完整事件
+    QStringList feed(const QByteArray &chunk);
+    // 连接结束：把末尾未以空行结束的事件也交出
+    QStringList flush();
+    bool isDone() const { return m_done; }
+    // 是否已解析出过事件（用于判断服务端是否真的按SSE返回）
+    bool hasEvents() const { return m_eventCount > 0; }
+    void reset();
+
+private:
+    void processLine(QByteArray line, QStringList &events);
+    void dispatchEvent(QStringList &events);
+
+    QByteArray m_buffer;      // 未凑成整行的字节
+    QByteArray m_eventData;   // 当前事件已收到的data
+    bool m_hasData = false;
+    bool m_done = false;
+    int m_eventCount = 0;
+};
+
+#endif // LLMSTREAMPARSER_H
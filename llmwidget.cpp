@@ -3,7 +3,6 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QJsonDocument>
-#include <QRegularExpression>
 #include <QSqlQuery>
 #include <QLabel>
 #include <QInputDialog>
@@ -21,10 +20,24 @@
 #include "loghelper.h"
 #include "logmanager.h"
 #include "iphelper.h"
+#include "llmcontextbuilder.h"
+#include "llmresponsecache.h"
 #include <QTextCursor>
 #include <QTextCharFormat>
 #include <QStyle>
 #include <QFileInfo>  // 新增：用于获取文件信息
+#include <QScrollBar>
+#include <QSettings>
+#include <QRegularExpression>
+
+// 打开对话时先渲染的消息条数（更早的消息在滚动到顶部时按批渲染）
+static const int CHAT_RENDER_BATCH = 20;
+// 系统提示词
+static const char *LLM_SYSTEM_PROMPT = "你是一个有用的AI助手，专注于李雅普诺夫函数控制器算法的数据分析。";
+// 文件分段时为提问预留的token数
+static const int FILE_QUESTION_RESERVE = 256;
+// 对话列表项的标题（搜索结果项用富文本控件显示，item text为空）
+static const int DIALOG_TITLE_ROLE = Qt::UserRole + 1;
 
 // ---------- 构造与析构 ----------
 LLMWidget::LLMWidget(int currentUserId, QWidget *parent)
@@ -34,16 +47,15 @@ LLMWidget::LLMWidget(int currentUserId, QWidget *parent)
       m_currentUserId(currentUserId),
       m_currentDialogId(-1),
       m_selectedModelCode(),
-      m_fileContent(),
+      m_fileChunks(),
+      m_chatDb(new ChatDbHelper(this)),
 
       // 2. 网络请求相关
-      m_netManager(new QNetworkAccessManager(this)),
-      m_currentReply(nullptr),
+      m_scheduler(new LlmRequestScheduler(this)),
 
       // 3. UI 状态控制
       m_isDialogListCollapsed(false),
       m_isInit(true),
-      m_isRequestProcessing(false),
 
       // 4. UI 控件（菜单/动作）
       m_dialogContextMenu(nullptr),
@@ -76,6 +88,7 @@ LLMWidget::LLMWidget(int currentUserId, QWidget *parent)
     }
 
     LOG_INFO("LLM模块", "【LLMWidget】初始化，用户ID=" << m_currentUserId);
+    loadLlmConfig();
     initUI();
 
     QTimer::singleShot(50, this, &LLMWidget::loadModelList);
@@ -84,14 +97,52 @@ LLMWidget::LLMWidget(int currentUserId, QWidget *parent)
 
 LLMWidget::~LLMWidget()
 {
-    // 安全清理网络请求
-    if (m_currentReply) {
-        if (!m_currentReply->isFinished()) {
-            m_currentReply->abort();
+    // 进行中的网络请求由调度器析构时中止
+    delete m_responseCache;
+}
+
+// ---------- 读取config.ini的[LLM]节 ----------
+void LLMWidget::loadLlmConfig()
+{
+    QSettings config(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+    config.beginGroup("LLM");
+    m_streamMode = config.value("StreamMode", true).toBool();
+    m_defaultContextTokens = config.value("ContextTokens", 8000).toInt();
+    m_replyReserveTokens = config.value("ReplyReserveTokens", 1024).toInt();
+    m_maxFileChunks = qMax(1, config.value("FileMaxChunks", 16).toInt());
+    m_dialogPageSize = qMax(10, config.value("DialogPageSize", 50).toInt());
+    m_searchResultLimit = qMax(1, config.value("SearchResultLimit", 50).toInt());
+    config.endGroup();
+
+    // 各模型的并发请求上限（Default为未单独配置的模型）
+    config.beginGroup("LLMConcurrency");
+    const QStringList modelKeys = config.childKeys();
+    for (const QString &key : modelKeys) {
+        int limit = config.value(key).toInt();
+        if (key == "Default") {
+            m_scheduler->setDefaultLimit(limit);
+        } else {
+            m_scheduler->setModelLimit(key, limit);
         }
-        m_currentReply->deleteLater();
-        m_currentReply = nullptr;
     }
+    config.endGroup();
+    LOG_DEBUG("LLM模块", "【配置】流式输出=" << m_streamMode << "，默认上下文预算=" << m_defaultContextTokens
+              << "，回复预留=" << m_replyReserveTokens);
+
+    // 回复缓存（按用户分目录）
+    config.beginGroup("LLMCache");
+    bool cacheEnabled = config.value("Enabled", true).toBool();
+    int memoryEntries = config.value("MemoryEntries", 64).toInt();
+    qint64 diskMaxBytes = config.value("DiskMaxMB", 64).toLongLong() * 1024 * 1024;
+    qint64 ttlSecs = config.value("TtlHours", 24).toLongLong() * 3600;
+    m_cacheNonZeroTemperature = config.value("CacheNonZeroTemperature", false).toBool();
+    config.endGroup();
+    if (cacheEnabled) {
+        QString cacheDir = QCoreApplication::applicationDirPath() + QString("/cache/llm/%1").arg(m_currentUserId);
+        m_responseCache = new LlmResponseCache(cacheDir, memoryEntries, diskMaxBytes, ttlSecs);
+    }
+    LOG_DEBUG("LLM模块", "【配置】回复缓存=" << cacheEnabled << "，内存条数=" << memoryEntries
+              << "，TTL(秒)=" << ttlSecs << "，temperature>0时缓存=" << m_cacheNonZeroTemperature);
 }
 
 // ---------- UI 初始化（新增MathJax支持 + 历史对话标签 + 文件上传显示） ----------
@@ -131,9 +182,18 @@ void LLMWidget::initUI()
     dialogTitleLabel->setStyleSheet("font-weight: bold; font-size: 14px; padding: 5px; color: #2c3e50;");
     dialogTitleLabel->setAlignment(Qt::AlignLeft);
 
+    // 对话内容搜索框（输入停止300ms后再查询）
+    m_dialogSearchEdit = new QLineEdit(this);
+    m_dialogSearchEdit->setPlaceholderText("搜索对话内容…");
+    m_dialogSearchEdit->setClearButtonEnabled(true);
+    m_searchTimer = new QTimer(this);
+    m_searchTimer->setSingleShot(true);
+    m_searchTimer->setInterval(300);
+
     // 新增：将标签和列表封装到垂直布局
     QVBoxLayout *leftLayout = new QVBoxLayout();
     leftLayout->addWidget(dialogTitleLabel);  // 添加历史对话标签
+    leftLayout->addWidget(m_dialogSearchEdit);
     leftLayout->addWidget(m_dialogList);      // 添加对话列表
     leftLayout->setContentsMargins(0, 0, 0, 0); // 去除布局边距，优化UI
 
@@ -235,6 +295,12 @@ void LLMWidget::initUI()
     connect(m_modelCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
             this, &LLMWidget::onModelChanged);
     connect(m_addModelBtn, &QPushButton::clicked, this, &LLMWidget::onAddModelBtnClicked);
+    connect(m_chatContentEdit->verticalScrollBar(), &QScrollBar::valueChanged, this, &LLMWidget::onChatScrollValueChanged);
+    connect(m_dialogList->verticalScrollBar(), &QScrollBar::valueChanged, this, &LLMWidget::onDialogListScrolled);
+    connect(m_dialogSearchEdit, &QLineEdit::textChanged, this, &LLMWidget::onDialogSearchTextChanged);
+    connect(m_searchTimer, &QTimer::timeout, this, &LLMWidget::loadHistoryDialogs);
+    connect(m_scheduler, &LlmRequestScheduler::requestStarted, this, &LLMWidget::onRequestStarted);
+    connect(m_scheduler, &LlmRequestScheduler::requestFinished, this, &LLMWidget::onRequestFinished);
 }
 
 // ---------- 历史对话加载 ----------
@@ -242,7 +308,10 @@ void LLMWidget::loadHistoryDialogs()
 {
     LOG_DEBUG("LLM模块", "【DB】加载历史对话 用户ID=" << m_currentUserId);
     if (!m_dialogList) return;
+    m_dialogHasMore = false; // clear()触发的滚动信号不加载旧游标之后的数据
     m_dialogList->clear();
+    m_dialogCursorTime = QDateTime();
+    m_dialogCursorId = 0;
 
     BaseDbHelper *db = BaseDbHelper::getInstance();
     if (!db || !db->checkDbConn()) {
@@ -251,30 +320,123 @@ void LLMWidget::loadHistoryDialogs()
         return;
     }
 
-    QString sql = QString("SELECT id, dialog_title FROM chat_dialog WHERE user_id = %1 ORDER BY update_time DESC").arg(m_currentUserId);
-    QSqlQuery q = db->execQuery(sql);
-    if (q.lastError().isValid()) {
-        LOG_ERROR("LLM模块", "加载历史对话失败：" << q.lastError().text());
-        QMessageBox::warning(this, "警告", "加载历史对话失败：" + q.lastError().text());
+    // 搜索框有内容时列表显示搜索结果（不分页）
+    QString keyword = m_dialogSearchEdit ? m_dialogSearchEdit->text().trimmed() : QString();
+    if (!keyword.isEmpty()) {
+        showSearchResults(keyword);
         return;
     }
+    m_dialogHasMore = true;
+
+    // 先加载第一页，其余在列表滚动到底部时再加载
+    if (!loadMoreDialogs()) {
+        QMessageBox::warning(this, "警告", "加载历史对话失败：" + db->getLastError());
+        return;
+    }
+    // 第一页填不满列表时继续加载，否则没有滚动条可以触发（列表布局是延迟的，按行高估算）
+    while (m_dialogHasMore && m_dialogList->count() * m_dialogList->sizeHintForRow(0) < m_dialogList->viewport()->height()) {
+        if (!loadMoreDialogs()) break;
+    }
+    LOG_DEBUG("LLM模块", "【DB】历史对话加载完成，共" << m_dialogList->count());
+}
+
+// ---------- 加载下一页对话（只读id/标题/更新时间，内容点击时再读） ----------
+bool LLMWidget::loadMoreDialogs()
+{
+    if (!m_dialogList || !m_dialogHasMore) return true;
+
+    bool ok = false;
+    QList<ChatDialogSummary> dialogs = m_chatDb->loadDialogPage(m_currentUserId, m_dialogCursorTime, m_dialogCursorId,
+                                                                m_dialogPageSize, &ok);
+    if (!ok) return false;
+    m_dialogHasMore = (dialogs.size() == m_dialogPageSize);
+    if (dialogs.isEmpty()) return true;
 
     // Add message icon to each dialog item
     QIcon msgIcon = style()->standardIcon(QStyle::SP_MessageBoxInformation);
-    while (q.next()) {
-        int id = q.value(0).toInt();
-        QString title = q.value(1).toString();
-        QListWidgetItem *it = new QListWidgetItem(title);
-        it->setData(Qt::UserRole, id);
+    for (const ChatDialogSummary &dialog : dialogs) {
+        QListWidgetItem *it = new QListWidgetItem(dialog.title);
+        it->setData(Qt::UserRole, dialog.id);
+        it->setData(DIALOG_TITLE_ROLE, dialog.title);
         it->setIcon(msgIcon); // Add icon
         m_dialogList->addItem(it);
 
         // Highlight current dialog
-        if (id == m_currentDialogId) {
+        if (dialog.id == m_currentDialogId) {
             m_dialogList->setCurrentItem(it);
         }
     }
-    LOG_DEBUG("LLM模块", "【DB】历史对话加载完成，共" << m_dialogList->count());
+    m_dialogCursorTime = dialogs.last().update_time;
+    m_dialogCursorId = dialogs.last().id;
+    return true;
+}
+
+void LLMWidget::onDialogListScrolled(int value)
+{
+    QScrollBar *bar = m_dialogList ? m_dialogList->verticalScrollBar() : nullptr;
+    if (!bar || !m_dialogHasMore || value < bar->maximum()) return;
+    loadMoreDialogs();
+}
+
+void LLMWidget::onDialogSearchTextChanged(const QString &text)
+{
+    Q_UNUSED(text);
+    if (m_searchTimer) m_searchTimer->start();
+}
+
+// ---------- 对话内容搜索 ----------
+void LLMWidget::showSearchResults(const QString &keyword)
+{
+    QElapsedTimer timer;
+    timer.start();
+    bool ok = false;
+    QList<ChatSearchHit> hits = m_chatDb->searchDialogs(m_currentUserId, keyword, m_searchResultLimit, &ok);
+    if (!ok) {
+        QMessageBox::warning(this, "警告", "搜索对话失败：" + BaseDbHelper::getInstance()->getLastError());
+        return;
+    }
+    if (hits.isEmpty()) {
+        QListWidgetItem *empty = new QListWidgetItem("未找到相关对话");
+        empty->setFlags(Qt::NoItemFlags);
+        m_dialogList->addItem(empty);
+        return;
+    }
+
+    // 关键词高亮：先转义片段，再在转义后的文本中匹配（关键词同样转义）
+    QStringList patterns;
+    for (const QString &term : ChatDbHelper::searchTerms(keyword)) {
+        patterns << QRegularExpression::escape(term.toHtmlEscaped());
+    }
+    QRegularExpression highlight(patterns.join('|'), QRegularExpression::CaseInsensitiveOption);
+
+    for (const ChatSearchHit &hit : hits) {
+        QString snippet = hit.snippet.toHtmlEscaped();
+        snippet.replace(highlight, "<span style='color:#e74c3c; font-weight:bold;'>\\0</span>");
+        QString html = QString("<b>%1</b> <span style='color:#7f8c8d;'>（%2条）</span><br>"
+                               "<span style='color:#555;'>…%3…</span>")
+                           .arg(hit.title.toHtmlEscaped(), QString::number(hit.hits), snippet);
+
+        QListWidgetItem *it = new QListWidgetItem();
+        it->setData(Qt::UserRole, hit.dialog_id);
+        it->setData(DIALOG_TITLE_ROLE, hit.title);
+        it->setToolTip(hit.update_time.toString("yyyy-MM-dd HH:mm"));
+        m_dialogList->addItem(it);
+
+        // 富文本片段用标签显示，点击穿透给列表
+        QLabel *label = new QLabel(html);
+        label->setWordWrap(true);
+        label->setTextFormat(Qt::RichText);
+        label->setContentsMargins(4, 4, 4, 4);
+        label->setAttribute(Qt::WA_TransparentForMouseEvents);
+        int width = m_dialogList->viewport()->width();
+        it->setSizeHint(QSize(width, label->heightForWidth(width)));
+        m_dialogList->setItemWidget(it, label);
+
+        if (hit.dialog_id == m_currentDialogId) {
+            m_dialogList->setCurrentItem(it);
+        }
+    }
+    LOG_DEBUG("LLM模块", "【DB】搜索对话：" << keyword << "，命中" << hits.size() << "个对话，耗时" << timer.elapsed() << "ms");
 }
 
 // ---------- 模型列表加载 ----------
@@ -294,7 +456,7 @@ void LLMWidget::loadModelList()
         return;
     }
 
-    QSqlQuery q = db->execQuery("SELECT model_code, model_name, is_default FROM model_config ORDER BY is_default DESC");
+    DbQuery q = db->execQuery("SELECT model_code, model_name, is_default FROM model_config ORDER BY is_default DESC");
     if (q.lastError().isValid()) {
         LOG_ERROR("LLM模块", "加载模型失败：" << q.lastError().text());
         m_modelCombo->addItem("智谱GLM-4.7", "glm-4.7");
@@ -335,43 +497,10 @@ void LLMWidget::loadModelList()
     LOG_DEBUG("LLM模块", "【DB】模型列表加载完成, 选中=" << m_selectedModelCode);
 }
 
-// ---------- 对话保存（支持富文本+公式） ----------
+// ---------- 对话保存（只追加尚未入库的消息） ----------
 bool LLMWidget::saveCurrentDialog()
 {
-    if (!m_chatContentEdit) return false;
-
-    QString plainText = m_chatContentEdit->toPlainText();
-    QString richText = m_chatContentEdit->toHtml();
-    if (plainText.isEmpty()) return false;
-
-    // Generate dialog title (use user input preview)
-    QString title = "未命名对话";
-
-    // Construct message JSON (same as original logic)
-    QJsonArray messages;
-    QJsonObject systemMsg;
-    systemMsg["role"] = "system";
-    systemMsg["content"] = "你是一个有用的AI助手，专注于李雅普诺夫函数控制器算法的数据分析。";
-    messages.append(systemMsg);
-
-    QRegularExpression re(R"(【用户】([\s\S]*?)【AI】([\s\S]*?)(?=【用户】|$))");
-    QRegularExpressionMatchIterator it = re.globalMatch(plainText);
-    while (it.hasNext()) {
-        QRegularExpressionMatch m = it.next();
-        QString u = m.captured(1).trimmed();
-        QString a = m.captured(2).trimmed();
-        if (!u.isEmpty()) {
-            QJsonObject jo; jo["role"] = "user"; jo["content"] = u; messages.append(jo);
-        }
-        if (!a.isEmpty()) {
-            QJsonObject jo; jo["role"] = "assistant"; jo["content"] = a; messages.append(jo);
-        }
-    }
-
-    QJsonObject obj;
-    obj["messages"] = messages;
-    obj["rich_content"] = richText;
-    QString json = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+    if (m_savedCount >= m_messages.size()) return true;
 
     BaseDbHelper *db = BaseDbHelper::getInstance();
     if (!db || !db->checkDbConn()) {
@@ -381,34 +510,23 @@ bool LLMWidget::saveCurrentDialog()
     }
 
     if (m_currentDialogId == -1) {
-        // --- Modified: Use prepared query to get last insert ID ---
-        QString sql = QString("INSERT INTO chat_dialog (user_id, dialog_title, dialog_content, update_time) VALUES (%1, ?, ?, CURRENT_TIMESTAMP)").arg(m_currentUserId);
-        QSqlQuery query = db->execQuery(sql); // Assume BaseDbHelper has getQuery() method; adjust if needed
-        query.prepare(sql);
-        query.addBindValue(title);
-        query.addBindValue(json);
-
-        if (!query.exec()) {
-            LOG_ERROR("LLM模块", "Insert new dialog failed:" << query.lastError().text());
-            return false;
+        int dialogId = m_chatDb->createDialog(m_currentUserId, "未命名对话");
+        if (dialogId <= 0) return false;
+        m_currentDialogId = dialogId;
+        for (ChatMessage &message : m_messages) {
+            message.dialog_id = dialogId;
         }
-
-        // --- Key: Get the newly inserted dialog ID ---
-        m_currentDialogId = query.lastInsertId().toInt();
         LOG_DEBUG("LLM模块", "【DB】New dialog created, ID=" << m_currentDialogId);
-    } else {
-        // Update existing dialog (original logic)
-        QString sql = QString("UPDATE chat_dialog SET dialog_title = ?, dialog_content = ?, update_time = CURRENT_TIMESTAMP WHERE id = %1 AND user_id = %2").arg(m_currentDialogId).arg(m_currentUserId);
-        QVariantList params = { title, json };
-        if (!db->execPrepareSql(sql, params)) {
-            LOG_ERROR("LLM模块", "Update dialog failed:" << db->getLastError());
-            return false;
-        }
     }
+
+    if (!m_chatDb->appendMessages(m_currentDialogId, m_currentUserId, m_messages.mid(m_savedCount))) {
+        return false;
+    }
+    m_savedCount = m_messages.size();
     return true;
 }
 
-// ---------- 读取对话（恢复公式格式） ----------
+// ---------- 读取对话（只渲染最近的消息，更早的滚动到顶部时再渲染） ----------
 bool LLMWidget::loadDialogById(int dialogId)
 {
     if (dialogId <= 0) return false;
@@ -420,44 +538,106 @@ bool LLMWidget::loadDialogById(int dialogId)
         return false;
     }
 
-    QString sql = QString("SELECT dialog_content FROM chat_dialog WHERE id = %1 AND user_id = %2").arg(dialogId).arg(m_currentUserId);
-    QSqlQuery q = db->execQuery(sql);
-    if (q.lastError().isValid()) {
-        LOG_ERROR("LLM模块", "loadDialogById error:" << q.lastError().text());
-        return false;
+    bool ok = false;
+    QList<ChatMessage> messages = m_chatDb->loadMessages(dialogId, m_currentUserId, &ok);
+    if (!ok) return false;
+    if (messages.isEmpty()) {
+        // 旧对话：首次打开时从dialog_content迁移
+        messages = m_chatDb->importLegacyDialog(dialogId, m_currentUserId, &ok);
+        if (!ok) return false;
     }
-    if (!q.next()) return false;
 
-    QString json = q.value(0).toString();
-    QJsonDocument doc = QJsonDocument::fromJson(json.toUtf8());
-    if (doc.isNull() || !doc.isObject()) {
-        LOG_ERROR("LLM模块", "对话 JSON 解析失败");
-        return false;
+    resetMessages(); // 先置零m_renderedFrom，clear()触发的滚动信号不会补渲染
+    m_currentDialogId = dialogId;
+    m_messages = messages;
+    m_savedCount = m_messages.size();
+    if (m_chatContentEdit) {
+        m_chatContentEdit->clear();
+        renderMessages(qMax(0, m_messages.size() - CHAT_RENDER_BATCH), m_messages.size(), false);
+        // 不足一屏时没有滚动条，无法通过滚动触发，直接补齐
+        while (m_renderedFrom > 0 && m_chatContentEdit->document()->size().height() < m_chatContentEdit->viewport()->height()) {
+            renderMessages(qMax(0, m_renderedFrom - CHAT_RENDER_BATCH), m_renderedFrom, true);
+        }
+        m_chatContentEdit->moveCursor(QTextCursor::End);
     }
+    showPendingAnswer();
+    updateRequestUi();
+    LOG_DEBUG("LLM模块", "【DB】对话加载完成，ID=" << dialogId << "，消息数=" << m_messages.size());
+    return true;
+}
 
-    QJsonObject root = doc.object();
-    // 优先加载富文本（含公式）
-    if (root.contains("rich_content") && root["rich_content"].isString()) {
-        QString richText = root["rich_content"].toString();
-        if (m_chatContentEdit) {
-            m_chatContentEdit->setHtml(richText);
-        }
-    } else {
-        // 兼容旧数据
-        QJsonArray messages = root["messages"].toArray();
-        QString plain;
-        for (const QJsonValue &v : messages) {
-            QJsonObject m = v.toObject();
-            QString role = m["role"].toString();
-            QString content = m["content"].toString();
-            if (role == "user") plain += QString("【用户】%1\n").arg(content);
-            else if (role == "assistant") plain += QString("【AI】%1\n").arg(content);
+// ---------- 消息记录与渲染 ----------
+void LLMWidget::appendMessage(const QString &role, const QString &content)
+{
+    ChatMessage message;
+    message.dialog_id = m_currentDialogId;
+    message.seq = m_messages.isEmpty() ? 1 : m_messages.last().seq + 1;
+    message.role = role;
+    message.content = content;
+    message.tokens = ChatDbHelper::estimateTokens(content);
+    message.created_at = QDateTime::currentDateTime();
+    m_messages.append(message);
+}
+
+QString LLMWidget::messageToHtml(const ChatMessage &message)
+{
+    if (message.role == "user") {
+        return QString("<span style='color:#3498db; font-weight:bold;'>【用户】</span>%1<br/>").arg(message.content);
+    }
+    return QString("<span style='color:#27ae60; font-weight:bold;'>【AI】</span>%1<br/>").arg(convertMarkdownToRichText(message.content));
+}
+
+void LLMWidget::renderMessages(int from, int to, bool prepend)
+{
+    if (!m_chatContentEdit || from >= to) {
+        m_renderedFrom = from;
+        return;
+    }
+
+    if (!prepend) {
+        for (int i = from; i < to; i++) {
+            m_chatContentEdit->append(messageToHtml(m_messages.at(i)));
         }
-        if (m_chatContentEdit) m_chatContentEdit->setText(plain);
+        m_renderedFrom = from;
+        return;
     }
 
-    m_currentDialogId = dialogId;
-    return true;
+    // 插入到文档开头：记录插入前后的滚动范围和文档长度，保持阅读位置与流式锚点不变
+    QScrollBar *bar = m_chatContentEdit->verticalScrollBar();
+    int oldMaximum = bar->maximum();
+    int oldValue = bar->value();
+    QTextDocument *doc = m_chatContentEdit->document();
+    int oldLength = doc->characterCount();
+
+    QTextCursor c(doc);
+    c.movePosition(QTextCursor::Start);
+    c.beginEditBlock();
+    for (int i = from; i < to; i++) {
+        c.insertHtml(messageToHtml(m_messages.at(i)));
+        c.insertBlock();
+    }
+    c.endEditBlock();
+
+    if (m_streamAnchorPos >= 0) {
+        m_streamAnchorPos += doc->characterCount() - oldLength;
+    }
+    m_renderedFrom = from;
+    bar->setValue(oldValue + bar->maximum() - oldMaximum);
+}
+
+void LLMWidget::resetMessages()
+{
+    m_messages.clear();
+    m_savedCount = 0;
+    m_renderedFrom = 0;
+    m_streamAnchorPos = -1; // 聊天区随后清空，后台请求的回复重新显示时再开始
+}
+
+void LLMWidget::onChatScrollValueChanged(int value)
+{
+    QScrollBar *bar = m_chatContentEdit ? m_chatContentEdit->verticalScrollBar() : nullptr;
+    if (!bar || value != bar->minimum() || m_renderedFrom <= 0) return;
+    renderMessages(qMax(0, m_renderedFrom - CHAT_RENDER_BATCH), m_renderedFrom, true);
 }
 
 // ---------- 读取用户 API 配置 ----------
@@ -471,7 +651,7 @@ QJsonObject LLMWidget::getApiConfig()
     }
 
     QString sql = QString("SELECT api_url, api_key, model, temperature FROM user_api_config WHERE user_id = %1").arg(m_currentUserId);
-    QSqlQuery q = db->execQuery(sql);
+    DbQuery q = db->execQuery(sql);
     if (q.lastError().isValid()) {
         LOG_ERROR("LLM模块", "getApiConfig error:" << q.lastError().text());
         return cfg;
@@ -484,6 +664,22 @@ QJsonObject LLMWidget::getApiConfig()
     return cfg;
 }
 
+// ---------- 读取模型的上下文token预算 ----------
+int LLMWidget::loadContextBudget(const QString &modelCode)
+{
+    BaseDbHelper *db = BaseDbHelper::getInstance();
+    if (!db || !db->checkDbConn()) return m_defaultContextTokens;
+
+    DbQuery q = db->execPrepareQuery("SELECT context_tokens FROM model_config WHERE model_code = ?", {modelCode});
+    if (q.lastError().isValid()) {
+        // 旧库未执行升级脚本时没有该列
+        LOG_WARN("LLM模块", "读取上下文预算失败，使用默认值：" << q.lastError().text());
+        return m_defaultContextTokens;
+    }
+    if (!q.next() || q.value(0).toInt() <= 0) return m_defaultContextTokens;
+    return q.value(0).toInt();
+}
+
 // ---------- 保存选中模型 ----------
 bool LLMWidget::saveSelectedModel(const QString &modelCode)
 {
@@ -510,7 +706,7 @@ bool LLMWidget::saveSelectedModel(const QString &modelCode)
 }
 
 // ---------- 解析API响应内容 ----------
-QString LLMWidget::extractFullContentFromResponse(const QByteArray &data)
+QString LLMWidget::extractFullContentFromResponse(const QByteArray &data, QString *finishReason)
 {
     if (data.isEmpty()) return "";
 
@@ -529,6 +725,7 @@ QString LLMWidget::extractFullContentFromResponse(const QByteArray &data)
         QJsonArray choices = root["choices"].toArray();
         if (!choices.isEmpty()) {
             QJsonObject choice = choices[0].toObject();
+            if (finishReason) *finishReason = choice["finish_reason"].toString();
             if (choice.contains("message") && choice["message"].isObject()) {
                 QJsonObject message = choice["message"].toObject();
                 if (message.contains("content") && message["content"].isString()) {
@@ -541,287 +738,487 @@ QString LLMWidget::extractFullContentFromResponse(const QByteArray &data)
     return fullContent;
 }
 
-// ---------- LaTeX公式处理（转换为MathJax兼容格式） ----------
-QString LLMWidget::processLatexFormulas(const QString &text)
+// ---------- 解析流式chunk的增量内容 ----------
+QString LLMWidget::extractDeltaFromChunk(const QString &data, QString *finishReason)
 {
-    if (text.isEmpty()) return "";
-    QString result = text;
-
-    // 1. 处理行内公式：$公式$ → \(公式\)（MathJax行内格式）
-    result.replace(QRegularExpression("\\$(.*?)\\$"), "\\\\(\\1\\\\)");
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(data.toUtf8(), &err);
+    if (doc.isNull() || !doc.isObject()) {
+        LOG_WARN("LLM模块", "流式chunk解析失败：" << err.errorString());
+        return "";
+    }
 
-    // 2. 处理块级公式：$$公式$$ → \[公式\]（MathJax块级格式）
-    result.replace(QRegularExpression("\\$\\$(.*?)\\$\\$", QRegularExpression::DotMatchesEverythingOption), "\\\\[\\1\\\\]");
+    QJsonObject root = doc.object();
+    if (root.contains("error")) {
+        LOG_ERROR("LLM模块", "流式响应返回错误：" << QJsonDocument(root["error"].toObject()).toJson(QJsonDocument::Compact));
+        return "";
+    }
 
-    return result;
+    // OpenAI兼容格式：choices[0].delta.content
+    QJsonArray choices = root["choices"].toArray();
+    if (choices.isEmpty()) return "";
+    QJsonObject choice = choices[0].toObject();
+    // 只有最后一个chunk带finish_reason，其余为null
+    if (finishReason && choice["finish_reason"].isString()) {
+        *finishReason = choice["finish_reason"].toString();
+    }
+    return choice["delta"].toObject()["content"].toString();
 }
 
-// ---------- 核心：Markdown+LaTeX转富文本（修复正则转义） ----------
+// ---------- 核心：Markdown+LaTeX转富文本（单遍渲染） ----------
 QString LLMWidget::convertMarkdownToRichText(const QString &markdown)
 {
-    if (markdown.isEmpty()) return "";
-
-    QString html = markdown;
-
-    // 第一步：先处理LaTeX公式（避免与Markdown语法冲突）
-    html = processLatexFormulas(html);
-
-    // 1. 处理标题：# 一级 → <h1>
-    html.replace(QRegularExpression("^#{1}\\s+(.*)$", QRegularExpression::MultilineOption),
-                 "<h1 style='color:#2c3e50; margin:8px 0; font-size:18px; font-weight:bold;'>\\1</h1>");
-    html.replace(QRegularExpression("^#{2}\\s+(.*)$", QRegularExpression::MultilineOption),
-                 "<h2 style='color:#34495e; margin:6px 0; font-size:16px; font-weight:bold;'>\\1</h2>");
-    html.replace(QRegularExpression("^#{3}\\s+(.*)$", QRegularExpression::MultilineOption),
-                 "<h3 style='color:#415a77; margin:5px 0; font-size:14px; font-weight:bold;'>\\1</h3>");
-    html.replace(QRegularExpression("^#{4,6}\\s+(.*)$", QRegularExpression::MultilineOption),
-                 "<h4 style='color:#596e8b; margin:4px 0; font-size:13px; font-weight:bold;'>\\1</h4>");
-
-    // 2. 处理加粗：**内容** → <b>
-    html.replace(QRegularExpression("\\*\\*(.*?)\\*\\*"), "<b>\\1</b>");
-
-    // 3. 处理斜体：*内容* → <i>
-    html.replace(QRegularExpression("^(?!\\*)\\*(.*?)\\*(?!\\*)"), "<i>\\1</i>");
-
-    // 4. 处理代码块：```代码``` → <pre><code>
-    html.replace(QRegularExpression("```([\\s\\S]*?)```"),
-                 "<pre style='background-color:#f5f5f5; padding:8px; border-radius:4px; margin:8px 0; font-family:Consolas,Monospace; font-size:12px;'>\\1</pre>");
-
-    // 5. 处理行内代码：`代码` → <code>
-    html.replace(QRegularExpression("`(.*?)`"),
-                 "<code style='background-color:#f0f0f0; padding:2px 4px; border-radius:2px; font-family:Consolas; font-size:12px;'>\\1</code>");
-
-    // 6. 处理无序列表：-/* 开头 → <ul><li>
-    html.replace(QRegularExpression("^(\\s*)-\\s+(.*)$", QRegularExpression::MultilineOption),
-                 "\\1<li style='margin:2px 0; list-style:disc;'>\\2</li>");
-    html.replace(QRegularExpression("^(\\s*)\\*\\s+(.*)$", QRegularExpression::MultilineOption),
-                 "\\1<li style='margin:2px 0; list-style:disc;'>\\2</li>");
-    // 包裹列表项
-    html.replace(QRegularExpression("(<li>.*?</li>)+", QRegularExpression::DotMatchesEverythingOption),
-                 "<ul style='margin:6px 0; padding-left:25px;'>\\1</ul>");
-
-    // 7. 处理分割线：--- → <hr>
-    html.replace(QRegularExpression("^---$", QRegularExpression::MultilineOption),
-                 "<hr style='border:0; border-top:1px solid #eee; margin:10px 0;'>");
-
-    // 8. 处理引用：> 内容 → <blockquote>
-    html.replace(QRegularExpression("^>\\s+(.*)$", QRegularExpression::MultilineOption),
-                 "<blockquote style='margin:6px 0; padding:6px 10px; background-color:#f8f9fa; border-left:3px solid #6c757d;'>\\1</blockquote>");
-
-    // 9. 处理换行：保留换行符
-    html.replace("\n", "<br/>");
-
-    // 10. 处理链接：[文本](链接) → <a>
-    html.replace(QRegularExpression("\\[([^\\]]+)\\]\\(([^)]+)\\)"),
-                 "<a href='\\2' style='color:#3498db; text-decoration:none;'>\\1</a>");
-
-    return html;
+    return MarkdownRenderer::render(markdown);
 }
 
-// ---------- API响应处理（核心：公式+格式渲染） ----------
-void LLMWidget::onApiReplyFinished()
+// ---------- 移除"正在处理中"占位符 ----------
+void LLMWidget::removeLoadingPlaceholder()
+{
+    if (!m_chatContentEdit) return;
+    QTextDocument *doc = m_chatContentEdit->document();
+    if (!doc) return;
+
+    QVector<int> toRem;
+    for (QTextBlock b = doc->begin(); b.isValid(); b = b.next()) {
+        if (b.text().contains("【AI】正在处理中...")) {
+            toRem.append(b.blockNumber());
+        }
+    }
+    for (int i = toRem.size()-1; i>=0; --i) {
+        QTextBlock b = doc->findBlockByNumber(toRem[i]);
+        if (b.isValid()) {
+            QTextCursor c(b);
+            c.select(QTextCursor::BlockUnderCursor);
+            c.removeSelectedText();
+        }
+    }
+}
+
+// ---------- 流式渲染 ----------
+void LLMWidget::beginStreamingAnswer()
+{
+    if (!m_chatContentEdit) return;
+    removeLoadingPlaceholder();
+    m_chatContentEdit->append("<span style='color:#27ae60; font-weight:bold;'>【AI】</span>");
+
+    QTextCursor c(m_chatContentEdit->document());
+    c.movePosition(QTextCursor::End);
+    m_streamAnchorPos = c.position();
+    m_streamRenderer.reset();
+}
+
+void LLMWidget::appendStreamingDelta(const QString &delta)
+{
+    if (delta.isEmpty() || !m_chatContentEdit) return;
+
+    if (m_streamAnchorPos < 0) {
+        beginStreamingAnswer();
+    }
+    QString completedHtml = m_streamRenderer.append(delta);
+
+    // 已完整的块（整行/闭合的代码块/列表）立即渲染为富文本，其余部分暂按纯文本显示
+    // 用户未向上翻看时保持滚动到底部
+    QScrollBar *bar = m_chatContentEdit->verticalScrollBar();
+    bool atBottom = !bar || bar->value() >= bar->maximum() - 4;
+    QTextCursor c(m_chatContentEdit->document());
+    if (completedHtml.isEmpty()) {
+        c.movePosition(QTextCursor::End);
+        c.insertText(delta, QTextCharFormat());
+    } else {
+        c.setPosition(m_streamAnchorPos);
+        c.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+        c.removeSelectedText();
+        c.insertHtml(completedHtml);
+        c.movePosition(QTextCursor::End);
+        m_streamAnchorPos = c.position();
+        c.insertText(m_streamRenderer.pendingSource(), QTextCharFormat());
+    }
+    if (atBottom && bar) {
+        bar->setValue(bar->maximum());
+    }
+}
+
+void LLMWidget::finishStreamingAnswer(const QString &errorText)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) {
-        reply = m_currentReply;
-    }
-    if (!reply) return;
-
-    // 打印响应日志
-    QByteArray responseData = reply->readAll();
-    LOG_DEBUG("LLM模块", "【API响应】状态码：" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt());
-    LOG_DEBUG("LLM模块", "【API响应】原始数据：" << QString::fromUtf8(responseData));
-    reply->seek(0);
-
-    // 恢复UI状态
-    auto restoreUI = [this]() {
-        m_isRequestProcessing = false;
-        if (m_sendBtn) m_sendBtn->setEnabled(true);
-        if (m_fileBtn) m_fileBtn->setEnabled(true);
-        if (m_inputEdit) m_inputEdit->setEnabled(true);
-        if (m_cancelBtn) m_cancelBtn->setEnabled(false);
-    };
-
-    // 处理错误
-    if (reply->error() != QNetworkReply::NoError) {
-        if (reply->error() == QNetworkReply::OperationCanceledError) {
-            LOG_DEBUG("LLM模块", "用户已取消请求");
+    if (!m_chatContentEdit) return;
+
+    if (m_streamAnchorPos < 0) {
+        // 一个增量都没收到
+        removeLoadingPlaceholder();
+        if (!errorText.isEmpty()) {
+            m_chatContentEdit->append(QString("<span style='color:#e74c3c;'>%1</span><br/>").arg(errorText));
         } else {
-            QString err = QString("<span style='color:#e74c3c;'>【系统】API请求失败：%1</span><br/>").arg(reply->errorString());
-            if (m_chatContentEdit) {
-                QMetaObject::invokeMethod(this, [this, err]() {
-                    m_chatContentEdit->append(err);
-                }, Qt::QueuedConnection);
-            }
-            LOG_ERROR("LLM模块", "API 请求错误：" << reply->errorString());
+            m_chatContentEdit->append("<span style='color:#e74c3c;'>【系统】未获取到AI回复内容（解析为空）</span><br/>");
         }
-        restoreUI();
-        reply->deleteLater();
-        if (reply == m_currentReply) m_currentReply = nullptr;
         return;
     }
 
-    // 解析AI内容
-    QString aiContent = extractFullContentFromResponse(responseData);
-    LOG_DEBUG("LLM模块", "【API响应】解析后的AI内容：" << aiContent);
+    // 渲染剩余未完整的部分，替换流式阶段的纯文本尾部
+    QTextCursor c(m_chatContentEdit->document());
+    c.setPosition(m_streamAnchorPos);
+    c.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+    c.removeSelectedText();
+    c.insertHtml(m_streamRenderer.finish() + "<br/>");
+    m_streamAnchorPos = -1;
 
-    // UI线程更新（核心：公式渲染）
-    QMetaObject::invokeMethod(this, [this, aiContent]() {
-        if (!m_chatContentEdit) return;
+    if (!errorText.isEmpty()) {
+        m_chatContentEdit->append(QString("<span style='color:#e74c3c;'>%1</span><br/>").arg(errorText));
+    }
+    m_chatContentEdit->moveCursor(QTextCursor::End);
+}
 
-        QTextDocument *doc = m_chatContentEdit->document();
-        if (!doc || doc->isEmpty()) {
-            if (!aiContent.isEmpty()) {
+void LLMWidget::showPendingAnswer()
+{
+    int requestId = chatRequestOfDialog(m_currentDialogId);
+    bool mapPending = m_mapRunning && m_mapDialogId == m_currentDialogId;
+    if (!m_chatContentEdit || (requestId == 0 && !mapPending)) return;
+
+    if (requestId == 0 || m_chatRequests[requestId].content.isEmpty()) {
+        m_chatContentEdit->append("<span style='color:#95a5a6;'>【AI】正在处理中...</span><br/>");
+    } else {
+        beginStreamingAnswer();
+        appendStreamingDelta(m_chatRequests[requestId].content);
+    }
+    m_chatContentEdit->moveCursor(QTextCursor::End);
+}
+
+// ---------- 请求调度：按请求ID分发 ----------
+void LLMWidget::onRequestStarted(int requestId, QNetworkReply *reply)
+{
+    auto it = m_chatRequests.find(requestId);
+    if (it == m_chatRequests.end()) return;
+
+    LOG_DEBUG("LLM模块", "【调度】请求已发出：ID=" << requestId << "，对话ID=" << it->dialogId
+              << "，排队耗时：" << it->timer.elapsed() << "ms");
+    if (m_streamMode) {
+        connect(reply, &QNetworkReply::readyRead, this, [this, requestId, reply]() {
+            onChatReplyReadyRead(requestId, reply);
+        });
+    }
+}
+
+void LLMWidget::onRequestFinished(int requestId, QNetworkReply *reply)
+{
+    if (m_chatRequests.contains(requestId)) {
+        onChatRequestFinished(requestId, reply);
+    } else if (m_mapRequests.contains(requestId)) {
+        onMapRequestFinished(requestId, reply);
+    }
+}
+
+int LLMWidget::chatRequestOfDialog(int dialogId) const
+{
+    for (auto it = m_chatRequests.constBegin(); it != m_chatRequests.constEnd(); ++it) {
+        if (it->dialogId == dialogId) return it.key();
+    }
+    return 0;
+}
+
+bool LLMWidget::isDialogBusy(int dialogId) const
+{
+    return chatRequestOfDialog(dialogId) != 0 || (m_mapRunning && m_mapDialogId == dialogId);
+}
+
+// ---------- 流式响应：增量解析 ----------
+void LLMWidget::onChatReplyReadyRead(int requestId, QNetworkReply *reply)
+{
+    auto it = m_chatRequests.find(requestId);
+    if (it == m_chatRequests.end()) return;
+    ChatRequest &request = it.value();
+
+    // 服务端不支持流式时会返回普通JSON：留给finished按非流式处理
+    if (!request.eventStream) {
+        QString contentType = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+        if (!contentType.contains("text/event-stream", Qt::CaseInsensitive)) return;
+        request.eventStream = true;
+    }
+
+    QString delta;
+    const QStringList events = request.sseParser.feed(reply->readAll());
+    for (const QString &event : events) {
+        delta += extractDeltaFromChunk(event, &request.finishReason);
+    }
+    if (delta.isEmpty()) return;
+
+    if (request.firstTokenMs < 0) {
+        request.firstTokenMs = request.timer.elapsed();
+        LOG_INFO("LLM模块", "【API响应】首字耗时：" << request.firstTokenMs << "ms，对话ID=" << request.dialogId);
+    }
+    request.content += delta;
+    // 只有当前显示的对话实时渲染，其他对话的回复在后台累积
+    if (request.dialogId == m_currentDialogId) {
+        appendStreamingDelta(delta);
+    }
+}
+
+// ---------- API响应处理（核心：公式+格式渲染） ----------
+void LLMWidget::onChatRequestFinished(int requestId, QNetworkReply *reply)
+{
+    ChatRequest request = m_chatRequests.take(requestId);
+    bool visible = (request.dialogId == m_currentDialogId);
+
+    QString errorText;
+    if (!reply || reply->error() == QNetworkReply::OperationCanceledError) {
+        LOG_DEBUG("LLM模块", "用户已取消请求，对话ID=" << request.dialogId);
+        errorText = "【系统】请求已取消";
+    } else if (reply->error() != QNetworkReply::NoError) {
+        errorText = QString("【系统】API请求失败：%1").arg(reply->errorString());
+        LOG_ERROR("LLM模块", "API 请求错误：" << reply->errorString());
+    }
+
+    QString answer;
+    if (request.eventStream && reply) {
+        // 流式响应：解析剩余数据，再把已追加的内容整体渲染（取消/出错时保留已收到的部分）
+        QStringList events = request.sseParser.feed(reply->readAll());
+        events << request.sseParser.flush();
+        QString delta;
+        for (const QString &event : events) {
+            delta += extractDeltaFromChunk(event, &request.finishReason);
+        }
+        request.content += delta;
+        if (visible) {
+            appendStreamingDelta(delta);
+            finishStreamingAnswer(errorText);
+        }
+        LOG_INFO("LLM模块", "【API响应】流式完成，首字耗时：" << request.firstTokenMs << "ms，总耗时："
+                 << request.timer.elapsed() << "ms，长度：" << request.content.size());
+        answer = request.content;
+    } else {
+        if (errorText.isEmpty()) {
+            QByteArray responseData = reply->readAll();
+            LOG_DEBUG("LLM模块", "【API响应】状态码：" << reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt());
+            LOG_DEBUG("LLM模块", "【API响应】原始数据：" << QString::fromUtf8(responseData));
+            answer = extractFullContentFromResponse(responseData, &request.finishReason);
+            LOG_INFO("LLM模块", "【API响应】非流式完成，总耗时：" << request.timer.elapsed() << "ms");
+        }
+        if (visible && m_chatContentEdit) {
+            removeLoadingPlaceholder();
+            if (!answer.isEmpty()) {
                 // 转换Markdown+LaTeX为富文本
-                QString richAiContent = convertMarkdownToRichText(aiContent);
+                QString richAiContent = convertMarkdownToRichText(answer);
                 m_chatContentEdit->append(QString("<span style='color:#27ae60; font-weight:bold;'>【AI】</span>%1<br/>").arg(richAiContent));
+            } else if (!errorText.isEmpty()) {
+                m_chatContentEdit->append(QString("<span style='color:#e74c3c;'>%1</span><br/>").arg(errorText));
             } else {
                 m_chatContentEdit->append("<span style='color:#e74c3c;'>【系统】未获取到AI回复内容（解析为空）</span><br/>");
             }
-            saveCurrentDialog();
-            loadHistoryDialogs();
-            return;
-        }
-
-        // 移除加载占位符
-        QVector<int> toRem;
-        for (QTextBlock b = doc->begin(); b.isValid(); b = b.next()) {
-            if (b.text().contains("【AI】正在处理中...")) {
-                toRem.append(b.blockNumber());
-            }
-        }
-        for (int i = toRem.size()-1; i>=0; --i) {
-            QTextBlock b = doc->findBlockByNumber(toRem[i]);
-            if (b.isValid()) {
-                QTextCursor c(b);
-                c.select(QTextCursor::BlockUnderCursor);
-                c.removeSelectedText();
-            }
+            m_chatContentEdit->moveCursor(QTextCursor::End);
         }
+    }
 
-        // 追加AI回复（含公式）
-        if (!aiContent.isEmpty()) {
-            QString richAiContent = convertMarkdownToRichText(aiContent);
-            m_chatContentEdit->append(QString("<span style='color:#27ae60; font-weight:bold;'>【AI】</span>%1<br/>").arg(richAiContent));
-        } else {
-            m_chatContentEdit->append("<span style='color:#e74c3c;'>【系统】未获取到AI回复内容（解析为空）</span><br/>");
-        }
+    // 只缓存完整的回复：流式须收到[DONE]且未因长度截断，非流式须finish_reason为stop
+    bool complete = request.eventStream
+            ? request.sseParser.isDone() && (request.finishReason.isEmpty() || request.finishReason == "stop")
+            : request.finishReason == "stop";
+    if (errorText.isEmpty() && m_responseCache && complete && !answer.isEmpty()) {
+        m_responseCache->insert(request.cacheKey, answer);
+    } else if (errorText.isEmpty() && m_responseCache && !request.cacheKey.isEmpty()) {
+        LOG_INFO("LLM模块", "【缓存】回复不完整，不缓存：finish_reason=" << request.finishReason
+                 << "，收到[DONE]=" << request.sseParser.isDone());
+    }
+    if (!answer.isEmpty()) {
+        storeMessage(request.dialogId, request.replySeq, "assistant", answer);
+        loadHistoryDialogs();
+    } else if (!visible) {
+        LOG_WARN("LLM模块", "【API响应】后台对话未获取到回复，对话ID=" << request.dialogId << "，" << errorText);
+    }
+    updateRequestUi();
+}
 
+// ---------- 消息写入对话 ----------
+void LLMWidget::storeMessage(int dialogId, int seq, const QString &role, const QString &content)
+{
+    if (dialogId == m_currentDialogId) {
+        appendMessage(role, content);
         saveCurrentDialog();
-        loadHistoryDialogs();
-    }, Qt::QueuedConnection);
+        return;
+    }
+    if (dialogId <= 0) {
+        LOG_WARN("LLM模块", "【DB】对话未建档，丢弃后台回复");
+        return;
+    }
 
-    // 清理资源
-    restoreUI();
-    reply->deleteLater();
-    if (reply == m_currentReply) m_currentReply = nullptr;
+    ChatMessage message;
+    message.dialog_id = dialogId;
+    message.seq = seq;
+    message.role = role;
+    message.content = content;
+    message.tokens = ChatDbHelper::estimateTokens(content);
+    message.created_at = QDateTime::currentDateTime();
+    if (!m_chatDb->appendMessages(dialogId, m_currentUserId, { message })) {
+        LOG_ERROR("LLM模块", "【DB】保存后台对话消息失败，对话ID=" << dialogId);
+    }
 }
 
-// ---------- 发送API请求 ----------
-void LLMWidget::sendApiRequest(const QString &content)
+// ---------- 发送API请求（当前对话） ----------
+void LLMWidget::sendApiRequest(const QString &question, const QString &attachment)
 {
-    if (content.trimmed().isEmpty()) {
+    if (question.trimmed().isEmpty()) {
         QMessageBox::warning(this, "警告", "输入内容不能为空！");
         return;
     }
 
-    if (m_isRequestProcessing || m_currentReply != nullptr) {
-        QMessageBox::information(this, "提示", "当前有请求正在处理中，请等待完成或取消后再发送。");
+    if (isDialogBusy(m_currentDialogId)) {
+        QMessageBox::information(this, "提示", "当前对话有请求正在处理中，请等待完成或取消后再发送。");
         return;
     }
+    submitChatRequest(m_currentDialogId, m_messages, question, attachment);
+}
 
+bool LLMWidget::submitChatRequest(int dialogId, const QList<ChatMessage> &history, const QString &question, const QString &attachment)
+{
     QJsonObject cfg = getApiConfig();
     if (cfg.isEmpty() || cfg["api_url"].toString().isEmpty() || cfg["api_key"].toString().isEmpty()) {
         QMessageBox::warning(this, "警告", "请先配置 API 地址和密钥！");
-        return;
+        return false;
     }
 
-    // Lock UI (original logic)
-    m_isRequestProcessing = true;
-    if (m_sendBtn) m_sendBtn->setEnabled(false);
-    if (m_fileBtn) m_fileBtn->setEnabled(false);
-    if (m_inputEdit) m_inputEdit->setEnabled(false);
-    if (m_cancelBtn) m_cancelBtn->setEnabled(true);
-
     // Construct request JSON (original logic, no changes)
     QJsonObject reqObj;
     reqObj["model"] = cfg["model"].toString();
     reqObj["temperature"] = cfg["temperature"].toDouble();
-    reqObj["stream"] = false;
-
-    QJsonArray messages;
-    QJsonObject systemMsg;
-    systemMsg["role"] = "system";
-    systemMsg["content"] = "你是一个有用的AI助手，专注于李雅普诺夫函数控制器算法的数据分析。";
-    messages.append(systemMsg);
-
-    if (m_currentDialogId != -1 && m_chatContentEdit && !m_chatContentEdit->toPlainText().isEmpty()) {
-        QRegularExpression re(R"(【用户】([\s\S]*?)【AI】([\s\S]*?)(?=【用户】|$))");
-        QRegularExpressionMatchIterator it = re.globalMatch(m_chatContentEdit->toPlainText());
-        while (it.hasNext()) {
-            QRegularExpressionMatch match = it.next();
-            QString uc = match.captured(1).trimmed();
-            QString ac = match.captured(2).trimmed();
-            if (!uc.isEmpty()) { QJsonObject u; u["role"]="user"; u["content"]=uc; messages.append(u); }
-            if (!ac.isEmpty()) { QJsonObject a; a["role"]="assistant"; a["content"]=ac; messages.append(a); }
+    reqObj["stream"] = m_streamMode;
+
+    // 按模型的token预算组装上下文：附件超出时截断，较早的历史压缩为摘要
+    const QString systemPrompt = QString::fromUtf8(LLM_SYSTEM_PROMPT);
+    LlmContextBuilder contextBuilder(loadContextBudget(cfg["model"].toString()), m_replyReserveTokens);
+    QString content = question;
+    QString requestContent = question;
+    if (!attachment.isEmpty()) {
+        content = "需求：" + question + ". 上传的内容为：" + attachment;
+        QString fitted = LlmContextBuilder::truncateToTokens(attachment, contextBuilder.attachmentRoom(systemPrompt, question));
+        if (fitted != attachment) {
+            LOG_WARN("LLM模块", "【上下文】附件超出预算已截断：" << attachment.size() << " -> " << fitted.size() << "字符");
+        }
+        requestContent = "需求：" + question + ". 上传的内容为：" + fitted;
+    }
+    LlmContextBuilder::Result context = contextBuilder.build(systemPrompt, history, requestContent);
+    reqObj["messages"] = context.messages;
+    LOG_INFO("LLM模块", "【上下文】估算token=" << context.tokens << "，历史消息=" << context.keptMessages
+             << "，压缩为摘要=" << context.summarizedMessages);
+
+    bool visible = (dialogId == m_currentDialogId);
+    int userSeq = history.isEmpty() ? 1 : history.last().seq + 1;
+
+    // 相同模型+参数+上下文的请求直接返回缓存的回复（temperature>0时回复本身带随机性，默认不缓存）
+    double temperature = cfg["temperature"].toDouble();
+    QString cacheKey;
+    if (m_responseCache && (temperature <= 0 || m_cacheNonZeroTemperature)) {
+        cacheKey = LlmResponseCache::makeKey(cfg["api_url"].toString(), reqObj["model"].toString(), temperature, context.messages);
+        QString cachedAnswer;
+        if (m_responseCache->lookup(cacheKey, &cachedAnswer)) {
+            LOG_INFO("LLM模块", "【缓存】命中，key=" << cacheKey.left(12));
+            if (visible) {
+                answerFromCache(content, cachedAnswer);
+            } else {
+                storeMessage(dialogId, userSeq, "user", content);
+                storeMessage(dialogId, userSeq + 1, "assistant", cachedAnswer);
+                loadHistoryDialogs();
+            }
+            return true;
         }
     }
 
-    QJsonObject newUser; newUser["role"]="user"; newUser["content"]=content;
-    messages.append(newUser);
-    reqObj["messages"] = messages;
+    // 先记录用户消息（新对话立即建档），请求进行中切换对话后回复仍能写入所属对话
+    if (visible) {
+        if (m_chatContentEdit) {
+            m_chatContentEdit->append(QString("<span style='color:#3498db; font-weight:bold;'>【用户】</span>%1<br/>").arg(content));
+            m_chatContentEdit->append("<span style='color:#95a5a6;'>【AI】正在处理中...</span><br/>");
+            m_chatContentEdit->moveCursor(QTextCursor::End);
+        }
+        bool isNewDialog = (m_currentDialogId == -1);
+        appendMessage("user", content);
+        userSeq = m_messages.last().seq;
+        if (saveCurrentDialog() && isNewDialog) {
+            loadHistoryDialogs(); // Refresh history list to show new dialog
+            LOG_DEBUG("LLM模块", "【UI】New dialog record created immediately after sending request");
+        }
+        dialogId = m_currentDialogId;
+    } else {
+        storeMessage(dialogId, userSeq, "user", content);
+    }
 
     // Construct network request (original logic, no changes)
     QNetworkRequest req(QUrl(cfg["api_url"].toString()));
     req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     req.setRawHeader("Authorization", QString("Bearer %1").arg(cfg["api_key"].toString()).toUtf8());
+    if (m_streamMode) {
+        req.setRawHeader("Accept", "text/event-stream");
+    }
 
+    ChatRequest request;
+    request.dialogId = dialogId;
+    request.replySeq = userSeq + 1;
+    request.cacheKey = cacheKey;
+    request.timer.start();
     QByteArray postData = QJsonDocument(reqObj).toJson(QJsonDocument::Compact);
-    m_currentReply = m_netManager->post(req, postData);
-    connect(m_currentReply, &QNetworkReply::finished, this, &LLMWidget::onApiReplyFinished, Qt::QueuedConnection);
+    int requestId = m_scheduler->submit(reqObj["model"].toString(), req, postData, LlmRequestScheduler::High);
+    m_chatRequests.insert(requestId, request);
+    LOG_DEBUG("LLM模块", "【调度】对话请求已提交：ID=" << requestId << "，对话ID=" << dialogId
+              << "，进行中=" << m_scheduler->runningCount() << "，排队=" << m_scheduler->pendingCount());
+    updateRequestUi();
 
-    // --- Step 1: Append user message to chat area ---
+    ADD_BASE_LOG("LLM模块",
+                 QString("请求内容：[%1]").arg(content),
+                 m_currentUserId,
+                 "llm",
+                 IPHelper::getLocalIP());
+    return true;
+}
+
+// ---------- 命中缓存：不发请求，直接显示并保存 ----------
+void LLMWidget::answerFromCache(const QString &content, const QString &answer)
+{
     if (m_chatContentEdit) {
         m_chatContentEdit->append(QString("<span style='color:#3498db; font-weight:bold;'>【用户】</span>%1<br/>").arg(content));
-        m_chatContentEdit->append("<span style='color:#95a5a6;'>【AI】正在处理中...</span><br/>");
+        m_chatContentEdit->append(QString("<span style='color:#27ae60; font-weight:bold;'>【AI】</span>%1<br/>").arg(convertMarkdownToRichText(answer)));
         m_chatContentEdit->moveCursor(QTextCursor::End);
     }
-
-    // --- Step 2: Key Modification - Create dialog record immediately for new dialogs ---
-    bool isNewDialog = (m_currentDialogId == -1);
-    if (isNewDialog && m_chatContentEdit) {
-        if (saveCurrentDialog()) {
-            loadHistoryDialogs(); // Refresh history list to show new dialog
-            LOG_DEBUG("LLM模块", "【UI】New dialog record created immediately after sending request");
-        }
+    appendMessage("user", content);
+    appendMessage("assistant", answer);
+    if (saveCurrentDialog()) {
+        loadHistoryDialogs();
     }
 
     ADD_BASE_LOG("LLM模块",
-                 QString("请求内容：[%1]").arg(content),
+                 QString("请求内容（命中缓存）：[%1]").arg(content),
                  m_currentUserId,
                  "llm",
                  IPHelper::getLocalIP());
 }
 
-// ---------- 取消请求槽函数 ----------
+// ---------- 取消请求槽函数（只取消当前对话的请求） ----------
 void LLMWidget::onCancelBtnClicked()
 {
-    if (!m_currentReply) {
-        QMessageBox::information(this, "提示", "当前没有进行中的请求可取消。");
+    int requestId = chatRequestOfDialog(m_currentDialogId);
+    bool mapPending = m_mapRunning && m_mapDialogId == m_currentDialogId;
+    if (requestId == 0 && !mapPending) {
+        QMessageBox::information(this, "提示", "当前对话没有进行中的请求可取消。");
         return;
     }
 
-    QMessageBox::StandardButton rb = QMessageBox::question(this, "取消请求", "确认取消当前 AI 请求？", QMessageBox::Yes | QMessageBox::No);
+    QMessageBox::StandardButton rb = QMessageBox::question(this, "取消请求", "确认取消当前对话的 AI 请求？", QMessageBox::Yes | QMessageBox::No);
     if (rb != QMessageBox::Yes) return;
 
     if (m_cancelBtn) m_cancelBtn->setEnabled(false);
-    m_currentReply->abort();
+    if (requestId != 0) {
+        m_scheduler->cancel(requestId);
+    }
+    // 分段分析中：排队的分段直接移除，已发出的全部中止
+    if (mapPending) {
+        m_mapCancelled = true;
+        const QList<int> mapRequests = m_mapRequests.keys();
+        for (int mapRequestId : mapRequests) {
+            m_scheduler->cancel(mapRequestId);
+        }
+    }
 }
 
 // ---------- 发送按钮槽函数（清空文件显示） ----------
 void LLMWidget::onSendBtnClicked()
 {
-    if (m_isRequestProcessing || m_currentReply != nullptr) {
-        QMessageBox::information(this, "提示", "当前有请求正在处理中，请等待或取消后再发送。");
+    if (isDialogBusy(m_currentDialogId)) {
+        QMessageBox::information(this, "提示", "当前对话有请求正在处理中，请等待或取消后再发送。");
         return;
     }
     QString content = m_inputEdit ? m_inputEdit->toPlainText().trimmed() : QString();
@@ -829,36 +1226,37 @@ void LLMWidget::onSendBtnClicked()
         QMessageBox::warning(this, "警告", "输入内容不能为空！");
         return;
     }
-    if(!m_fileContent.isEmpty()) content = "需求：" + content + ". 上传的内容为：" + m_fileContent;
-    sendApiRequest(content);
-    m_fileContent.clear();
+    if (m_fileLoader) {
+        QMessageBox::information(this, "提示", "文件正在读取中，请稍候再发送。");
+        return;
+    }
+    // 文件超过单次请求的预算时先分段分析，否则随提问一起发送
+    if (m_fileChunks.size() > 1) {
+        if (m_mapRunning) {
+            QMessageBox::information(this, "提示", "其他对话的文件正在分段分析，请等待完成或取消后再发送。");
+            return;
+        }
+        startChunkedAnalysis(content);
+    } else {
+        sendApiRequest(content, m_fileChunks.value(0));
+    }
     m_inputEdit->clear(); // 发送后清空输入框
 
     // 新增：清空并隐藏文件显示标签
-    if (m_uploadedFileLabel) {
-        m_uploadedFileLabel->clear();
-        m_uploadedFileLabel->setVisible(false);
-    }
+    clearUploadedFile();
 }
 
 // ---------- 文件上传槽函数（添加UI显示逻辑） ----------
 void LLMWidget::onFileBtnClicked()
 {
-    if (m_isRequestProcessing || m_currentReply != nullptr) {
-        QMessageBox::information(this, "提示", "当前有请求正在处理中，请等待或取消后再上传文件。");
+    if (m_fileLoader) {
+        QMessageBox::information(this, "提示", "上一个文件正在读取中，请稍候。");
         return;
     }
 
     QString filePath = QFileDialog::getOpenFileName(this, "选择文件", "", "文本文件 (*.txt);;所有文件 (*.*)");
     if (filePath.isEmpty()) return;
-
-    QFile f(filePath);
-    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "错误", "文件打开失败！");
-        return;
-    }
-    m_fileContent = QString::fromUtf8(f.readAll());
-    f.close();
+    clearUploadedFile();
 
     // 新增：获取文件信息并更新UI显示
     QFileInfo fileInfo(filePath);
@@ -872,15 +1270,225 @@ void LLMWidget::onFileBtnClicked()
     } else {
         fileSizeStr = QString("%1 MB").arg(QString::number(fileSize / (1024.0 * 1024), 'f', 2));
     }
+    m_fileName = QString("%1 (%2)").arg(fileInfo.fileName()).arg(fileSizeStr);
+
+    // 每段的大小按当前模型的上下文预算确定，读取和切分在后台线程完成
+    LlmContextBuilder contextBuilder(loadContextBudget(getApiConfig()["model"].toString()), m_replyReserveTokens);
+    int chunkTokens = contextBuilder.attachmentRoom(QString::fromUtf8(LLM_SYSTEM_PROMPT), QString()) - FILE_QUESTION_RESERVE;
+    m_fileLoader = new LlmFileLoader(filePath, chunkTokens, m_maxFileChunks, this);
+    LlmFileLoader *loader = m_fileLoader;
+    connect(m_fileLoader, &LlmFileLoader::progressChanged, this, [this, loader](int percent) {
+        if (m_uploadedFileLabel && loader == m_fileLoader) {
+            m_uploadedFileLabel->setText(QString("读取中：%1 %2%").arg(m_fileName).arg(percent));
+        }
+    });
+    connect(m_fileLoader, &LlmFileLoader::loadFinished, this, &LLMWidget::onFileLoadFinished);
+    connect(m_fileLoader, &QThread::finished, m_fileLoader, &QObject::deleteLater);
+
+    if (m_uploadedFileLabel) {
+        m_uploadedFileLabel->setText(QString("读取中：%1").arg(m_fileName));
+        m_uploadedFileLabel->setVisible(true);
+    }
+    m_fileLoader->start();
+}
+
+// ---------- 上传文件读取完成 ----------
+void LLMWidget::onFileLoadFinished(const QStringList &chunks, bool partial, const QString &errorText)
+{
+    // 读取期间已清空/重新选择文件时丢弃结果
+    if (sender() != m_fileLoader) return;
+    m_fileLoader = nullptr;
+
+    if (!errorText.isEmpty() || chunks.isEmpty()) {
+        clearUploadedFile();
+        QMessageBox::critical(this, "错误", errorText.isEmpty() ? "文件内容为空！" : errorText);
+        return;
+    }
 
-    // 设置文件显示标签内容
+    m_fileChunks = chunks;
+    m_filePartial = partial;
+    QString note;
+    if (chunks.size() > 1) note += QString("，将分%1段分析").arg(chunks.size());
+    if (partial) note += "，文件过大已抽样";
     if (m_uploadedFileLabel) {
-        m_uploadedFileLabel->setText(QString("已上传：%1 (%2)").arg(fileInfo.fileName()).arg(fileSizeStr));
+        m_uploadedFileLabel->setText(QString("已上传：%1%2").arg(m_fileName).arg(note));
         m_uploadedFileLabel->setVisible(true);
     }
 
     // 提示用户文件上传成功
-    QMessageBox::information(this, "成功", QString("文件「%1」上传成功！").arg(fileInfo.fileName()));
+    QMessageBox::information(this, "成功", QString("文件「%1」上传成功！").arg(m_fileName));
+}
+
+void LLMWidget::clearUploadedFile()
+{
+    if (m_fileLoader) {
+        // 不等待线程结束：结束后自行deleteLater，结果在onFileLoadFinished中被丢弃
+        m_fileLoader->requestInterruption();
+        m_fileLoader = nullptr;
+    }
+    m_fileChunks.clear();
+    m_filePartial = false;
+    m_fileName.clear();
+    if (m_uploadedFileLabel) {
+        m_uploadedFileLabel->clear();
+        m_uploadedFileLabel->setVisible(false);
+    }
+}
+
+// ---------- 大文件分段分析（map-reduce） ----------
+void LLMWidget::startChunkedAnalysis(const QString &question)
+{
+    QJsonObject cfg = getApiConfig();
+    if (cfg.isEmpty() || cfg["api_url"].toString().isEmpty() || cfg["api_key"].toString().isEmpty()) {
+        QMessageBox::warning(this, "警告", "请先配置 API 地址和密钥！");
+        return;
+    }
+
+    // 分析期间可能切换对话：新对话先建档，汇总请求发到发起分析的对话
+    if (m_currentDialogId == -1) {
+        int dialogId = m_chatDb->createDialog(m_currentUserId, "未命名对话");
+        if (dialogId <= 0) {
+            QMessageBox::warning(this, "警告", "创建对话失败，无法开始分析！");
+            return;
+        }
+        m_currentDialogId = dialogId;
+        loadHistoryDialogs();
+    }
+
+    m_mapRunning = true;
+    m_mapDialogId = m_currentDialogId;
+    m_mapConfig = cfg;
+    m_mapQuestion = question;
+    m_mapFileName = m_fileName;
+    m_mapChunks = m_fileChunks;
+    m_mapPartial = m_filePartial;
+    m_mapResults = QStringList();
+    for (int i = 0; i < m_mapChunks.size(); i++) m_mapResults << QString();
+    m_mapDone = 0;
+    m_mapCancelled = false;
+
+    if (m_chatContentEdit) {
+        m_chatContentEdit->append(QString("<span style='color:#95a5a6;'>【AI】正在处理中...（文件较大，正在分%1段分析）</span><br/>").arg(m_mapChunks.size()));
+        m_chatContentEdit->moveCursor(QTextCursor::End);
+    }
+    LOG_INFO("LLM模块", "【分段分析】开始：" << m_mapFileName << "，段数=" << m_mapChunks.size());
+    m_mapTimer.start();
+
+    // 各段一次性提交，以低优先级排队：并发受模型的并发上限约束，期间的对话请求优先发出
+    QNetworkRequest req(QUrl(m_mapConfig["api_url"].toString()));
+    req.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    req.setRawHeader("Authorization", QString("Bearer %1").arg(m_mapConfig["api_key"].toString()).toUtf8());
+    for (int index = 0; index < m_mapChunks.size(); index++) {
+        QString prompt = QString("需求：%1\n以下是文件「%2」的第%3/%4段内容。请只提取与需求相关的关键数据、现象和结论，"
+                                 "条目式列出，不超过300字；若本段与需求无关，只回复“无相关内容”。\n%5")
+                             .arg(m_mapQuestion, m_mapFileName, QString::number(index + 1),
+                                  QString::number(m_mapChunks.size()), m_mapChunks.at(index));
+
+        QJsonArray messages;
+        QJsonObject systemMsg; systemMsg["role"] = "system"; systemMsg["content"] = QString::fromUtf8(LLM_SYSTEM_PROMPT);
+        QJsonObject userMsg; userMsg["role"] = "user"; userMsg["content"] = prompt;
+        messages.append(systemMsg);
+        messages.append(userMsg);
+
+        QJsonObject reqObj;
+        reqObj["model"] = m_mapConfig["model"].toString();
+        reqObj["temperature"] = m_mapConfig["temperature"].toDouble();
+        reqObj["stream"] = false;
+        reqObj["messages"] = messages;
+
+        int requestId = m_scheduler->submit(reqObj["model"].toString(), req,
+                                            QJsonDocument(reqObj).toJson(QJsonDocument::Compact), LlmRequestScheduler::Low);
+        m_mapRequests.insert(requestId, index);
+    }
+    updateRequestUi();
+}
+
+void LLMWidget::onMapRequestFinished(int requestId, QNetworkReply *reply)
+{
+    int index = m_mapRequests.take(requestId);
+    // 进度显示在文件标签上：仅当前显示的是分析所属对话、且没有新上传的文件时
+    bool showProgress = (m_mapDialogId == m_currentDialogId && m_fileName.isEmpty() && m_uploadedFileLabel);
+
+    if (!m_mapCancelled) {
+        QString result;
+        if (reply && reply->error() == QNetworkReply::NoError) {
+            result = extractFullContentFromResponse(reply->readAll());
+        } else {
+            LOG_WARN("LLM模块", "【分段分析】第" << index + 1 << "段请求失败：" << (reply ? reply->errorString() : QString("已取消")));
+        }
+        m_mapResults[index] = result.isEmpty() ? QString("（本段分析失败）") : result;
+        m_mapDone++;
+        if (showProgress) {
+            m_uploadedFileLabel->setText(QString("分段分析中：%1 %2/%3").arg(m_mapFileName).arg(m_mapDone).arg(m_mapChunks.size()));
+            m_uploadedFileLabel->setVisible(true);
+        }
+    }
+
+    if (m_mapCancelled) {
+        if (!m_mapRequests.isEmpty()) return;
+        // 全部中止后恢复界面
+        m_mapRunning = false;
+        if (m_mapDialogId == m_currentDialogId) {
+            removeLoadingPlaceholder();
+            if (m_chatContentEdit) m_chatContentEdit->append("<span style='color:#e74c3c;'>【系统】请求已取消</span><br/>");
+        }
+        if (showProgress) {
+            m_uploadedFileLabel->clear();
+            m_uploadedFileLabel->setVisible(false);
+        }
+        updateRequestUi();
+        LOG_DEBUG("LLM模块", "【分段分析】用户已取消");
+        return;
+    }
+
+    if (m_mapDone == m_mapChunks.size()) {
+        finishChunkedAnalysis();
+    }
+}
+
+void LLMWidget::finishChunkedAnalysis()
+{
+    LOG_INFO("LLM模块", "【分段分析】完成，段数=" << m_mapChunks.size() << "，耗时：" << m_mapTimer.elapsed() << "ms");
+    bool visible = (m_mapDialogId == m_currentDialogId);
+    if (visible) {
+        removeLoadingPlaceholder();
+        if (m_uploadedFileLabel && m_fileName.isEmpty()) {
+            m_uploadedFileLabel->clear();
+            m_uploadedFileLabel->setVisible(false);
+        }
+    }
+
+    // reduce：各段要点作为附件，与原始需求一起发起最终（流式）请求
+    QStringList parts;
+    for (int i = 0; i < m_mapResults.size(); i++) {
+        parts << QString("【第%1段】%2").arg(i + 1).arg(m_mapResults.at(i));
+    }
+    QString summary = QString("文件「%1」共%2段%3，各段要点如下：\n%4")
+                          .arg(m_mapFileName, QString::number(m_mapChunks.size()),
+                               m_mapPartial ? QString("（文件过大，为均匀抽样的片段）") : QString(),
+                               parts.join("\n"));
+    m_mapChunks.clear();
+    m_mapResults.clear();
+    m_mapRunning = false;
+
+    if (visible) {
+        submitChatRequest(m_currentDialogId, m_messages, m_mapQuestion, summary);
+    } else {
+        // 已切换到其他对话：按所属对话的历史组装上下文，回复在后台写入该对话
+        bool ok = false;
+        QList<ChatMessage> history = m_chatDb->loadMessages(m_mapDialogId, m_currentUserId, &ok);
+        if (!ok || !submitChatRequest(m_mapDialogId, history, m_mapQuestion, summary)) {
+            LOG_ERROR("LLM模块", "【分段分析】汇总请求发送失败，对话ID=" << m_mapDialogId);
+        }
+    }
+    updateRequestUi();
+}
+
+void LLMWidget::updateRequestUi()
+{
+    bool busy = isDialogBusy(m_currentDialogId);
+    if (m_sendBtn) m_sendBtn->setEnabled(!busy);
+    if (m_cancelBtn) m_cancelBtn->setEnabled(busy);
 }
 
 // ---------- 模型切换槽函数 ----------
@@ -931,19 +1539,15 @@ void LLMWidget::onAddModelBtnClicked()
 // ---------- 新建对话槽函数（清空文件显示） ----------
 void LLMWidget::onNewDialogBtnClicked()
 {
-    if (m_chatContentEdit && !m_chatContentEdit->toPlainText().isEmpty()) {
-        saveCurrentDialog();
-    }
+    saveCurrentDialog();
     m_currentDialogId = -1;
+    resetMessages();
     if (m_chatContentEdit) m_chatContentEdit->clear();
     if (m_inputEdit) m_inputEdit->clear();
+    updateRequestUi();
 
     // 新增：清空文件内容和显示
-    m_fileContent.clear();
-    if (m_uploadedFileLabel) {
-        m_uploadedFileLabel->clear();
-        m_uploadedFileLabel->setVisible(false);
-    }
+    clearUploadedFile();
 
     loadHistoryDialogs();
 }
@@ -953,14 +1557,11 @@ void LLMWidget::onDialogItemClicked(QListWidgetItem *item)
 {
     if (!item) return;
     int id = item->data(Qt::UserRole).toInt();
+    saveCurrentDialog();
     loadDialogById(id);
 
     // 切换对话时清空文件内容和显示
-    m_fileContent.clear();
-    if (m_uploadedFileLabel) {
-        m_uploadedFileLabel->clear();
-        m_uploadedFileLabel->setVisible(false);
-    }
+    clearUploadedFile();
 }
 
 // ---------- 折叠/展开列表槽函数 ----------
@@ -970,9 +1571,11 @@ void LLMWidget::onToggleDialogListClicked()
     if (m_isDialogListCollapsed) {
         m_toggleBtn->setText("展开列表");
         if (m_dialogList) m_dialogList->hide();
+        if (m_dialogSearchEdit) m_dialogSearchEdit->hide();
     } else {
         m_toggleBtn->setText("折叠列表");
         if (m_dialogList) m_dialogList->show();
+        if (m_dialogSearchEdit) m_dialogSearchEdit->show();
     }
     if (layout()) layout()->update();
 }
@@ -994,7 +1597,7 @@ void LLMWidget::onRenameDialogActionTriggered()
     QListWidgetItem *cur = m_dialogList->currentItem();
     if (!cur) return;
     int dialogId = cur->data(Qt::UserRole).toInt();
-    QString old = cur->text();
+    QString old = cur->data(DIALOG_TITLE_ROLE).toString();
     bool ok;
     QString newTitle = QInputDialog::getText(this, "重命名对话", "新的对话标题：", QLineEdit::Normal, old, &ok);
     if (!ok || newTitle.isEmpty() || newTitle == old) return;
@@ -1008,7 +1611,6 @@ void LLMWidget::onRenameDialogActionTriggered()
     QString sql = QString("UPDATE chat_dialog SET dialog_title = ?, update_time = CURRENT_TIMESTAMP WHERE id = %1 AND user_id = %2").arg(dialogId).arg(m_currentUserId);
     QVariantList params = { newTitle };
     if (db->execPrepareSql(sql, params)) {
-        cur->setText(newTitle);
         QMessageBox::information(this, "成功", "重命名成功");
         loadHistoryDialogs();
     } else {
@@ -1029,7 +1631,7 @@ void LLMWidget::onDelDialogActionTriggered()
     // 2. 获取对话ID和标题（用于确认提示）
     int dialogId = curItem->data(Qt::UserRole).toInt();
     LOG_DEBUG("LLM模块", "【删除对话】对话ID：" << dialogId);
-    QString dialogTitle = curItem->text();
+    QString dialogTitle = curItem->data(DIALOG_TITLE_ROLE).toString();
     if (dialogId <= 0) {
         LOG_ERROR("LLM模块", "【删除对话】无效的对话ID：" << dialogId);
         QMessageBox::critical(this, "错误", "无效的对话ID，无法删除！");
@@ -1072,9 +1674,24 @@ void LLMWidget::onDelDialogActionTriggered()
     // 6. 删除成功后的UI和状态清理
     LOG_DEBUG("LLM模块", "【删除对话】成功，对话ID：" << dialogId);
 
+    // 该对话仍有进行中的请求时中止，回复不再写入
+    int requestId = chatRequestOfDialog(dialogId);
+    if (requestId != 0) {
+        m_chatRequests.remove(requestId);
+        m_scheduler->cancel(requestId);
+    }
+    if (m_mapRunning && m_mapDialogId == dialogId) {
+        m_mapCancelled = true;
+        const QList<int> mapRequests = m_mapRequests.keys();
+        for (int mapRequestId : mapRequests) {
+            m_scheduler->cancel(mapRequestId);
+        }
+    }
+
     // 如果删除的是当前正在查看的对话，清空聊天区域并重置状态
     if (dialogId == m_currentDialogId) {
         m_currentDialogId = -1; // 重置当前对话ID
+        resetMessages();
         if (m_chatContentEdit) {
             m_chatContentEdit->clear(); // 清空聊天内容
         }
@@ -1082,11 +1699,8 @@ void LLMWidget::onDelDialogActionTriggered()
             m_inputEdit->clear(); // 清空输入框
         }
         // 清空文件相关状态
-        m_fileContent.clear();
-        if (m_uploadedFileLabel) {
-            m_uploadedFileLabel->clear();
-            m_uploadedFileLabel->setVisible(false);
-        }
+        clearUploadedFile();
+        updateRequestUi();
     }
 
     // 7. 更新对话列表并提示成功
@@ -12,7 +12,14 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QLabel>
+#include <QElapsedTimer>
 #include "BaseDbHelper.h"
+#include "chatdbhelper.h"
+#include "llmstreamparser.h"
+#include "llmresponsecache.h"
+#include "llmfileloader.h"
+#include "llmrequestscheduler.h"
+#include "markdownrenderer.h"
 #include "ApiConfigDialog.h"
 
 class LLMWidget : public QWidget
@@ -37,42 +44,142 @@ private slots:
     void onAddModelBtnClicked();
     void onCancelBtnClicked();
 
-    // 网络请求相关槽函数
-    void onApiReplyFinished();
+    // 网络请求相关槽函数（调度器发出/结束请求时，按请求ID分发给对话请求或分段分析）
+    void onRequestStarted(int requestId, QNetworkReply *reply);
+    void onRequestFinished(int requestId, QNetworkReply *reply);
+    // 聊天区滚动到顶部时补渲染更早的消息
+    void onChatScrollValueChanged(int value);
+    // 对话列表滚动到底部时加载下一页
+    void onDialogListScrolled(int value);
+    // 搜索框输入（防抖后刷新列表）
+    void onDialogSearchTextChanged(const QString &text);
+    // 上传文件后台读取完成
+    void onFileLoadFinished(const QStringList &chunks, bool partial, const QString &errorText);
 
 private:
     // 核心初始化与数据操作函数
     void initUI();
+    // 重新加载对话列表（第一页）
     void loadHistoryDialogs();
+    bool loadMoreDialogs();
+    // 按关键词全文搜索对话，结果（标题+命中片段）替换对话列表
+    void showSearchResults(const QString &keyword);
     void loadModelList();
     bool saveCurrentDialog();
     bool loadDialogById(int dialogId);
     QJsonObject getApiConfig();
     bool saveSelectedModel(const QString &modelCode);
+    // model_config.context_tokens，未配置时取config.ini [LLM] ContextTokens
+    int loadContextBudget(const QString &modelCode);
 
-    // 网络请求函数（非流式）
-    void sendApiRequest(const QString &content);
-    QString extractFullContentFromResponse(const QByteArray &data);
+    // 网络请求函数（流式/非流式由config.ini [LLM] StreamMode决定）
+    // attachment为上传的文件内容，超出上下文预算时截断后发送
+    void sendApiRequest(const QString &question, const QString &attachment = QString());
+    // 在指定对话中发起请求：history为该对话已有消息；对话不是当前对话时回复直接入库
+    bool submitChatRequest(int dialogId, const QList<ChatMessage> &history, const QString &question, const QString &attachment);
+    // 对话有进行中的请求（含分段分析）
+    bool isDialogBusy(int dialogId) const;
+    int chatRequestOfDialog(int dialogId) const;
+    // finishReason非空时写出choices[0].finish_reason
+    QString extractFullContentFromResponse(const QByteArray &data, QString *finishReason = nullptr);
+    // 解析流式响应中单个chunk的增量内容（choices[0].delta.content）
+    QString extractDeltaFromChunk(const QString &data, QString *finishReason = nullptr);
+    void loadLlmConfig();
 
-    // 格式转换核心函数
+    // 聊天区域辅助函数
+    void removeLoadingPlaceholder();
+    // 流式渲染：首个增量到达时开始，结束时整体替换为Markdown富文本
+    void beginStreamingAnswer();
+    void appendStreamingDelta(const QString &delta);
+    void finishStreamingAnswer(const QString &errorText);
+    // 切换到有进行中请求的对话时，重新显示占位符或已收到的部分回复
+    void showPendingAnswer();
+    // 对话请求的流式增量/结束处理
+    void onChatReplyReadyRead(int requestId, QNetworkReply *reply);
+    void onChatRequestFinished(int requestId, QNetworkReply *reply);
+    // 消息写入对话：当前对话追加到m_messages并保存，其他对话按seq直接入库
+    void storeMessage(int dialogId, int seq, const QString &role, const QString &content);
+    // 大文件分段分析（map-reduce）：逐段提取要点，汇总后作为附件发起最终请求
+    void startChunkedAnalysis(const QString &question);
+    void onMapRequestFinished(int requestId, QNetworkReply *reply);
+    void finishChunkedAnalysis();
+    // 清空已上传的文件（读取中的同时取消）
+    void clearUploadedFile();
+    // 当前对话有请求进行中时禁止再次发送，只允许取消（其他对话、文件上传不受影响）
+    void updateRequestUi();
+
+    // 回复缓存命中时直接显示并保存，不发请求
+    void answerFromCache(const QString &content, const QString &answer);
+
+    // 消息记录：追加到m_messages（入库由saveCurrentDialog增量完成）
+    void appendMessage(const QString &role, const QString &content);
+    // 渲染m_messages[from, to)，prepend=true时插入到聊天区顶部并保持当前阅读位置
+    void renderMessages(int from, int to, bool prepend);
+    QString messageToHtml(const ChatMessage &message);
+    void resetMessages();
+
+    // 格式转换核心函数（Markdown+LaTeX，见MarkdownRenderer）
     QString convertMarkdownToRichText(const QString &markdown);
-    // 处理LaTeX公式转换为MathJax兼容格式
-    QString processLatexFormulas(const QString &text);
 
     // 1. 核心业务数据
     int m_currentUserId = -1;
     int m_currentDialogId = -1;
     QString m_selectedModelCode;
-    QString m_fileContent;
+    QStringList m_fileChunks;          // 上传文件按token上限切分后的内容（单段时等同原文）
+    bool m_filePartial = false;        // 文件过大，只纳入了抽样部分
+    QString m_fileName;
+    LlmFileLoader *m_fileLoader = nullptr;
+    ChatDbHelper *m_chatDb = nullptr;
+    QList<ChatMessage> m_messages;     // 当前对话的全部消息（请求上下文以此为准，不再从聊天区解析）
+    int m_savedCount = 0;              // m_messages中已入库的条数
+    int m_renderedFrom = 0;            // 聊天区已渲染的第一条消息下标（更早的按需渲染）
+    int m_dialogPageSize = 50;         // 对话列表每页条数
+    QDateTime m_dialogCursorTime;      // 对话列表已加载的最后一行（keyset分页游标）
+    int m_dialogCursorId = 0;
+    bool m_dialogHasMore = true;
+    int m_searchResultLimit = 50;      // 搜索结果最多显示的对话数
 
     // 2. 网络请求相关
-    QNetworkAccessManager *m_netManager = nullptr;
-    QNetworkReply *m_currentReply = nullptr;
+    // 进行中的对话请求（每个对话同时最多一个）
+    struct ChatRequest {
+        int dialogId = -1;
+        int replySeq = 0;              // 回复入库时的消息序号
+        bool eventStream = false;      // 响应是否为SSE（服务端可能忽略stream参数）
+        LlmSseParser sseParser;
+        QString content;               // 已收到的完整回复
+        QString cacheKey;              // 成功后写入缓存的键（空=不缓存）
+        QString finishReason;          // 服务端给出的结束原因（stop/length等）
+        QElapsedTimer timer;
+        qint64 firstTokenMs = -1;      // 首字耗时
+    };
+    LlmRequestScheduler *m_scheduler = nullptr;
+    QHash<int, ChatRequest> m_chatRequests;
+    bool m_streamMode = true;          // 是否请求流式输出
+    MarkdownRenderer m_streamRenderer; // 当前对话的流式增量渲染
+    int m_streamAnchorPos = -1;        // 尚未渲染的纯文本尾部在文档中的起始位置（-1=尚未开始）
+    int m_defaultContextTokens = 8000; // 上下文token预算默认值
+    int m_replyReserveTokens = 1024;   // 预算中为回复预留的token数
+    LlmResponseCache *m_responseCache = nullptr; // 回复缓存（config.ini [LLMCache]，关闭时为空）
+    bool m_cacheNonZeroTemperature = false;      // temperature>0时是否也走缓存
+    int m_maxFileChunks = 16;          // 上传文件最多分段数
+
+    // 分段分析状态（同时只进行一个，分段请求以低优先级排队）
+    bool m_mapRunning = false;
+    int m_mapDialogId = -1;
+    QElapsedTimer m_mapTimer;
+    QJsonObject m_mapConfig;
+    QString m_mapQuestion;
+    QString m_mapFileName;
+    QStringList m_mapChunks;
+    QStringList m_mapResults;
+    bool m_mapPartial = false;
+    int m_mapDone = 0;
+    bool m_mapCancelled = false;
+    QHash<int, int> m_mapRequests;     // 请求ID -> 段序号
 
     // 3. UI 状态控制
     bool m_isDialogListCollapsed = false;
     bool m_isInit = true;
-    bool m_isRequestProcessing = false;
 
     // 4. UI 控件（菜单/动作）
     QMenu *m_dialogContextMenu = nullptr;
@@ -87,6 +194,8 @@ private:
 
     // 6. UI 控件（列表/编辑框）
     QListWidget *m_dialogList = nullptr;
+    QLineEdit *m_dialogSearchEdit = nullptr;
+    QTimer *m_searchTimer = nullptr;   // 搜索输入防抖
     QTextEdit *m_chatContentEdit = nullptr;
     QTextEdit *m_inputEdit = nullptr;
     QLabel *m_uploadedFileLabel = nullptr;
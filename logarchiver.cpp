@@ -0,0 +1,223 @@
+#include "logarchiver.h"
+#include "crc32helper.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDebug>
+
+static const char *ARCHIVE_SUFFIX = ".gz";
+
+static void appendLE32(QByteArray &out, quint32 value)
+{
+    out.append(char(value & 0xFF));
+    out.append(char((value >> 8) & 0xFF));
+    out.append(char((value >> 16) & 0xFF));
+    out.append(char((value >> 24) & 0xFF));
+}
+
+// 从文件名中的分割时间（<名称>_yyyyMMdd_hhmmss.<后缀>）取归档时间，取不到时用修改时间
+static QDateTime rotatedTime(const QFileInfo &info)
+{
+    QString name = info.fileName();
+    int stampPos = name.indexOf('_');
+    while (stampPos >= 0) {
+        QDateTime time = QDateTime::fromString(name.mid(stampPos + 1, 15), "yyyyMMdd_hhmmss");
+        if (time.isValid()) {
+            return time;
+        }
+        stampPos = name.indexOf('_', stampPos + 1);
+    }
+    return info.lastModified();
+}
+
+LogArchiver::LogArchiver(QObject *parent) : QThread(parent)
+{
+}
+
+LogArchiver::~LogArchiver()
+{
+    stop();
+}
+
+void LogArchiver::setPolicy(const QString &logFilePath, const LogRetentionPolicy &policy)
+{
+    QMutexLocker locker(&m_mutex);
+    m_logFilePath = logFilePath;
+    m_policy = policy;
+}
+
+void LogArchiver::submit(const QString &rotatedFile)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending.enqueue(rotatedFile);
+    m_workReady.wakeOne();
+}
+
+void LogArchiver::requestScan()
+{
+    QMutexLocker locker(&m_mutex);
+    m_scanRequested = true;
+    m_workReady.wakeOne();
+}
+
+void LogArchiver::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_workReady.wakeOne();
+    }
+    requestInterruption(); // 正在压缩时处理完当前文件即退出
+    wait();
+}
+
+void LogArchiver::run()
+{
+    forever {
+        QStringList files;
+        QString logFilePath;
+        LogRetentionPolicy policy;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_pending.isEmpty() && !m_scanRequested && !m_stopping) {
+                m_workReady.wait(&m_mutex);
+            }
+            if (m_stopping) {
+                break;
+            }
+            while (!m_pending.isEmpty()) {
+                files << m_pending.dequeue();
+            }
+            logFilePath = m_logFilePath;
+            policy = m_policy;
+            if (m_scanRequested && !logFilePath.isEmpty()) {
+                // 上次运行遗留的未压缩文件
+                for (const QString &file : rotatedFiles(logFilePath, true)) {
+                    if (!files.contains(file)) {
+                        files << file;
+                    }
+                }
+            }
+            m_scanRequested = false;
+        }
+
+        if (policy.compress) {
+            for (const QString &file : files) {
+                if (isInterruptionRequested()) {
+                    break;
+                }
+                compressFile(file);
+            }
+        }
+        if (!logFilePath.isEmpty()) {
+            enforceRetention(logFilePath, policy);
+        }
+    }
+}
+
+QStringList LogArchiver::rotatedFiles(const QString &logFilePath, bool uncompressedOnly)
+{
+    QFileInfo fi(logFilePath);
+    QString pattern = QString("%1_*.%2").arg(fi.baseName()).arg(fi.suffix());
+    QStringList nameFilters;
+    nameFilters << pattern;
+    if (!uncompressedOnly) {
+        nameFilters << pattern + ARCHIVE_SUFFIX;
+    }
+
+    // 文件名含分割时间，按名称排序即从旧到新
+    QDir dir = fi.dir();
+    QStringList files;
+    for (const QString &name : dir.entryList(nameFilters, QDir::Files, QDir::Name)) {
+        files << dir.filePath(name);
+    }
+    return files;
+}
+
+bool LogArchiver::compressFile(const QString &path)
+{
+    QFile source(path);
+    if (!source.exists() || path.endsWith(ARCHIVE_SUFFIX)) {
+        return false;
+    }
+    if (!source.open(QIODevice::ReadOnly)) {
+        qWarning() << "日志归档：无法读取" << path << source.errorString();
+        return false;
+    }
+    QByteArray data = source.readAll();
+    source.close();
+
+    // qCompress输出 = 4字节原始长度 + zlib流(2字节头 + deflate数据 + 4字节Adler32)
+    // 取出其中的deflate数据，加上gzip头尾即为标准.gz文件，无需额外依赖zlib
+    // 空文件时qCompress只返回4字节长度，直接写入空的deflate块（一个结束的固定哈夫曼块）
+    QByteArray deflate;
+    if (data.isEmpty()) {
+        deflate = QByteArray("\x03\x00", 2);
+    } else {
+        QByteArray zlib = qCompress(data, 6);
+        if (zlib.size() < 4 + 2 + 4) {
+            return false;
+        }
+        deflate = zlib.mid(6, zlib.size() - 6 - 4);
+    }
+    QByteArray gzip;
+    gzip.reserve(deflate.size() + 18);
+    static const char header[] = { '\x1f', '\x8b', '\x08', '\x00', 0, 0, 0, 0, '\x00', '\xff' };
+    gzip.append(header, sizeof(header));
+    gzip.append(deflate);
+    appendLE32(gzip, crc32Ieee(data));
+    appendLE32(gzip, quint32(data.size()));
+
+    // 先写临时文件再改名，避免中途退出留下不完整的.gz
+    QString target = path + ARCHIVE_SUFFIX;
+    QString tmpPath = target + ".tmp";
+    QFile tmp(tmpPath);
+    if (!tmp.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "日志归档：无法写入" << tmpPath << tmp.errorString();
+        return false;
+    }
+    bool ok = (tmp.write(gzip) == gzip.size());
+    tmp.close();
+    if (!ok) {
+        QFile::remove(tmpPath);
+        return false;
+    }
+    QFile::remove(target);
+    if (!QFile::rename(tmpPath, target)) {
+        QFile::remove(tmpPath);
+        return false;
+    }
+    QFile::remove(path);
+    return true;
+}
+
+void LogArchiver::enforceRetention(const QString &logFilePath, const LogRetentionPolicy &policy)
+{
+    if (policy.maxTotalBytes <= 0 && policy.maxAgeDays <= 0) {
+        return;
+    }
+
+    QStringList files = rotatedFiles(logFilePath, false);
+    QDateTime expireBefore = QDateTime::currentDateTime().addDays(-policy.maxAgeDays);
+
+    // 1. 超过保留天数的文件
+    qint64 totalBytes = 0;
+    QStringList kept;
+    for (const QString &file : files) {
+        QFileInfo info(file);
+        if (policy.maxAgeDays > 0 && rotatedTime(info) < expireBefore) {
+            QFile::remove(file);
+            continue;
+        }
+        totalBytes += info.size();
+        kept << file;
+    }
+
+    // 2. 超过总大小时从最旧的开始删除
+    while (policy.maxTotalBytes > 0 && totalBytes > policy.maxTotalBytes && !kept.isEmpty()) {
+        QString oldest = kept.takeFirst();
+        totalBytes -= QFileInfo(oldest).size();
+        QFile::remove(oldest);
+    }
+}
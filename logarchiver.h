@@ -0,0 +1,59 @@
+#ifndef LOGARCHIVER_H
+#define LOGARCHIVER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QStringList>
+
+// 日志归档策略
+struct LogRetentionPolicy {
+    bool compress = true;        // 分割出的文件是否压缩为.gz
+    qint64 maxTotalBytes = 0;    // 归档文件总大小上限（0=不限）
+    int maxAgeDays = 0;          // 归档文件最长保留天数（0=不限）
+};
+
+/**
+ * @brief 日志归档线程
+ * 日志分割后把旧文件交给本线程：压缩为gzip、按总大小/保留天数清理，
+ * 均在后台完成，不占用LogHelper的日志锁。
+ * 退出时未处理完的文件保留原样，下次启动扫描时继续处理。
+ */
+class LogArchiver : public QThread
+{
+    Q_OBJECT
+public:
+    explicit LogArchiver(QObject *parent = nullptr);
+    ~LogArchiver() override;
+
+    // 设置当前日志文件（据此识别分割出的文件：<名称>_<时间>.<后缀>[.gz]）及策略
+    void setPolicy(const QString &logFilePath, const LogRetentionPolicy &policy);
+    // 提交一个刚分割出的文件（线程安全，立即返回）
+    void submit(const QString &rotatedFile);
+    // 请求扫描目录：处理上次遗留的未压缩文件并执行清理
+    void requestScan();
+    // 停止线程：放弃尚未处理的文件
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    // 压缩为 <path>.gz 后删除原文件
+    bool compressFile(const QString &path);
+    // 按保留天数和总大小删除最旧的归档文件
+    void enforceRetention(const QString &logFilePath, const LogRetentionPolicy &policy);
+    // 列出已分割的文件（按修改时间从旧到新）
+    static QStringList rotatedFiles(const QString &logFilePath, bool uncompressedOnly);
+
+    QMutex m_mutex;
+    QWaitCondition m_workReady;
+    QQueue<QString> m_pending;
+    bool m_scanRequested = false;
+    bool m_stopping = false;
+    QString m_logFilePath;
+    LogRetentionPolicy m_policy;
+};
+
+#endif // LOGARCHIVER_H
@@ -7,22 +7,31 @@ LogDbHelper::LogDbHelper(QObject *parent) : QObject(parent)
 }
 
 // 获取所有日志列表
-QSqlQuery LogDbHelper::getAllLogList(int UUID)
+DbQuery LogDbHelper::getAllLogList(int UUID)
 {
     QString sql = "SELECT * FROM sys_log WHERE user_id = ? ORDER BY log_id DESC";
-    QSqlQuery query = m_baseDbHelper->execPrepareQuery(sql, {UUID});
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, {UUID});
     return query;
 }
 
-QSqlQuery LogDbHelper::getAllLogList()
+DbQuery LogDbHelper::getAllLogList()
 {
     QString sql = "SELECT * FROM sys_log ORDER BY log_id DESC";
-    QSqlQuery query = m_baseDbHelper->execPrepareQuery(sql, {});
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, {});
     return query;
 }
 
+// 异步获取日志列表
+quint64 LogDbHelper::getAllLogListAsync(int UUID, QObject *context, DbResultCallback callback)
+{
+    if (UUID < 0) {
+        return m_baseDbHelper->execPrepareQueryAsync("SELECT * FROM sys_log ORDER BY log_id DESC", {}, context, callback);
+    }
+    return m_baseDbHelper->execPrepareQueryAsync("SELECT * FROM sys_log WHERE user_id = ? ORDER BY log_id DESC", {UUID}, context, callback);
+}
+
 // 搜索日志
-QSqlQuery LogDbHelper::searchLogByKey(const QString &key)
+DbQuery LogDbHelper::searchLogByKey(const QString &key)
 {
     QString sql = "SELECT * FROM sys_log WHERE operator LIKE ? OR operation_content LIKE ? OR operation_time LIKE ? OR ip_address LIKE ? ORDER BY log_id ASC";
     QString likeKey = "%" + key + "%";
@@ -41,3 +50,19 @@ bool LogDbHelper::insertLog(int user_id,
     QString sql = "INSERT INTO sys_log (user_id, operation_type, operation_content, ip_address, log_level, module_name) VALUES (?, ?, ?, ?, ?, ?)";
     return m_baseDbHelper->execPrepareSql(sql, {user_id, operation_type, operation_content, ip_address, log_level, module_name});
 }
+
+// 批量插入日志：多行VALUES按固定行数分块，整批在一个事务内写入
+bool LogDbHelper::insertLogBatch(const QList<SysLogRecord>& records)
+{
+    if (records.isEmpty()) return true;
+
+    QVariantList params;
+    for (const SysLogRecord& record : records) {
+        params << record.user_id << record.operation_type << record.operation_content
+               << record.ip_address << record.log_level << record.module_name
+               << record.create_time.toString("yyyy-MM-dd HH:mm:ss");
+    }
+    return m_baseDbHelper->execPrepareSqlRows(
+        "INSERT INTO sys_log (user_id, operation_type, operation_content, ip_address, log_level, module_name, create_time) VALUES ",
+        "(?, ?, ?, ?, ?, ?, ?)", 7, params);
+}
@@ -4,6 +4,18 @@
 #include <QObject>
 #include <QSqlQuery>
 #include "BaseDbHelper.h"
+#include <QDateTime>
+
+// sys_log单行记录（批量写入/落盘暂存使用）
+struct SysLogRecord {
+    int user_id = 0;
+    QString operation_type;
+    QString operation_content;
+    QString ip_address;
+    QString log_level;
+    QString module_name;
+    QDateTime create_time;   // 事件发生时间（批量延迟写入，需显式写入）
+};
 
 // 日志业务助手：仅处理日志相关业务逻辑
 class LogDbHelper : public QObject
@@ -13,9 +25,11 @@ public:
     explicit LogDbHelper(QObject *parent = nullptr);
 
     // 日志查询操作
-    QSqlQuery getAllLogList(int UUID);
-    QSqlQuery getAllLogList();
-    QSqlQuery searchLogByKey(const QString &key);
+    DbQuery getAllLogList(int UUID);
+    DbQuery getAllLogList();
+    DbQuery searchLogByKey(const QString &key);
+    // 异步查询日志列表（UUID < 0 表示全部），结果在context线程回调
+    quint64 getAllLogListAsync(int UUID, QObject *context, DbResultCallback callback);
     // 插入日志：参数顺序与最终sys_log表字段对齐
     bool insertLog(int user_id,                     // 关联用户ID
                    const QString& operation_type,   // 操作类型
@@ -23,6 +37,8 @@ public:
                    const QString& ip_address,       // IP地址（IPv4/IPv6）
                    const QString& log_level,        // 日志级别
                    const QString& module_name);     // 模块名称
+    // 批量插入日志：多行INSERT，整批原子写入
+    bool insertLogBatch(const QList<SysLogRecord>& records);
 private:
     BaseDbHelper *m_baseDbHelper; // 依赖通用数据库层
 };
@@ -2,6 +2,10 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QRegularExpressionMatch>
+#include <QThread>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QWaitCondition>
 
 // ========== 系统日志对接（条件编译） ==========
 #ifdef Q_OS_WIN
@@ -11,6 +15,70 @@
 #include <syslog.h>
 #endif
 
+// ========== 异步写入线程 ==========
+class LogWriterThread : public QThread
+{
+public:
+    LogWriterThread(LogHelper* helper, int flushIntervalMs)
+        : m_helper(helper), m_flushIntervalMs(flushIntervalMs) {}
+
+    // 停止：写完队列剩余日志后退出
+    void requestStop()
+    {
+        QMutexLocker locker(&m_waitMutex);
+        m_stop = true;
+        m_wakeUp.wakeOne();
+    }
+
+    // 阻塞等待：本次调用前入队的日志全部写出
+    void waitFlushed()
+    {
+        QMutexLocker locker(&m_waitMutex);
+        quint64 target = ++m_flushRequested;
+        m_wakeUp.wakeOne();
+        while (m_flushDone < target && isRunning()) {
+            m_flushed.wait(&m_waitMutex, 50);
+        }
+    }
+
+    // 唤醒写入线程立即写出（队列满时由生产者调用）
+    void wakeUp()
+    {
+        QMutexLocker locker(&m_waitMutex);
+        m_wakeUp.wakeOne();
+    }
+
+protected:
+    void run() override
+    {
+        forever {
+            int written = m_helper->drainAsyncBuffer();
+            if (written > 0) {
+                continue; // 仍有积压，继续批量写出
+            }
+
+            QMutexLocker locker(&m_waitMutex);
+            // 队列已空：完成之前的刷新请求
+            m_flushDone = m_flushRequested;
+            m_flushed.wakeAll();
+            if (m_stop) {
+                break;
+            }
+            m_wakeUp.wait(&m_waitMutex, static_cast<unsigned long>(m_flushIntervalMs));
+        }
+    }
+
+private:
+    LogHelper* m_helper;
+    int m_flushIntervalMs;
+    QMutex m_waitMutex;
+    QWaitCondition m_wakeUp;
+    QWaitCondition m_flushed;
+    bool m_stop = false;
+    quint64 m_flushRequested = 0;
+    quint64 m_flushDone = 0;
+};
+
 // ========== 单例实现 ==========
 LogHelper& LogHelper::instance()
 {
@@ -25,10 +93,21 @@ LogHelper::LogHelper()
     m_lastSplitTime = QDateTime::currentDateTime();
     // 默认格式配置
     m_formatConfig = LogFormatConfig();
+    rebuildHeaderTemplate();
 }
 
 LogHelper::~LogHelper()
 {
+    // 先停止写入线程（写完剩余日志），再关闭文件
+    setAsyncMode(false);
+    delete m_asyncBuffer;
+    m_asyncBuffer = nullptr;
+    qDeleteAll(m_retiredFilters);
+    delete m_moduleFilter.exchange(nullptr);
+    // 归档线程放弃未处理的文件（下次启动扫描时继续）
+    delete m_archiver;
+    m_archiver = nullptr;
+
     QMutexLocker locker(&m_logMutex);
     if (m_logFile) {
         m_logFile->close();
@@ -40,14 +119,12 @@ LogHelper::~LogHelper()
 // ========== 基础日志级别控制 ==========
 void LogHelper::setLogLevel(LogLevel level)
 {
-    QMutexLocker locker(&m_logMutex);
-    m_logLevel = level;
+    m_logLevel.storeRelease(level);
 }
 
 LogLevel LogHelper::getLogLevel() const
 {
-    QMutexLocker locker(&m_logMutex);
-    return m_logLevel;
+    return static_cast<LogLevel>(m_logLevel.loadAcquire());
 }
 
 // ========== 日志文件 & 分割配置 ==========
@@ -55,6 +132,10 @@ void LogHelper::setLogFile(const QString& filePath)
 {
     QMutexLocker locker(&m_logMutex);
     m_logFilePath = filePath;
+    if (m_archiver) {
+        m_archiver->setPolicy(m_logFilePath, m_retentionPolicy);
+        m_archiver->requestScan();
+    }
 
     if (m_logFilePath.isEmpty()) {
         if (m_logFile) {
@@ -98,6 +179,21 @@ void LogHelper::setLogSplitRule(LogSplitType type, qint64 maxSizeMB, LogTimeSpli
     m_timeUnit = timeUnit;
 }
 
+void LogHelper::setLogRetention(bool compress, qint64 maxTotalMB, int maxAgeDays)
+{
+    QMutexLocker locker(&m_logMutex);
+    m_retentionPolicy.compress = compress;
+    m_retentionPolicy.maxTotalBytes = qMax<qint64>(0, maxTotalMB) * 1024 * 1024;
+    m_retentionPolicy.maxAgeDays = qMax(0, maxAgeDays);
+
+    if (!m_archiver) {
+        m_archiver = new LogArchiver;
+        m_archiver->start(QThread::LowPriority);
+    }
+    m_archiver->setPolicy(m_logFilePath, m_retentionPolicy);
+    m_archiver->requestScan(); // 处理之前遗留的分割文件
+}
+
 // ========== 日志分割辅助方法 ==========
 QString LogHelper::generateSplitFileName()
 {
@@ -151,7 +247,10 @@ void LogHelper::checkAndSplitLogFile()
         m_logFile->close();
         // 重命名旧文件
         QString newFileName = generateSplitFileName();
-        QFile::rename(m_logFilePath, newFileName);
+        // 改名后立即重开，压缩和清理交给归档线程，不占用日志锁
+        if (QFile::rename(m_logFilePath, newFileName) && m_archiver) {
+            m_archiver->submit(newFileName);
+        }
         // 重新打开新文件
         m_logFile->setFileName(m_logFilePath);
         if (m_logFile->open(QIODevice::Append | QIODevice::Text)) {
@@ -168,6 +267,7 @@ void LogHelper::setFilterMode(LogFilterMode mode)
 {
     QMutexLocker locker(&m_logMutex);
     m_filterMode = mode;
+    publishModuleFilter();
 }
 
 void LogHelper::addFilterKeyword(const QString& keyword, bool isRegex)
@@ -178,6 +278,8 @@ void LogHelper::addFilterKeyword(const QString& keyword, bool isRegex)
     } else {
         m_filterKeywords.insert(keyword);
     }
+    m_keywordMatcher.rebuild(m_filterKeywords, m_regexKeywords);
+    publishModuleFilter();
 }
 
 void LogHelper::clearFilterKeywords()
@@ -185,18 +287,56 @@ void LogHelper::clearFilterKeywords()
     QMutexLocker locker(&m_logMutex);
     m_filterKeywords.clear();
     m_regexKeywords.clear();
+    m_keywordMatcher.rebuild(m_filterKeywords, m_regexKeywords);
+    publishModuleFilter();
 }
 
 void LogHelper::addFilterModule(const QString& module)
 {
     QMutexLocker locker(&m_logMutex);
     m_filterModules.insert(module);
+    publishModuleFilter();
 }
 
 void LogHelper::clearFilterModules()
 {
     QMutexLocker locker(&m_logMutex);
     m_filterModules.clear();
+    publishModuleFilter();
+}
+
+// 过滤规则只在启动时配置，直接整份复制发布；旧快照保留到析构，避免与无锁读者竞争
+void LogHelper::publishModuleFilter()
+{
+    LogModuleFilter* filter = new LogModuleFilter;
+    filter->mode = m_filterMode;
+    filter->modules = m_filterModules;
+    filter->hasKeywords = !m_filterKeywords.isEmpty() || !m_regexKeywords.isEmpty();
+
+    const LogModuleFilter* old = m_moduleFilter.exchange(filter, std::memory_order_acq_rel);
+    if (old) {
+        m_retiredFilters.append(old);
+    }
+}
+
+bool LogHelper::shouldLog(LogLevel level, const QString& module) const
+{
+    // 1. 级别
+    LogLevel logLevel = getLogLevel();
+    if (level > logLevel || logLevel == LOG_LEVEL_OFF) {
+        return false;
+    }
+
+    // 2. 模块（与filterLog一致：模块或关键词任一命中即视为匹配）
+    const LogModuleFilter* filter = m_moduleFilter.load(std::memory_order_acquire);
+    if (!filter || filter->modules.isEmpty()) {
+        return true; // 无模块规则，交给filterLog按内容判断
+    }
+    bool listed = filter->modules.contains(module);
+    if (filter->mode == FILTER_BLACK_LIST) {
+        return !listed; // 黑名单模块必然被过滤；其余看关键词
+    }
+    return listed || filter->hasKeywords; // 白名单：模块未命中且无关键词规则时必然被过滤
 }
 
 // 过滤逻辑：返回true=需要打印，false=过滤掉
@@ -213,24 +353,9 @@ bool LogHelper::filterLog(const QString& module, const QString& msg)
         match = m_filterModules.contains(module);
     }
 
-    // 2. 关键词过滤（正则+普通）
-    if (!match && !m_filterKeywords.isEmpty()) {
-        for (const QString& kw : m_filterKeywords) {
-            if (msg.contains(kw, Qt::CaseInsensitive)) {
-                match = true;
-                break;
-            }
-        }
-    }
-
-    // 3. 正则关键词过滤
-    if (!match && !m_regexKeywords.isEmpty()) {
-        for (const QRegularExpression& re : m_regexKeywords) {
-            if (re.match(msg).hasMatch()) {
-                match = true;
-                break;
-            }
-        }
+    // 2. 关键词过滤（普通关键词走自动机，正则走合并后的单个正则）
+    if (!match && !m_keywordMatcher.isEmpty()) {
+        match = m_keywordMatcher.matches(msg);
     }
 
     // 白名单：仅匹配的打印；黑名单：匹配的不打印
@@ -242,6 +367,7 @@ void LogHelper::setLogFormat(const LogFormatConfig& format)
 {
     QMutexLocker locker(&m_logMutex);
     m_formatConfig = format;
+    rebuildHeaderTemplate();
 }
 
 LogFormatConfig LogHelper::getLogFormat() const
@@ -250,47 +376,128 @@ LogFormatConfig LogHelper::getLogFormat() const
     return m_formatConfig;
 }
 
-// 拼接自定义格式头部
-QString LogHelper::buildLogHeader(LogLevel level, const QString& module, const QString& file, int line)
+// 预计算头部模板：级别标签固定，时间格式按毫秒字段拆成前后两段
+void LogHelper::rebuildHeaderTemplate()
+{
+    for (int i = 0; i <= LOG_LEVEL_DEBUG; i++) {
+        switch (i) {
+        case LOG_LEVEL_DEBUG: m_levelTags[i] = "[DEBUG]"; break;
+        case LOG_LEVEL_INFO:  m_levelTags[i] = "[INFO]";  break;
+        case LOG_LEVEL_WARN:  m_levelTags[i] = "[WARN]";  break;
+        case LOG_LEVEL_ERROR: m_levelTags[i] = "[ERROR]"; break;
+        case LOG_LEVEL_FATAL: m_levelTags[i] = "[FATAL]"; break;
+        default:              m_levelTags[i] = "[UNKNOWN]";
+        }
+    }
+
+    // 扫描时间格式（跳过单引号内的文本）：定位毫秒字段，判断能否按秒缓存
+    const QString& fmt = m_formatConfig.timeFormat;
+    int millisPos = -1;
+    int millisRuns = 0;
+    bool hasAmPm = false;
+    bool quoted = false;
+    for (int i = 0; i < fmt.size(); i++) {
+        QChar c = fmt.at(i);
+        if (c == QLatin1Char('\'')) {
+            quoted = !quoted;
+        } else if (!quoted && c == QLatin1Char('z')) {
+            int runEnd = i;
+            while (runEnd < fmt.size() && fmt.at(runEnd) == QLatin1Char('z')) {
+                runEnd++;
+            }
+            millisRuns++;
+            millisPos = (runEnd - i == 3) ? i : -2; // 仅支持定长的zzz
+            i = runEnd - 1;
+        } else if (!quoted && (c == QLatin1Char('a') || c == QLatin1Char('A'))) {
+            hasAmPm = true;
+        }
+    }
+
+    m_timeHasMillis = (millisRuns == 1 && millisPos >= 0);
+    // 含AP时拆分会改变hh的含义；非zzz形式的毫秒字段也无法只改写数字
+    m_timeCacheable = (millisRuns == 0) || (m_timeHasMillis && !hasAmPm);
+    if (m_timeHasMillis) {
+        m_timePrefixFormat = fmt.left(millisPos);
+        m_timeSuffixFormat = fmt.mid(millisPos + 3);
+    } else {
+        m_timePrefixFormat = fmt;
+        m_timeSuffixFormat.clear();
+    }
+    m_cachedSecond = -1;
+}
+
+void LogHelper::appendTimestamp(QString& out, qint64 timeMs)
+{
+    if (!m_timeCacheable) {
+        out += QDateTime::fromMSecsSinceEpoch(timeMs).toString(m_formatConfig.timeFormat);
+        return;
+    }
+
+    // 同一秒内的日志复用前后两段，只格式化一次
+    qint64 second = timeMs / 1000;
+    if (second != m_cachedSecond) {
+        QDateTime secondTime = QDateTime::fromMSecsSinceEpoch(second * 1000);
+        m_cachedTimePrefix = m_timePrefixFormat.isEmpty() ? QString() : secondTime.toString(m_timePrefixFormat);
+        m_cachedTimeSuffix = m_timeSuffixFormat.isEmpty() ? QString() : secondTime.toString(m_timeSuffixFormat);
+        m_cachedSecond = second;
+    }
+
+    out += m_cachedTimePrefix;
+    if (m_timeHasMillis) {
+        int ms = static_cast<int>(timeMs % 1000);
+        const QChar digits[3] = { QLatin1Char(char('0' + ms / 100)),
+                                  QLatin1Char(char('0' + ms / 10 % 10)),
+                                  QLatin1Char(char('0' + ms % 10)) };
+        out.append(digits, 3);
+        out += m_cachedTimeSuffix;
+    }
+}
+
+// 拼接自定义格式头部（各部分以空格分隔，末尾" | "）
+void LogHelper::buildLogHeader(QString& out, const LogRecord& record)
 {
-    QStringList headerParts;
+    const int start = out.size();
 
     // 1. 日志级别
     if (m_formatConfig.showLevel) {
-        QString levelStr;
-        switch (level) {
-        case LOG_LEVEL_DEBUG: levelStr = "[DEBUG]"; break;
-        case LOG_LEVEL_INFO:  levelStr = "[INFO]";  break;
-        case LOG_LEVEL_WARN:  levelStr = "[WARN]";  break;
-        case LOG_LEVEL_ERROR: levelStr = "[ERROR]"; break;
-        case LOG_LEVEL_FATAL: levelStr = "[FATAL]"; break;
-        default:              levelStr = "[UNKNOWN]";
-        }
-        headerParts << levelStr;
+        int index = (record.level >= 0 && record.level <= LOG_LEVEL_DEBUG) ? record.level : 0;
+        out += m_levelTags[index];
     }
 
     // 2. 时间
     if (m_formatConfig.showTime) {
-        QString timeStr = QDateTime::currentDateTime().toString(m_formatConfig.timeFormat);
-        headerParts << timeStr;
+        if (out.size() > start) out += QLatin1Char(' ');
+        appendTimestamp(out, record.timeMs);
     }
 
     // 3. 模块名
-    if (m_formatConfig.showModule && !module.isEmpty()) {
-        headerParts << QString("[%1]").arg(module);
+    if (m_formatConfig.showModule && !record.module.isEmpty()) {
+        if (out.size() > start) out += QLatin1Char(' ');
+        out += QLatin1Char('[');
+        out += record.module;
+        out += QLatin1Char(']');
     }
 
-    // 4. 文件+行号
+    // 4. 文件+行号（文件名已在编译期截取）
     if (m_formatConfig.showFile) {
-        QString filePath = m_formatConfig.showFullFilePath ? file : QFileInfo(file).fileName();
+        if (out.size() > start) out += QLatin1Char(' ');
+        out += QLatin1String(m_formatConfig.showFullFilePath ? record.file : record.fileName);
         if (m_formatConfig.showLine) {
-            headerParts << QString("%1:%2").arg(filePath).arg(line);
-        } else {
-            headerParts << filePath;
+            char lineBuf[16];
+            int len = 0;
+            unsigned int value = static_cast<unsigned int>(qMax(0, record.line));
+            do {
+                lineBuf[len++] = char('0' + value % 10);
+                value /= 10;
+            } while (value > 0);
+            out += QLatin1Char(':');
+            while (len > 0) {
+                out += QLatin1Char(lineBuf[--len]);
+            }
         }
     }
 
-    return headerParts.join(" ") + " | ";
+    out += QLatin1String(" | ");
 }
 
 // ========== 系统日志对接 ==========
@@ -343,47 +550,211 @@ void LogHelper::writeToSystemLog(LogLevel level, const QString& fullMsg)
 #endif
 }
 
-// ========== 核心打印方法 ==========
-void LogHelper::printLog(LogLevel level, const QString& module, const QString& file, int line, const QString& msg)
+// ========== 异步模式 ==========
+void LogHelper::setAsyncMode(bool enable, int bufferCapacity, int flushIntervalMs)
+{
+    QMutexLocker configLocker(&m_asyncConfigMutex);
+    if (enable == m_asyncEnabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    if (enable) {
+        // 队列只创建一次，避免生产者仍持有旧队列时被释放
+        if (!m_asyncBuffer) {
+            m_asyncBuffer = new LogRingBuffer<LogRecord>(static_cast<size_t>(qMax(16, bufferCapacity)));
+        }
+        m_writerThread = new LogWriterThread(this, qMax(1, flushIntervalMs));
+        m_writerThread->start();
+        m_asyncEnabled.store(true, std::memory_order_release);
+    } else {
+        // 先关闭入队，再让写入线程写完剩余日志
+        m_asyncEnabled.store(false, std::memory_order_release);
+        m_writerThread->requestStop();
+        m_writerThread->wait();
+        delete m_writerThread;
+        m_writerThread = nullptr;
+        drainAsyncBuffer(); // 关闭瞬间仍在入队的记录
+    }
+}
+
+bool LogHelper::isAsyncMode() const
 {
+    return m_asyncEnabled.load(std::memory_order_acquire);
+}
+
+void LogHelper::flushAsync()
+{
+    QMutexLocker configLocker(&m_asyncConfigMutex);
+    if (m_writerThread) {
+        m_writerThread->waitFlushed();
+    }
+}
+
+quint64 LogHelper::asyncDroppedCount() const
+{
+    return m_asyncDroppedTotal.load(std::memory_order_relaxed);
+}
+
+bool LogHelper::waitAsyncPush(LogRecord& record)
+{
+    // 最长等待时间：足够写入线程写出一批，又不至于让调用方长时间卡住
+    const qint64 maxWaitMs = 50;
+    // 配置锁被占用时写入线程正在刷新或停止，无需再唤醒
+    if (m_asyncConfigMutex.tryLock()) {
+        if (m_writerThread) {
+            m_writerThread->wakeUp();
+        }
+        m_asyncConfigMutex.unlock();
+    }
+    // GUI线程不等待：持续满载时每条日志都卡顿50ms，直接丢弃并计数
+    QCoreApplication *app = QCoreApplication::instance();
+    if (app && QThread::currentThread() == app->thread()) {
+        return false;
+    }
+    QElapsedTimer timer;
+    timer.start();
+    while (m_asyncEnabled.load(std::memory_order_acquire) && timer.elapsed() < maxWaitMs) {
+        QThread::usleep(200);
+        if (m_asyncBuffer->tryPush(std::move(record))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int LogHelper::drainAsyncBuffer()
+{
+    if (!m_asyncBuffer) {
+        return 0;
+    }
+
+    // 单次最多处理一批，避免长时间占用m_logMutex阻塞配置修改
+    const int maxBatch = 1024;
+    QString batch;
+    int count = 0;
+    LogRecord record;
+
     QMutexLocker locker(&m_logMutex);
+    while (count < maxBatch && m_asyncBuffer->tryPop(record)) {
+        writeRecordLocked(record, &batch);
+        count++;
+    }
+    // 队列满丢弃的日志：在当前写出位置补一条告警，不打乱已入队日志的顺序
+    quint64 dropped = m_asyncDropped.exchange(0, std::memory_order_relaxed);
+    if (dropped > 0) {
+        LogRecord notice;
+        notice.level = LOG_LEVEL_WARN;
+        notice.module = "日志模块";
+        notice.file = __FILE__;
+        notice.fileName = LOG_FILE_NAME;
+        notice.line = __LINE__;
+        notice.msg = QString("异步日志队列已满，已丢弃%1条日志").arg(dropped);
+        notice.timeMs = QDateTime::currentMSecsSinceEpoch();
+        writeRecordLocked(notice, &batch);
+    }
+    if (!batch.isEmpty()) {
+        writeFileLocked(batch);
+    }
+    return count;
+}
 
-    // 1. 级别过滤（基础过滤）
-    if (level > m_logLevel || m_logLevel == LOG_LEVEL_OFF) {
+// 过滤、格式化并输出单条记录（调用方持有m_logMutex）
+void LogHelper::writeRecordLocked(const LogRecord& record, QString* batch)
+{
+    // 1. 级别过滤（基础过滤，配置可能在入队后变化）
+    LogLevel logLevel = getLogLevel();
+    if (record.level > logLevel || logLevel == LOG_LEVEL_OFF) {
         return;
     }
 
     // 2. 关键词/模块过滤
-    if (!filterLog(module, msg)) {
+    if (!filterLog(record.module, record.msg)) {
         return;
     }
 
     // 3. 构建自定义格式日志
-    QString header = buildLogHeader(level, module, file, line);
-    QString fullMsg = header + msg;
+    QString fullMsg;
+    fullMsg.reserve(96 + record.module.size() + record.msg.size());
+    buildLogHeader(fullMsg, record);
+    fullMsg += record.msg;
 
-    // 4. 控制台输出
-    switch (level) {
+    // 4. 控制台输出（FATAL在落盘后再终止程序）
+    switch (record.level) {
     case LOG_LEVEL_DEBUG: qDebug().noquote() << fullMsg; break;
     case LOG_LEVEL_INFO:  qInfo().noquote()  << fullMsg; break;
     case LOG_LEVEL_WARN:  qWarning().noquote()<< fullMsg; break;
     case LOG_LEVEL_ERROR: qCritical().noquote()<< fullMsg; break;
-    case LOG_LEVEL_FATAL: qFatal("%s", fullMsg.toUtf8().constData()); break;
+    case LOG_LEVEL_FATAL: break;
     default: qDebug().noquote() << fullMsg;
     }
 
     // 5. 系统日志输出
-    writeToSystemLog(level, fullMsg);
+    writeToSystemLog(record.level, fullMsg);
+
+    // 6. 文件输出：异步批量时先攒批
+    if (batch) {
+        batch->append(fullMsg).append('\n');
+    } else {
+        writeFileLocked(fullMsg + "\n");
+    }
+
+    if (record.level == LOG_LEVEL_FATAL) {
+        qFatal("%s", fullMsg.toUtf8().constData());
+    }
+}
 
-    // 6. 文件输出（先检查分割）
+void LogHelper::writeFileLocked(const QString& content)
+{
     if (m_logFile && m_logFile->isOpen()) {
         checkAndSplitLogFile(); // 检查是否需要分割
 
         QTextStream stream(m_logFile);
-        stream << fullMsg << "\n";
+        stream << content;
         stream.flush();
 
         // 更新文件大小
         m_logFileSize = m_logFile->size();
     }
 }
+
+// ========== 核心打印方法 ==========
+void LogHelper::printLog(LogLevel level, const QString& module, const char* file, const char* fileName, int line, const QString& msg)
+{
+    // 1. 级别过滤（无锁）
+    LogLevel logLevel = getLogLevel();
+    if (level > logLevel || logLevel == LOG_LEVEL_OFF) {
+        return;
+    }
+
+    LogRecord record;
+    record.level = level;
+    record.module = module;
+    record.file = file;
+    record.fileName = fileName;
+    record.line = line;
+    record.msg = msg;
+    record.timeMs = QDateTime::currentMSecsSinceEpoch();
+
+    if (m_asyncEnabled.load(std::memory_order_acquire)) {
+        // 2. 异步模式：入队即返回（仅在成功时转移记录）
+        // 队列满时不绕过队列直接写文件（会与队列中较早的日志乱序），限时等待仍满则丢弃并计数
+        if (level != LOG_LEVEL_FATAL) {
+            if (m_asyncBuffer->tryPush(std::move(record)) || waitAsyncPush(record)) {
+                return;
+            }
+            if (m_asyncEnabled.load(std::memory_order_acquire)) {
+                m_asyncDropped.fetch_add(1, std::memory_order_relaxed);
+                m_asyncDroppedTotal.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            // 等待期间异步模式已关闭：写入线程已写完队列，同步写入不会乱序
+        } else {
+            // FATAL：先写出已入队的日志，保证终止前日志完整有序
+            flushAsync();
+        }
+    }
+
+    // 3. 同步写入
+    QMutexLocker locker(&m_logMutex);
+    writeRecordLocked(record, nullptr);
+}
@@ -9,6 +9,13 @@
 #include <QDateTime>
 #include <QSet>
 #include <QRegularExpression>
+#include <QAtomicInt>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include "logringbuffer.h"
+#include "logkeywordmatcher.h"
+#include "logarchiver.h"
 
 // ========== 基础日志级别 ==========
 enum LogLevel {
@@ -54,6 +61,36 @@ struct LogFormatConfig {
     QString timeFormat = "yyyy-MM-dd hh:mm:ss.zzz"; // 时间格式
 };
 
+// ========== 新增：异步模式下的日志记录（调用方只采集，写入线程负责过滤/格式化/落盘） ==========
+struct LogRecord {
+    LogLevel level = LOG_LEVEL_DEBUG;
+    QString module;
+    const char* file = "";       // __FILE__ 全路径（字符串字面量，无需拷贝）
+    const char* fileName = "";   // 编译期截取的文件名
+    int line = 0;
+    QString msg;
+    qint64 timeMs = 0;           // 调用时刻（毫秒时间戳，写入可能延后）
+};
+
+// ========== 新增：编译期截取 __FILE__ 的文件名部分 ==========
+// 返回最后一个路径分隔符之后的偏移（C++11 constexpr 只能单条return，故用递归）
+constexpr std::size_t logFileNameOffset(const char* path, std::size_t pos = 0, std::size_t last = 0)
+{
+    return path[pos] == '\0' ? last
+         : logFileNameOffset(path, pos + 1, (path[pos] == '/' || path[pos] == '\\') ? pos + 1 : last);
+}
+// 通过模板实参强制在编译期求值
+#define LOG_FILE_NAME (__FILE__ + std::integral_constant<std::size_t, logFileNameOffset(__FILE__)>::value)
+
+// ========== 新增：模块过滤快照（发布后只读，供调用方无锁预判） ==========
+struct LogModuleFilter {
+    LogFilterMode mode = FILTER_BLACK_LIST;
+    QSet<QString> modules;
+    bool hasKeywords = false;    // 有关键词规则时，模块未命中仍需看消息内容
+};
+
+class LogWriterThread;
+
 /**
  * @brief 日志工具类（单例模式）
  * 扩展功能：
@@ -61,6 +98,7 @@ struct LogFormatConfig {
  * 2. 日志过滤（关键词/模块，白名单/黑名单）
  * 3. 自定义输出格式
  * 4. 对接系统日志（Windows事件日志/Linux syslog）
+ * 5. 异步模式（无锁环形队列 + 独立写入线程批量落盘，FATAL始终同步）
  */
 class LogHelper
 {
@@ -78,6 +116,8 @@ public:
     void setLogSplitRule(LogSplitType type,
                          qint64 maxSizeMB = 100,  // 按大小分割：阈值(MB)
                          LogTimeSplitUnit timeUnit = SPLIT_DAY); // 按时间分割：单位
+    // 设置分割文件的归档策略：后台压缩为.gz，并按总大小/保留天数清理（0=不限）
+    void setLogRetention(bool compress, qint64 maxTotalMB = 0, int maxAgeDays = 0);
     // ========== 日志过滤配置 ==========
     // 设置过滤模式（白名单/黑名单）
     void setFilterMode(LogFilterMode mode);
@@ -95,15 +135,31 @@ public:
     // ========== 系统日志对接 ==========
     // 启用/禁用系统日志输出（Windows事件日志/Linux syslog）
     void enableSystemLog(bool enable);
+    // ========== 异步模式 ==========
+    // 启用后调用方仅入队，写入线程每flushIntervalMs批量写出；
+    // 队列满时唤醒写入线程：工作线程最多等待50ms重试入队，GUI线程不等待（避免界面卡顿），
+    // 仍满则丢弃该条并计数，由写入线程补写一条告警
+    void setAsyncMode(bool enable, int bufferCapacity = 8192, int flushIntervalMs = 200);
+    bool isAsyncMode() const;
+    // 等待已入队的日志全部写出
+    void flushAsync();
+    // 异步模式下因队列满被丢弃的日志累计条数
+    quint64 asyncDroppedCount() const;
 
     // ========== 日志打印核心方法（支持模块名） ==========
-    void printLog(LogLevel level, const QString& module, const QString& file, int line, const QString& msg);
+    // 仅按级别预判（一次原子读取，无内存分配），供日志宏在构造模块名之前调用
+    bool isLevelEnabled(LogLevel level) const { return level <= getLogLevel(); }
+    // 构造消息前的廉价预判：级别 + 模块黑白名单（无锁）；返回false表示该日志必然被过滤
+    bool shouldLog(LogLevel level, const QString& module) const;
+    // file为__FILE__，fileName为LOG_FILE_NAME（均需为静态字符串）
+    void printLog(LogLevel level, const QString& module, const char* file, const char* fileName, int line, const QString& msg);
 
 private:
     LogHelper();
     ~LogHelper();
     LogHelper(const LogHelper&) = delete;
     LogHelper& operator=(const LogHelper&) = delete;
+    friend class LogWriterThread;
 
     // ========== 内部辅助方法 ==========
     // 检查并分割日志文件（内部调用）
@@ -112,14 +168,28 @@ private:
     QString generateSplitFileName();
     // 过滤日志（返回true=需要打印，false=过滤掉）
     bool filterLog(const QString& module, const QString& msg);
-    // 拼接自定义格式的日志头部
-    QString buildLogHeader(LogLevel level, const QString& module, const QString& file, int line);
+    // 过滤规则变化后发布新的模块过滤快照（需持有m_logMutex）
+    void publishModuleFilter();
+    // 拼接自定义格式的日志头部（追加到out，按预计算模板拼接）
+    void buildLogHeader(QString& out, const LogRecord& record);
+    // 追加时间戳：同一秒内复用缓存的格式化结果，仅改写毫秒
+    void appendTimestamp(QString& out, qint64 timeMs);
+    // 根据格式配置预计算头部模板（需持有m_logMutex）
+    void rebuildHeaderTemplate();
     // 输出到系统日志（Windows/Linux 分别实现）
     void writeToSystemLog(LogLevel level, const QString& fullMsg);
+    // 过滤+格式化+输出一条记录（需持有m_logMutex）；batch非空时文件内容先攒到batch
+    void writeRecordLocked(const LogRecord& record, QString* batch);
+    // 把攒批内容一次写入文件（需持有m_logMutex）
+    void writeFileLocked(const QString& content);
+    // 写入线程：取出队列中的记录批量写出，返回处理条数
+    int drainAsyncBuffer();
+    // 队列满时唤醒写入线程，非GUI线程在限时内重试入队，成功返回true（失败时record保持不变）
+    bool waitAsyncPush(LogRecord& record);
 
     // ========== 成员变量 ==========
     // 基础配置
-    LogLevel  m_logLevel = LOG_LEVEL_DEBUG;
+    QAtomicInt m_logLevel {LOG_LEVEL_DEBUG}; // 原子读取，级别判断无需加锁
     mutable QMutex m_logMutex;
     // 文件配置
     QString   m_logFilePath;
@@ -130,58 +200,117 @@ private:
     qint64    m_maxSizeMB = 100; // 最大文件大小（MB）
     LogTimeSplitUnit m_timeUnit = SPLIT_DAY;
     QDateTime m_lastSplitTime;   // 上次分割时间
+    // 归档配置（调用setLogRetention后启用）
+    LogRetentionPolicy m_retentionPolicy;
+    LogArchiver* m_archiver = nullptr;
     // 过滤配置
     LogFilterMode m_filterMode = FILTER_BLACK_LIST;
     QSet<QString> m_filterKeywords; // 过滤关键词
     QSet<QRegularExpression> m_regexKeywords; // 正则关键词
+    LogKeywordMatcher m_keywordMatcher; // 由上面两组关键词预编译，关键词变化时重建
     QSet<QString> m_filterModules;  // 过滤模块
+    std::atomic<const LogModuleFilter*> m_moduleFilter {nullptr}; // 当前快照
+    QList<const LogModuleFilter*> m_retiredFilters;  // 旧快照（调用方可能仍在读，析构时统一释放）
     // 格式配置
     LogFormatConfig m_formatConfig;
+    // 头部模板（由m_formatConfig预计算）
+    QString   m_levelTags[LOG_LEVEL_DEBUG + 1]; // "[DEBUG]"等级别标签
+    QString   m_timePrefixFormat;  // 时间格式中毫秒(zzz)之前的部分
+    QString   m_timeSuffixFormat;  // 时间格式中毫秒之后的部分
+    bool      m_timeHasMillis = false; // 时间格式是否含唯一的zzz
+    bool      m_timeCacheable = true;  // 时间格式是否可按秒缓存（不含其他毫秒字段）
+    // 时间戳缓存（格式化在m_logMutex内串行执行，缓存随之受保护）
+    qint64    m_cachedSecond = -1;
+    QString   m_cachedTimePrefix;
+    QString   m_cachedTimeSuffix;
     // 系统日志配置
     bool      m_enableSystemLog = false;
+    // 异步模式
+    std::atomic<bool> m_asyncEnabled {false};
+    LogRingBuffer<LogRecord>* m_asyncBuffer = nullptr; // 首次启用时创建，生命周期同单例
+    LogWriterThread* m_writerThread = nullptr;
+    QMutex m_asyncConfigMutex;                          // 保护异步模式开关
+    std::atomic<quint64> m_asyncDropped {0};            // 待告警的丢弃条数（写入线程取走后清零）
+    std::atomic<quint64> m_asyncDroppedTotal {0};       // 累计丢弃条数
 };
 
 // ========== 日志宏封装（新增模块参数） ==========
+// 编译期最低级别：高于该级别的日志宏展开为空，不参与编译也无运行开销
+// 可在.pro中通过 DEFINES += LOG_COMPILE_LEVEL=3 覆盖（数值同LogLevel）
+#ifndef LOG_COMPILE_LEVEL
 #ifdef QT_DEBUG
+#define LOG_COMPILE_LEVEL 5 // LOG_LEVEL_DEBUG
+#else
+#define LOG_COMPILE_LEVEL 4 // LOG_LEVEL_INFO
+#endif
+#endif
+static_assert(LOG_LEVEL_DEBUG == 5 && LOG_LEVEL_ERROR == 2, "LOG_COMPILE_LEVEL依赖LogLevel的数值");
+
+// 先按级别预判（不构造模块名QString），再做模块预判，通过后才构造消息
+#if LOG_COMPILE_LEVEL >= 5
 #define LOG_DEBUG(module, content) \
     do { \
-        if (LogHelper::instance().getLogLevel() >= LOG_LEVEL_DEBUG) { \
-            QString msg; QDebug(&msg) << content; \
-            LogHelper::instance().printLog(LOG_LEVEL_DEBUG, module, __FILE__, __LINE__, msg); \
+        if (LogHelper::instance().isLevelEnabled(LOG_LEVEL_DEBUG)) { \
+            const QString logModule_(module); \
+            if (LogHelper::instance().shouldLog(LOG_LEVEL_DEBUG, logModule_)) { \
+                QString msg; QDebug(&msg) << content; \
+                LogHelper::instance().printLog(LOG_LEVEL_DEBUG, logModule_, __FILE__, LOG_FILE_NAME, __LINE__, msg); \
+            } \
         } \
     } while(0)
 #else
 #define LOG_DEBUG(module, content) ((void)0)
 #endif
 
+#if LOG_COMPILE_LEVEL >= 4
 #define LOG_INFO(module, content) \
     do { \
-        if (LogHelper::instance().getLogLevel() >= LOG_LEVEL_INFO) { \
-            QString msg; QDebug(&msg) << content; \
-            LogHelper::instance().printLog(LOG_LEVEL_INFO, module, __FILE__, __LINE__, msg); \
+        if (LogHelper::instance().isLevelEnabled(LOG_LEVEL_INFO)) { \
+            const QString logModule_(module); \
+            if (LogHelper::instance().shouldLog(LOG_LEVEL_INFO, logModule_)) { \
+                QString msg; QDebug(&msg) << content; \
+                LogHelper::instance().printLog(LOG_LEVEL_INFO, logModule_, __FILE__, LOG_FILE_NAME, __LINE__, msg); \
+            } \
         } \
     } while(0)
+#else
+#define LOG_INFO(module, content) ((void)0)
+#endif
 
+#if LOG_COMPILE_LEVEL >= 3
 #define LOG_WARN(module, content) \
     do { \
-        if (LogHelper::instance().getLogLevel() >= LOG_LEVEL_WARN) { \
-            QString msg; QDebug(&msg) << content; \
-            LogHelper::instance().printLog(LOG_LEVEL_WARN, module, __FILE__, __LINE__, msg); \
+        if (LogHelper::instance().isLevelEnabled(LOG_LEVEL_WARN)) { \
+            const QString logModule_(module); \
+            if (LogHelper::instance().shouldLog(LOG_LEVEL_WARN, logModule_)) { \
+                QString msg; QDebug(&msg) << content; \
+                LogHelper::instance().printLog(LOG_LEVEL_WARN, logModule_, __FILE__, LOG_FILE_NAME, __LINE__, msg); \
+            } \
         } \
     } while(0)
+#else
+#define LOG_WARN(module, content) ((void)0)
+#endif
 
+#if LOG_COMPILE_LEVEL >= 2
 #define LOG_ERROR(module, content) \
     do { \
-        if (LogHelper::instance().getLogLevel() >= LOG_LEVEL_ERROR) { \
-            QString msg; QDebug(&msg) << content; \
-            LogHelper::instance().printLog(LOG_LEVEL_ERROR, module, __FILE__, __LINE__, msg); \
+        if (LogHelper::instance().isLevelEnabled(LOG_LEVEL_ERROR)) { \
+            const QString logModule_(module); \
+            if (LogHelper::instance().shouldLog(LOG_LEVEL_ERROR, logModule_)) { \
+                QString msg; QDebug(&msg) << content; \
+                LogHelper::instance().printLog(LOG_LEVEL_ERROR, logModule_, __FILE__, LOG_FILE_NAME, __LINE__, msg); \
+            } \
         } \
     } while(0)
+#else
+#define LOG_ERROR(module, content) ((void)0)
+#endif
 
 #define LOG_FATAL(module, content) \
     do { \
         QString msg; QDebug(&msg) << content; \
-        LogHelper::instance().printLog(LOG_LEVEL_FATAL, module, __FILE__, __LINE__, msg); \
+        LogHelper::instance().printLog(LOG_LEVEL_FATAL, module, __FILE__, LOG_FILE_NAME, __LINE__, msg); \
         abort(); \
     } while(0)
 
@@ -202,6 +331,12 @@ private:
         LogHelper::instance().setLogSplitRule(type, maxSizeMB, timeUnit); \
     } while(0)
 
+// 设置分割文件归档策略（是否压缩、总大小上限MB、保留天数）
+#define SET_LOG_RETENTION(compress, maxTotalMB, maxAgeDays) \
+    do { \
+        LogHelper::instance().setLogRetention(compress, maxTotalMB, maxAgeDays); \
+    } while(0)
+
 // 设置过滤模式
 #define SET_LOG_FILTER_MODE(mode) \
     do { \
@@ -232,4 +367,10 @@ private:
         LogHelper::instance().enableSystemLog(enable); \
     } while(0)
 
+// 启用异步日志（队列容量、刷新间隔毫秒）
+#define SET_LOG_ASYNC(enable, capacity, flushIntervalMs) \
+    do { \
+        LogHelper::instance().setAsyncMode(enable, capacity, flushIntervalMs); \
+    } while(0)
+
 #endif // LOGHELPER_H
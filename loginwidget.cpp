@@ -237,10 +237,8 @@ void LoginWidget::slot_loginCheck()
 
     // 获取客户端IP（支持IPv4/IPv6）
     QString ip = IPHelper::getLocalIP();
-    // 从sys_user表查询当前用户ID（必须非空，因为表中user_id字段NOT NULL）
-    int UUID = userDbHelper.getUserUUIDByPhone(strPhone).toInt();
 
-    // 分支1：密码登录
+    // 分支1：密码登录（异步校验，等待期间禁用登录按钮）
     if(m_rBtnPwdLogin->isChecked())
     {
         QString strPwd = m_editPwd->text().trimmed();
@@ -249,26 +247,29 @@ void LoginWidget::slot_loginCheck()
             QMessageBox::warning(this, "登录失败", "请输入登录密码！");
             return;
         }
-        // 示例：手机号13800138000 + 密码123456 视为登录成功
-        if(userDbHelper.userLogin(strPhone, strPwd))
-        {
-            m_bLoginSuccess = true;
-            m_curLoginPhone = strPhone; // ====== 赋值当前登录手机号 ======
-            // 登录成功：记录INFO级别日志
-            ADD_BASE_LOG("登录模块",
-                         QString("用户[%1]登录成功，登录时间：%2").arg(strPhone).arg(QDateTime::currentDateTime().toString()),
-                         userDbHelper.getUserUUIDByPhone(strPhone).toInt(),
-                         "login",
-                         IPHelper::getLocalIP());
-//            QMessageBox::information(this, "登录成功", "密码登录成功，即将进入主界面！");
-            this->accept(); // 新增这一行，设置对话框的返回值为 Accepted
-            this->close(); // 关闭登录窗口
-        }
-        else
-        {
-            QMessageBox::warning(this, "登录失败", "手机号或密码错误，请重试！");
-            m_editPwd->clear();
-        }
+        m_btnLogin->setEnabled(false);
+        userDbHelper.userLoginAsync(strPhone, strPwd, this, [this, strPhone, ip](bool ok, int UUID) {
+            m_btnLogin->setEnabled(true);
+            if(ok)
+            {
+                m_bLoginSuccess = true;
+                m_curLoginPhone = strPhone; // ====== 赋值当前登录手机号 ======
+                // 登录成功：记录INFO级别日志
+                ADD_BASE_LOG("登录模块",
+                             QString("用户[%1]登录成功，登录时间：%2").arg(strPhone).arg(QDateTime::currentDateTime().toString()),
+                             UUID,
+                             "login",
+                             ip);
+//                QMessageBox::information(this, "登录成功", "密码登录成功，即将进入主界面！");
+                this->accept(); // 新增这一行，设置对话框的返回值为 Accepted
+                this->close(); // 关闭登录窗口
+            }
+            else
+            {
+                QMessageBox::warning(this, "登录失败", "手机号或密码错误，请重试！");
+                m_editPwd->clear();
+            }
+        });
     }
     // 分支2：验证码登录
     else
@@ -282,6 +283,8 @@ void LoginWidget::slot_loginCheck()
         // ========== 此处替换为你的真实验证码校验逻辑 ==========
         if(strCode == m_strCurCode && userDbHelper.checkPhoneExist(strPhone))
         {
+            // 从sys_user表查询当前用户ID（必须非空，因为表中user_id字段NOT NULL）
+            int UUID = userDbHelper.getUserUUIDByPhone(strPhone).toInt();
             m_bLoginSuccess = true;
             m_curLoginPhone = strPhone; // ====== 新增：赋值当前登录手机号 ======
             // 登录成功：记录INFO级别日志
@@ -0,0 +1,175 @@
+#include "logkeywordmatcher.h"
+#include <QQueue>
+
+LogKeywordMatcher::LogKeywordMatcher()
+{
+    m_nodes.append(Node()); // 根节点
+}
+
+void LogKeywordMatcher::rebuild(const QSet<QString>& keywords, const QSet<QRegularExpression>& regexes)
+{
+    buildAutomaton(keywords);
+    buildRegex(regexes);
+}
+
+bool LogKeywordMatcher::isEmpty() const
+{
+    return !m_hasLiterals && !m_matchAll && !m_hasCombinedRegex && m_fallbackRegexes.isEmpty();
+}
+
+bool LogKeywordMatcher::matches(const QString& text) const
+{
+    if (m_matchAll) {
+        return true;
+    }
+    if (m_hasLiterals && matchLiteral(text)) {
+        return true;
+    }
+    if (m_hasCombinedRegex && m_combinedRegex.match(text).hasMatch()) {
+        return true;
+    }
+    for (const QRegularExpression& re : m_fallbackRegexes) {
+        if (re.match(text).hasMatch()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// ========== Aho-Corasick ==========
+quint64 LogKeywordMatcher::edgeKey(int state, ushort ch)
+{
+    return (quint64(state) << 16) | ch;
+}
+
+int LogKeywordMatcher::transition(int state, ushort ch) const
+{
+    return m_edges.value(edgeKey(state, ch), -1);
+}
+
+void LogKeywordMatcher::buildAutomaton(const QSet<QString>& keywords)
+{
+    m_nodes.clear();
+    m_nodes.append(Node());
+    m_edges.clear();
+    m_matchAll = false;
+    m_hasLiterals = false;
+
+    // 1. 建字典树（字符做大小写折叠，与 contains(..., Qt::CaseInsensitive) 一致）
+    for (const QString& keyword : keywords) {
+        if (keyword.isEmpty()) {
+            m_matchAll = true;
+            continue;
+        }
+        int state = 0;
+        for (QChar c : keyword) {
+            ushort ch = c.toCaseFolded().unicode();
+            int next = transition(state, ch);
+            if (next < 0) {
+                next = m_nodes.size();
+                m_nodes.append(Node());
+                m_edges.insert(edgeKey(state, ch), next);
+            }
+            state = next;
+        }
+        m_nodes[state].output = true;
+        m_hasLiterals = true;
+    }
+    if (!m_hasLiterals) {
+        return;
+    }
+
+    // 2. 按层次计算失配指针，并把后缀的输出标记合并到当前节点
+    QVector<QVector<QPair<ushort, int>>> children(m_nodes.size());
+    for (auto it = m_edges.constBegin(); it != m_edges.constEnd(); ++it) {
+        int parent = int(it.key() >> 16);
+        children[parent].append(qMakePair(ushort(it.key() & 0xFFFF), it.value()));
+    }
+
+    QQueue<int> queue;
+    for (const auto& edge : children[0]) {
+        m_nodes[edge.second].fail = 0;
+        queue.enqueue(edge.second);
+    }
+    while (!queue.isEmpty()) {
+        int state = queue.dequeue();
+        for (const auto& edge : children[state]) {
+            int child = edge.second;
+            int fail = m_nodes[state].fail;
+            int target = transition(fail, edge.first);
+            while (target < 0 && fail != 0) {
+                fail = m_nodes[fail].fail;
+                target = transition(fail, edge.first);
+            }
+            m_nodes[child].fail = (target >= 0 && target != child) ? target : 0;
+            m_nodes[child].output = m_nodes[child].output || m_nodes[m_nodes[child].fail].output;
+            queue.enqueue(child);
+        }
+    }
+}
+
+bool LogKeywordMatcher::matchLiteral(const QString& text) const
+{
+    int state = 0;
+    for (QChar c : text) {
+        ushort ch = c.toCaseFolded().unicode();
+        int next = transition(state, ch);
+        while (next < 0 && state != 0) {
+            state = m_nodes[state].fail;
+            next = transition(state, ch);
+        }
+        state = (next >= 0) ? next : 0;
+        if (m_nodes[state].output) {
+            return true; // 只关心是否命中，遇到第一个即返回
+        }
+    }
+    return false;
+}
+
+// ========== 正则合并 ==========
+void LogKeywordMatcher::buildRegex(const QSet<QRegularExpression>& regexes)
+{
+    m_combinedRegex = QRegularExpression();
+    m_hasCombinedRegex = false;
+    m_fallbackRegexes.clear();
+
+    // 含编号/命名反向引用或递归的正则合并后组号会错位，单独匹配
+    static const QRegularExpression groupReference(
+        R"(\\[1-9]|\\g|\\k|\(\?(P=|P>|&|R|[0-9+-]))");
+
+    QStringList alternatives;
+    QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption;
+    bool optionsSet = false;
+    for (const QRegularExpression& re : regexes) {
+        if (!re.isValid()) {
+            continue; // 无效正则永远不会命中
+        }
+        bool sameOptions = !optionsSet || re.patternOptions() == options;
+        if (!sameOptions || groupReference.match(re.pattern()).hasMatch()) {
+            m_fallbackRegexes.append(re);
+            continue;
+        }
+        options = re.patternOptions();
+        optionsSet = true;
+        alternatives << QString("(?:%1)").arg(re.pattern());
+    }
+    if (alternatives.isEmpty()) {
+        return;
+    }
+
+    QRegularExpression combined(alternatives.join('|'), options);
+    if (!combined.isValid()) {
+        // 合并失败（理论上不会发生）：退回逐个匹配
+        for (const QRegularExpression& re : regexes) {
+            if (re.isValid() && !m_fallbackRegexes.contains(re)) {
+                m_fallbackRegexes.append(re);
+            }
+        }
+        return;
+    }
+#if QT_VERSION < QT_VERSION_CHECK(5, 12, 0)
+    combined.optimize(); // 5.12起默认即时编译
+#endif
+    m_combinedRegex = combined;
+    m_hasCombinedRegex = true;
+}
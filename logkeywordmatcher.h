@@ -0,0 +1,52 @@
+#ifndef LOGKEYWORDMATCHER_H
+#define LOGKEYWORDMATCHER_H
+
+#include <QString>
+#include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QRegularExpression>
+
+/**
+ * @brief 日志关键词多模式匹配器
+ * 普通关键词编译为Aho-Corasick自动机（大小写不敏感，按QChar折叠），
+ * 正则关键词合并为一个 (?:p1)|(?:p2)... 的正则；
+ * 单次匹配只扫描消息一遍，耗时与关键词数量基本无关。
+ * 非线程安全：由LogHelper在m_logMutex内重建和使用。
+ */
+class LogKeywordMatcher
+{
+public:
+    LogKeywordMatcher();
+
+    // 关键词变化后重建（仅在配置时调用）
+    void rebuild(const QSet<QString>& keywords, const QSet<QRegularExpression>& regexes);
+    // 消息是否命中任一关键词或正则
+    bool matches(const QString& text) const;
+    bool isEmpty() const;
+
+private:
+    struct Node {
+        int fail = 0;          // 失配跳转
+        bool output = false;   // 自身或后缀为某个关键词结尾
+    };
+
+    void buildAutomaton(const QSet<QString>& keywords);
+    void buildRegex(const QSet<QRegularExpression>& regexes);
+    bool matchLiteral(const QString& text) const;
+    // 状态转移（key = 状态 << 16 | 折叠后的字符）
+    int transition(int state, ushort ch) const;
+    static quint64 edgeKey(int state, ushort ch);
+
+    QVector<Node> m_nodes;
+    QHash<quint64, int> m_edges;
+    bool m_hasLiterals = false;
+    bool m_matchAll = false;   // 含空关键词：与QString::contains("")一致，全部命中
+
+    QRegularExpression m_combinedRegex;      // 合并后的正则
+    bool m_hasCombinedRegex = false;
+    QList<QRegularExpression> m_fallbackRegexes; // 无法安全合并的正则（反向引用/选项不同）
+};
+
+#endif // LOGKEYWORDMATCHER_H
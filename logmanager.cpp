@@ -1,5 +1,6 @@
 #include "logmanager.h"
 #include "logdbhelper.h"
+#include "auditlogwriter.h"
 #include <QDebug>
 
 LogManager* LogManager::m_instance = nullptr;
@@ -17,9 +18,31 @@ LogManager* LogManager::getInstance()
     return m_instance;
 }
 
-LogManager::LogManager() {}
+// 日志级别转换（与表中log_level值对应）
+static QString levelToString(LogManager::LogLevel level)
+{
+    switch (level) {
+    case LogManager::Info: return "INFO";
+    case LogManager::Warning: return "WARNING";
+    case LogManager::Error: return "ERROR";
+    case LogManager::Debug: return "DEBUG";
+    default: return "INFO";
+    }
+}
 
-// 扩展接口实现：移除operatorName参数
+LogManager::LogManager()
+{
+    m_writer = new AuditLogWriter();
+    m_writer->start();
+}
+
+LogManager::~LogManager()
+{
+    shutdown();
+    delete m_writer;
+}
+
+// 扩展接口实现：仅入队，由后台线程批量写库
 void LogManager::addLog(const QString& moduleName,
                         const QString& operation,
                         LogLevel level,
@@ -27,11 +50,35 @@ void LogManager::addLog(const QString& moduleName,
                         const QString& operation_type,
                         const QString& ip_address)
 {
-    QDateTime logTime = QDateTime::currentDateTime();
-    bool success = saveLogToDb(moduleName, operation, level, user_id, operation_type, ip_address, logTime);
-    if (!success) {
-        qWarning() << QString("日志保存失败：模块[%1] 用户ID[%2]").arg(moduleName).arg(user_id);
+    SysLogRecord record;
+    record.user_id = user_id;
+    record.operation_type = operation_type;
+    record.operation_content = operation;
+    record.ip_address = ip_address;
+    record.log_level = levelToString(level);
+    record.module_name = moduleName;
+    record.create_time = QDateTime::currentDateTime();
+
+    if (m_writer->enqueue(record)) {
+        return;
     }
+    // 写入线程已停止（程序退出阶段）：同步写入兜底
+    if (!m_writer->isRunning()) {
+        bool success = saveLogToDb(moduleName, operation, level, user_id, operation_type, ip_address, record.create_time);
+        if (!success) {
+            qWarning() << QString("日志保存失败：模块[%1] 用户ID[%2]").arg(moduleName).arg(user_id);
+        }
+    }
+}
+
+void LogManager::flush()
+{
+    m_writer->flush();
+}
+
+void LogManager::shutdown()
+{
+    m_writer->stop();
 }
 
 // 数据库保存逻辑：适配最终表字段
@@ -45,21 +92,11 @@ bool LogManager::saveLogToDb(const QString& moduleName,
 {
     LogDbHelper dbHelper;
 
-    // 日志级别转换（与表中log_level值对应）
-    QString levelStr;
-    switch (level) {
-    case Info: levelStr = "INFO"; break;
-    case Warning: levelStr = "WARNING"; break;
-    case Error: levelStr = "ERROR"; break;
-    case Debug: levelStr = "DEBUG"; break;
-    default: levelStr = "INFO";
-    }
-
     // 调用数据库层插入方法
     return dbHelper.insertLog(user_id,
                               operation_type,
                               operation,
                               ip_address,
-                              levelStr,
+                              levelToString(level),
                               moduleName);
 }
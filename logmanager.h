@@ -5,6 +5,8 @@
 #include <QDateTime>
 #include <QMutex>
 
+class AuditLogWriter;
+
 class LogManager
 {
 public:
@@ -26,9 +28,14 @@ public:
                 const QString& operation_type = "", // 操作类型（operation_type）
                 const QString& ip_address = ""); // IP地址（ip_address，支持IPv4/IPv6）
 
+    // 等待已提交的日志全部写入数据库
+    void flush();
+    // 程序退出前调用：写完剩余日志并停止后台写入线程，之后addLog退化为同步写入
+    void shutdown();
+
 private:
     LogManager();
-    ~LogManager() = default;
+    ~LogManager();
     LogManager(const LogManager&) = delete;
     LogManager& operator=(const LogManager&) = delete;
 
@@ -43,6 +50,8 @@ private:
 
     static LogManager* m_instance;
     static QMutex m_mutex;
+
+    AuditLogWriter* m_writer; // 后台批量写入线程
 };
 
 // 简化调用宏（适配新接口）
@@ -1,6 +1,7 @@
 #include "logtablewidget.h"
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include "loghelper.h"
 #include <QMessageBox>
 #include "logdbhelper.h"
@@ -52,30 +53,35 @@ void LogTableWidget::loadTableData()
     // SELECT l.log_id, u.username, l.operation_type, l.log_level, l.module_name, l.operation_content, l.ip_address, l.create_time
     // FROM sys_log l LEFT JOIN sys_user u ON l.user_id = u.id
     // WHERE 你的筛选条件（如UUID相关）
-    QSqlQuery query;
-    if(UserSession::instance()->userRole() == "超级管理员") {
-        query = logDbHelper.getAllLogList();
-    }else {
-        query = logDbHelper.getAllLogList(UserSession::instance()->userId());
-    }
-
-    LOG_DEBUG("用户信息模块", "查询到日志条数：" << query.size());
-
-    int row = 0;
-    while(query.next())
-    {
-        m_tableWidget->insertRow(row);
-        // 字段索引映射（与上述SQL查询字段顺序严格对应）：
-        m_tableWidget->setItem(row, 0, new QTableWidgetItem(QString::number(query.value(0).toInt()))); // 0: log_id
-        m_tableWidget->setItem(row, 1, new QTableWidgetItem(query.value(1).toString()));              // 1: username(操作者)
-        m_tableWidget->setItem(row, 2, new QTableWidgetItem(query.value(2).toString()));              // 2: operation_type
-        m_tableWidget->setItem(row, 3, new QTableWidgetItem(query.value(3).toString()));              // 3: log_level
-        m_tableWidget->setItem(row, 4, new QTableWidgetItem(query.value(4).toString()));              // 4: module_name
-        m_tableWidget->setItem(row, 5, new QTableWidgetItem(query.value(5).toString()));              // 5: operation_content
-        m_tableWidget->setItem(row, 6, new QTableWidgetItem(query.value(6).toString()));              // 6: ip_address
-        m_tableWidget->setItem(row, 7, new QTableWidgetItem(query.value(7).toString()));              // 7: create_time
-        row++;
+    // 异步查询，避免日志量大时阻塞界面；重复加载时取消上一次请求
+    if(m_loadRequestId != 0) {
+        BaseDbHelper::getInstance()->cancelAsync(m_loadRequestId);
     }
+    int UUID = (UserSession::instance()->userRole() == "超级管理员") ? -1 : UserSession::instance()->userId();
+
+    m_loadRequestId = logDbHelper.getAllLogListAsync(UUID, this, [this](const DbQueryResult &result) {
+        m_loadRequestId = 0;
+        if(!result.success) {
+            LOG_ERROR("日志模块", "查询日志失败：" << result.error);
+            return;
+        }
+        LOG_DEBUG("用户信息模块", "查询到日志条数：" << result.rows.size() << "耗时(毫秒)：" << result.elapsedMs);
+
+        m_tableWidget->setRowCount(result.rows.size());
+        for(int row = 0; row < result.rows.size(); row++)
+        {
+            const QSqlRecord &record = result.rows.at(row);
+            // 字段索引映射（与上述SQL查询字段顺序严格对应）：
+            m_tableWidget->setItem(row, 0, new QTableWidgetItem(QString::number(record.value(0).toInt()))); // 0: log_id
+            m_tableWidget->setItem(row, 1, new QTableWidgetItem(record.value(1).toString()));              // 1: username(操作者)
+            m_tableWidget->setItem(row, 2, new QTableWidgetItem(record.value(2).toString()));              // 2: operation_type
+            m_tableWidget->setItem(row, 3, new QTableWidgetItem(record.value(3).toString()));              // 3: log_level
+            m_tableWidget->setItem(row, 4, new QTableWidgetItem(record.value(4).toString()));              // 4: module_name
+            m_tableWidget->setItem(row, 5, new QTableWidgetItem(record.value(5).toString()));              // 5: operation_content
+            m_tableWidget->setItem(row, 6, new QTableWidgetItem(record.value(6).toString()));              // 6: ip_address
+            m_tableWidget->setItem(row, 7, new QTableWidgetItem(record.value(7).toString()));              // 7: create_time
+        }
+    });
 }
 
 // 新建日志（禁用，返回false）
@@ -122,7 +128,7 @@ void LogTableWidget::slot_searchFilter()
     // SELECT l.log_id, u.username, l.operation_type, l.log_level, l.module_name, l.operation_content, l.ip_address, l.create_time
     // FROM sys_log l LEFT JOIN sys_user u ON l.user_id = u.id
     // WHERE u.username LIKE ? OR l.operation_type LIKE ? OR l.module_name LIKE ? OR l.operation_content LIKE ?
-    QSqlQuery logQuery = logHelper.searchLogByKey(key);
+    DbQuery logQuery = logHelper.searchLogByKey(key);
 
     int row = 0;
     while(logQuery.next())
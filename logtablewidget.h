@@ -21,6 +21,7 @@ protected:
     void slot_searchFilter() override;// 用户表筛选
 private:
     void disabledChangeLogsBtn();
+    quint64 m_loadRequestId = 0; // 进行中的日志加载请求
 };
 
 #endif // LOGTABLEWIDGET_H
@@ -2,6 +2,7 @@
 #include "loginwidget.h"
 #include <QApplication>
 #include "loghelper.h"
+#include "logmanager.h"
 
 int main(int argc, char *argv[])
 {
@@ -16,6 +17,7 @@ int main(int argc, char *argv[])
     QString logFilePath = logDir + "/view_platform.log";
     SET_LOG_FILE(logFilePath);
     SET_LOG_SPLIT_RULE(SPLIT_BY_BOTH, 50, SPLIT_DAY); // 50MB/每天分割
+    SET_LOG_RETENTION(true, 1024, 30); // 分割文件压缩归档，最多保留1GB/30天
 
     // 3. 日志过滤（屏蔽包含"密码"的日志，仅打印登录/配置模块）
     SET_LOG_FILTER_MODE(FILTER_WHITE_LIST);
@@ -41,12 +43,20 @@ int main(int argc, char *argv[])
     // 5. 启用系统日志
     ENABLE_SYSTEM_LOG(true);
 
+    // 6. 启用异步日志（8192条队列，200ms批量刷新）
+    SET_LOG_ASYNC(true, 8192, 200);
+
+    int ret = 0;
     LoginWidget loginWidget;
     loginWidget.show();
     if(loginWidget.exec() == QDialog::Accepted || loginWidget.isLoginSuccess()) {
         MainWindow w(loginWidget.m_curLoginPhone);
         w.show();
-        return a.exec();
+        ret = a.exec();
     }
-    return 0;
+
+    // 退出前写完后台队列中的审计日志
+    LogManager::getInstance()->shutdown();
+    LogHelper::instance().flushAsync();
+    return ret;
 }
@@ -0,0 +1,328 @@
+#include "markdownrenderer.h"
+
+// 与原正则版保持一致的样式
+static const char *STYLE_H1 = "<h1 style='color:#2c3e50; margin:8px 0; font-size:18px; font-weight:bold;'>";
+static const char *STYLE_H2 = "<h2 style='color:#34495e; margin:6px 0; font-size:16px; font-weight:bold;'>";
+static const char *STYLE_H3 = "<h3 style='color:#415a77; margin:5px 0; font-size:14px; font-weight:bold;'>";
+static const char *STYLE_H4 = "<h4 style='color:#596e8b; margin:4px 0; font-size:13px; font-weight:bold;'>";
+static const char *STYLE_PRE = "<pre style='background-color:#f5f5f5; padding:8px; border-radius:4px; margin:8px 0; font-family:Consolas,Monospace; font-size:12px;'>";
+static const char *STYLE_CODE = "<code style='background-color:#f0f0f0; padding:2px 4px; border-radius:2px; font-family:Consolas; font-size:12px;'>";
+static const char *STYLE_UL = "<ul style='margin:6px 0; padding-left:25px;'>";
+static const char *STYLE_LI = "<li style='margin:2px 0; list-style:disc;'>";
+static const char *STYLE_HR = "<hr style='border:0; border-top:1px solid #eee; margin:10px 0;'>";
+static const char *STYLE_QUOTE = "<blockquote style='margin:6px 0; padding:6px 10px; background-color:#f8f9fa; border-left:3px solid #6c757d;'>";
+static const char *STYLE_LINK = "<a style='color:#3498db; text-decoration:none;' href='";
+
+QString MarkdownRenderer::render(const QString &markdown)
+{
+    if (markdown.isEmpty()) return "";
+    MarkdownRenderer renderer;
+    QString html = renderer.append(markdown);
+    html += renderer.finish();
+    return html;
+}
+
+QString MarkdownRenderer::append(const QString &chunk)
+{
+    QString out;
+    int start = 0;
+    int newline;
+    while ((newline = chunk.indexOf('\n', start)) >= 0) {
+        m_lineBuffer.append(chunk.midRef(start, newline - start));
+        if (m_lineBuffer.endsWith('\r')) {
+            m_lineBuffer.chop(1);
+        }
+        processLine(m_lineBuffer, out);
+        m_lineBuffer.clear();
+        start = newline + 1;
+    }
+    m_lineBuffer.append(chunk.midRef(start));
+    return out;
+}
+
+QString MarkdownRenderer::finish()
+{
+    QString out;
+    if (!m_lineBuffer.isEmpty()) {
+        processLine(m_lineBuffer, out);
+        m_lineBuffer.clear();
+    }
+    closeBlock(out);
+    return out;
+}
+
+QString MarkdownRenderer::pendingSource() const
+{
+    return m_blockSource + m_lineBuffer;
+}
+
+void MarkdownRenderer::reset()
+{
+    m_block = BLOCK_NONE;
+    m_lineBuffer.clear();
+    m_blockSource.clear();
+    m_blockHtml.clear();
+}
+
+void MarkdownRenderer::closeBlock(QString &out)
+{
+    switch (m_block) {
+    case BLOCK_CODE:
+        out += QLatin1String(STYLE_PRE) + m_blockHtml + QLatin1String("</pre>");
+        break;
+    case BLOCK_MATH:
+        out += QLatin1String("\\[") + m_blockHtml + QLatin1String("\\]<br/>");
+        break;
+    case BLOCK_LIST:
+        out += QLatin1String(STYLE_UL) + m_blockHtml + QLatin1String("</ul>");
+        break;
+    case BLOCK_NONE:
+        break;
+    }
+    m_block = BLOCK_NONE;
+    m_blockSource.clear();
+    m_blockHtml.clear();
+}
+
+void MarkdownRenderer::processLine(const QString &line, QString &out)
+{
+    // 1. 未闭合块内部
+    if (m_block == BLOCK_CODE) {
+        if (line.trimmed().startsWith(QLatin1String("```"))) {
+            closeBlock(out);
+        } else {
+            appendEscaped(line, 0, line.size(), m_blockHtml);
+            m_blockHtml += '\n';
+            m_blockSource += line + '\n';
+        }
+        return;
+    }
+    if (m_block == BLOCK_MATH) {
+        int close = line.indexOf(QLatin1String("$$"));
+        if (close >= 0) {
+            appendEscaped(line, 0, close, m_blockHtml);
+            closeBlock(out);
+        } else {
+            appendEscaped(line, 0, line.size(), m_blockHtml);
+            m_blockHtml += '\n';
+            m_blockSource += line + '\n';
+        }
+        return;
+    }
+
+    int contentPos = 0;
+    if (m_block == BLOCK_LIST) {
+        if (parseListItem(line, &contentPos)) {
+            m_blockHtml += QLatin1String(STYLE_LI);
+            renderInline(line, contentPos, line.size(), m_blockHtml);
+            m_blockHtml += QLatin1String("</li>");
+            m_blockSource += line + '\n';
+            return;
+        }
+        closeBlock(out); // 列表结束，当前行按普通行继续处理
+    }
+
+    QString trimmed = line.trimmed();
+
+    // 2. 代码块开始（同一行闭合的```code```按单行代码块处理）
+    if (trimmed.startsWith(QLatin1String("```"))) {
+        int close = trimmed.indexOf(QLatin1String("```"), 3);
+        if (close >= 0) {
+            out += QLatin1String(STYLE_PRE);
+            appendEscaped(trimmed, 3, close, out);
+            out += QLatin1String("</pre>");
+        } else {
+            m_block = BLOCK_CODE; // ```后的语言标记忽略
+            m_blockSource = line + '\n';
+        }
+        return;
+    }
+
+    // 3. 公式块开始
+    if (trimmed.startsWith(QLatin1String("$$"))) {
+        int close = trimmed.indexOf(QLatin1String("$$"), 2);
+        if (close >= 0) {
+            out += QLatin1String("\\[");
+            appendEscaped(trimmed, 2, close, out);
+            out += QLatin1String("\\]");
+            renderInline(trimmed, close + 2, trimmed.size(), out);
+            out += QLatin1String("<br/>");
+        } else {
+            m_block = BLOCK_MATH;
+            appendEscaped(trimmed, 2, trimmed.size(), m_blockHtml);
+            m_blockHtml += '\n';
+            m_blockSource = line + '\n';
+        }
+        return;
+    }
+
+    // 4. 标题
+    int level = headingLevel(line);
+    if (level > 0) {
+        const char *open = level == 1 ? STYLE_H1 : level == 2 ? STYLE_H2 : level == 3 ? STYLE_H3 : STYLE_H4;
+        int tag = qMin(level, 4);
+        int textPos = level;
+        while (textPos < line.size() && line.at(textPos).isSpace()) textPos++;
+        out += QLatin1String(open);
+        renderInline(line, textPos, line.size(), out);
+        out += QString("</h%1>").arg(tag);
+        return;
+    }
+
+    // 5. 分割线
+    if (trimmed == QLatin1String("---")) {
+        out += QLatin1String(STYLE_HR);
+        return;
+    }
+
+    // 6. 引用
+    if (line.startsWith(QLatin1String("> "))) {
+        int textPos = 1;
+        while (textPos < line.size() && line.at(textPos).isSpace()) textPos++;
+        out += QLatin1String(STYLE_QUOTE);
+        renderInline(line, textPos, line.size(), out);
+        out += QLatin1String("</blockquote>");
+        return;
+    }
+
+    // 7. 列表项
+    if (parseListItem(line, &contentPos)) {
+        m_block = BLOCK_LIST;
+        m_blockHtml = QLatin1String(STYLE_LI);
+        renderInline(line, contentPos, line.size(), m_blockHtml);
+        m_blockHtml += QLatin1String("</li>");
+        m_blockSource = line + '\n';
+        return;
+    }
+
+    // 8. 普通行
+    renderInline(line, 0, line.size(), out);
+    out += QLatin1String("<br/>");
+}
+
+int MarkdownRenderer::headingLevel(const QString &line)
+{
+    int level = 0;
+    while (level < line.size() && line.at(level) == '#') level++;
+    if (level == 0 || level > 6 || level >= line.size() || !line.at(level).isSpace()) {
+        return 0;
+    }
+    return level;
+}
+
+bool MarkdownRenderer::parseListItem(const QString &line, int *contentPos)
+{
+    int pos = 0;
+    while (pos < line.size() && line.at(pos).isSpace()) pos++;
+    if (pos + 1 >= line.size()) return false;
+    QChar marker = line.at(pos);
+    if ((marker != '-' && marker != '*') || !line.at(pos + 1).isSpace()) {
+        return false;
+    }
+    pos++;
+    while (pos < line.size() && line.at(pos).isSpace()) pos++;
+    *contentPos = pos;
+    return true;
+}
+
+void MarkdownRenderer::appendEscaped(const QString &text, int from, int to, QString &out)
+{
+    for (int i = from; i < to; i++) {
+        QChar c = text.at(i);
+        switch (c.unicode()) {
+        case '&':  out += QLatin1String("&amp;");  break;
+        case '<':  out += QLatin1String("&lt;");   break;
+        case '>':  out += QLatin1String("&gt;");   break;
+        case '\'': out += QLatin1String("&#39;");  break;
+        case '"':  out += QLatin1String("&quot;"); break;
+        default:   out += c;
+        }
+    }
+}
+
+// 行内元素：在[from, to)内从左到右扫描，遇到标记时查找同一行内的闭合标记
+void MarkdownRenderer::renderInline(const QString &text, int from, int to, QString &out)
+{
+    int i = from;
+    int plainStart = from;
+    auto flushPlain = [&](int end) {
+        appendEscaped(text, plainStart, end, out);
+    };
+    auto findIn = [&](const QString &marker, int start) {
+        int pos = text.indexOf(marker, start);
+        return (pos >= 0 && pos + marker.size() <= to) ? pos : -1;
+    };
+
+    while (i < to) {
+        QChar c = text.at(i);
+        bool nextSame = (i + 1 < to && text.at(i + 1) == c);
+        int close = -1;
+
+        if (c == '`') {
+            close = findIn(QStringLiteral("`"), i + 1);
+            if (close > i) {
+                flushPlain(i);
+                out += QLatin1String(STYLE_CODE);
+                appendEscaped(text, i + 1, close, out);
+                out += QLatin1String("</code>");
+                i = plainStart = close + 1;
+                continue;
+            }
+        } else if (c == '$' && nextSame) {
+            close = findIn(QStringLiteral("$$"), i + 2);
+            if (close > i + 2) {
+                flushPlain(i);
+                out += QLatin1String("\\[");
+                appendEscaped(text, i + 2, close, out);
+                out += QLatin1String("\\]");
+                i = plainStart = close + 2;
+                continue;
+            }
+        } else if (c == '$') {
+            close = findIn(QStringLiteral("$"), i + 1);
+            if (close > i + 1) {
+                flushPlain(i);
+                out += QLatin1String("\\(");
+                appendEscaped(text, i + 1, close, out);
+                out += QLatin1String("\\)");
+                i = plainStart = close + 1;
+                continue;
+            }
+        } else if (c == '*' && nextSame) {
+            close = findIn(QStringLiteral("**"), i + 2);
+            if (close > i + 2) {
+                flushPlain(i);
+                out += QLatin1String("<b>");
+                renderInline(text, i + 2, close, out);
+                out += QLatin1String("</b>");
+                i = plainStart = close + 2;
+                continue;
+            }
+        } else if (c == '*') {
+            close = findIn(QStringLiteral("*"), i + 1);
+            if (close > i + 1) {
+                flushPlain(i);
+                out += QLatin1String("<i>");
+                renderInline(text, i + 1, close, out);
+                out += QLatin1String("</i>");
+                i = plainStart = close + 1;
+                continue;
+            }
+        } else if (c == '[') {
+            int mid = findIn(QStringLiteral("]("), i + 1);
+            int end = mid > i + 1 ? findIn(QStringLiteral(")"), mid + 2) : -1;
+            if (end > mid + 2) {
+                flushPlain(i);
+                out += QLatin1String(STYLE_LINK);
+                appendEscaped(text, mid + 2, end, out);
+                out += QLatin1String("'>");
+                renderInline(text, i + 1, mid, out);
+                out += QLatin1String("</a>");
+                i = plainStart = end + 1;
+                continue;
+            }
+        }
+        i++;
+    }
+    flushPlain(to);
+}
@@ -0,0 +1,51 @@
+#ifndef MARKDOWNRENDERER_H
+#define MARKDOWNRENDERER_H
+
+#include <QString>
+
+/**
+ * @brief Markdown + LaTeX 单遍渲染器（输出QTextEdit可用的富文本）
+ * 支持：标题、无序列表、代码块、$$公式块$$、分割线、引用、
+ *      行内代码、加粗、斜体、链接、$行内公式$（转为MathJax的\( \)/\[ \]）
+ * 按行扫描一遍完成渲染，不再逐条正则全文替换；
+ * 可增量使用：append()喂入流式片段，返回已完整的块的HTML，未完整的部分留到后续。
+ */
+class MarkdownRenderer
+{
+public:
+    // 一次性渲染完整文本
+    static QString render(const QString &markdown);
+
+    // 增量渲染：返回本次新完成的块的HTML（可能为空）
+    QString append(const QString &chunk);
+    // 结束：渲染剩余的半行和未闭合的块
+    QString finish();
+    // 尚未渲染的原文（半行 + 未闭合的代码块/公式块/列表），流式显示时按纯文本展示
+    QString pendingSource() const;
+    void reset();
+
+private:
+    enum BlockState {
+        BLOCK_NONE,
+        BLOCK_CODE,  // ``` 代码块
+        BLOCK_MATH,  // $$ 多行公式块
+        BLOCK_LIST   // 连续的列表项
+    };
+
+    // 处理一整行（不含换行符），完成的HTML写入out
+    void processLine(const QString &line, QString &out);
+    // 关闭当前未闭合的块并输出
+    void closeBlock(QString &out);
+    // 行内元素渲染
+    static void renderInline(const QString &text, int from, int to, QString &out);
+    static void appendEscaped(const QString &text, int from, int to, QString &out);
+    static bool parseListItem(const QString &line, int *contentPos);
+    static int headingLevel(const QString &line);
+
+    BlockState m_block = BLOCK_NONE;
+    QString m_lineBuffer;   // 尚未以换行结束的半行
+    QString m_blockSource;  // 未闭合块的原文
+    QString m_blockHtml;    // 未闭合块已渲染的内容
+};
+
+#endif // MARKDOWNRENDERER_H
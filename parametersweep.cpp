@@ -0,0 +1,422 @@
+#include "parametersweep.h"
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSet>
+#include <QTextStream>
+#include <QVector>
+#include <QtMath>
+#include <algorithm>
+#include "runscheduler.h"
+#include "loghelper.h"
+
+bool ParameterSweep::parse(const QJsonObject& definition, QString* error)
+{
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    m_name = definition.value("name").toString("sweep").trimmed();
+    if (m_name.isEmpty()) m_name = "sweep";
+
+    QString method = definition.value("method").toString("grid").toLower();
+    if (method == "grid") {
+        m_method = Grid;
+    } else if (method == "random") {
+        m_method = Random;
+    } else if (method == "lhs") {
+        m_method = LatinHypercube;
+    } else {
+        return fail(QString("未知的扫描方式：%1（可选grid/random/lhs）").arg(method));
+    }
+
+    m_samples = definition.value("samples").toInt(0);
+    if (m_method != Grid && m_samples <= 0) {
+        return fail("随机/拉丁超立方扫描须指定samples（采样组数）");
+    }
+    m_seed = static_cast<quint32>(definition.value("seed").toInt(1));
+
+    QJsonObject params = definition.value("params").toObject();
+    if (params.isEmpty()) {
+        return fail("扫描定义中没有参数（params为空）");
+    }
+
+    m_dimensions.clear();
+    for (auto it = params.constBegin(); it != params.constEnd(); ++it) {
+        Dimension dim;
+        dim.key = it.key();
+        if (it.value().isArray()) {
+            dim.values = it.value().toArray();
+            if (dim.values.isEmpty()) {
+                return fail(QString("参数%1的取值列表为空").arg(dim.key));
+            }
+        } else if (it.value().isObject()) {
+            QJsonObject range = it.value().toObject();
+            if (!range.value("min").isDouble() || !range.value("max").isDouble()) {
+                return fail(QString("参数%1的区间须包含数值min和max").arg(dim.key));
+            }
+            dim.min = range.value("min").toDouble();
+            dim.max = range.value("max").toDouble();
+            dim.step = range.value("step").toDouble(0);
+            dim.logScale = range.value("log").toBool(false);
+            if (dim.min > dim.max) {
+                return fail(QString("参数%1的区间min大于max").arg(dim.key));
+            }
+            if (dim.logScale && dim.min <= 0) {
+                return fail(QString("参数%1为对数区间，min须大于0").arg(dim.key));
+            }
+            if (m_method == Grid) {
+                if (dim.step <= 0 || (dim.logScale && dim.step <= 1)) {
+                    return fail(QString("网格扫描的区间须指定step（参数%1；对数区间step为大于1的倍数）").arg(dim.key));
+                }
+            }
+        } else {
+            // 单个取值等同于只有一个元素的列表（固定该参数）
+            dim.values = QJsonArray({ it.value() });
+        }
+        m_dimensions.append(dim);
+    }
+    return true;
+}
+
+QStringList ParameterSweep::keys() const
+{
+    QStringList keys;
+    for (const Dimension& dim : m_dimensions) keys << dim.key;
+    return keys;
+}
+
+double ParameterSweep::gridCount(const Dimension& dim)
+{
+    if (!dim.values.isEmpty()) return dim.values.size();
+    // 与gridValues的取值条件一致：min*step^i 或 min+step*i 不超过max（容许浮点误差）
+    double eps = (dim.max - dim.min) * 1e-9;
+    double steps = dim.logScale ? qLn((dim.max + eps) / dim.min) / qLn(dim.step)
+                                : (dim.max + eps - dim.min) / dim.step;
+    return qFloor(steps) + 1.0;
+}
+
+QJsonArray ParameterSweep::gridValues(const Dimension& dim)
+{
+    if (!dim.values.isEmpty()) return dim.values;
+
+    QJsonArray values;
+    // 容许浮点累积误差，保证max本身能取到
+    double eps = (dim.max - dim.min) * 1e-9;
+    for (int i = 0; ; i++) {
+        double v = dim.logScale ? dim.min * qPow(dim.step, i) : dim.min + dim.step * i;
+        if (v > dim.max + eps) break;
+        values.append(dim.integer ? QJsonValue(qRound(v)) : QJsonValue(v));
+    }
+    return values;
+}
+
+QJsonValue ParameterSweep::valueAt(const Dimension& dim, double u)
+{
+    if (!dim.values.isEmpty()) {
+        int index = qMin(dim.values.size() - 1, static_cast<int>(u * dim.values.size()));
+        return dim.values.at(index);
+    }
+    double v = dim.logScale ? qExp(qLn(dim.min) + u * (qLn(dim.max) - qLn(dim.min)))
+                            : dim.min + u * (dim.max - dim.min);
+    return dim.integer ? QJsonValue(qRound(v)) : QJsonValue(v);
+}
+
+bool ParameterSweep::expand(const ConfigParams& base, int maxPoints, QList<SweepPoint>& points,
+                            QString* error, int* duplicates) const
+{
+    auto fail = [error](const QString& message) {
+        if (error) *error = message;
+        return false;
+    };
+
+    // 校验字段并确定类型：整型字段写入0.5后再读出不会保持0.5
+    const QJsonObject baseJson = base.toJson();
+    QList<Dimension> dims = m_dimensions;
+    for (Dimension& dim : dims) {
+        QJsonValue baseValue = baseJson.value(dim.key);
+        if (baseValue.isUndefined()) {
+            return fail(QString("配置中没有参数%1").arg(dim.key));
+        }
+        if (baseValue.isDouble()) {
+            QJsonObject probeJson = baseJson;
+            probeJson[dim.key] = 0.5;
+            ConfigParams probe = base;
+            probe.fromJson(probeJson);
+            dim.integer = probe.toJson().value(dim.key).toDouble() != 0.5;
+        } else if (dim.values.isEmpty()) {
+            return fail(QString("参数%1不是数值，只能使用取值列表").arg(dim.key));
+        }
+    }
+
+    // 生成各组扫描参数取值
+    QList<QJsonObject> combos;
+    if (m_method == Grid) {
+        // 先按区间和步长算出组合数再生成取值，过小的step不会在生成阶段卡住界面
+        double count = 1;
+        for (const Dimension& dim : dims) {
+            count *= gridCount(dim);
+            if (!(count <= maxPoints)) {
+                return fail(QString("网格组合数超过上限%1，请缩小范围或改用random/lhs").arg(maxPoints));
+            }
+        }
+        qint64 total = 1;
+        QList<QJsonArray> axes;
+        for (const Dimension& dim : dims) {
+            axes.append(gridValues(dim));
+            total *= axes.last().size();
+        }
+        if (total > maxPoints) {
+            return fail(QString("网格组合数超过上限%1，请缩小范围或改用random/lhs").arg(maxPoints));
+        }
+        QVector<int> index(dims.size(), 0);
+        for (qint64 n = 0; n < total; n++) {
+            QJsonObject values;
+            for (int d = 0; d < dims.size(); d++) {
+                values[dims.at(d).key] = axes.at(d).at(index.at(d));
+            }
+            combos.append(values);
+            // 最后一维变化最快
+            for (int d = dims.size() - 1; d >= 0; d--) {
+                if (++index[d] < axes.at(d).size()) break;
+                index[d] = 0;
+            }
+        }
+    } else {
+        if (m_samples > maxPoints) {
+            return fail(QString("采样组数超过上限%1").arg(maxPoints));
+        }
+        QRandomGenerator rng(m_seed);
+        // 拉丁超立方：每一维把[0,1)等分为samples层，每层恰好取一次，各维层序独立打乱
+        QList<QVector<int>> strata;
+        if (m_method == LatinHypercube) {
+            for (int d = 0; d < dims.size(); d++) {
+                QVector<int> order(m_samples);
+                for (int i = 0; i < m_samples; i++) order[i] = i;
+                for (int i = m_samples - 1; i > 0; i--) {
+                    std::swap(order[i], order[static_cast<int>(rng.bounded(i + 1))]);
+                }
+                strata.append(order);
+            }
+        }
+        for (int i = 0; i < m_samples; i++) {
+            QJsonObject values;
+            for (int d = 0; d < dims.size(); d++) {
+                double u = rng.generateDouble();
+                if (m_method == LatinHypercube) {
+                    u = (strata.at(d).at(i) + u) / m_samples;
+                }
+                values[dims.at(d).key] = valueAt(dims.at(d), u);
+            }
+            combos.append(values);
+        }
+    }
+
+    // 合并到基础配置并去重
+    points.clear();
+    QSet<QString> seen;
+    int dup = 0;
+    for (const QJsonObject& values : combos) {
+        QJsonObject json = baseJson;
+        QJsonObject applied;
+        for (const Dimension& dim : dims) {
+            QJsonValue value = values.value(dim.key);
+            if (dim.integer && value.isDouble()) {
+                value = qRound(value.toDouble());
+            }
+            json[dim.key] = value;
+            applied[dim.key] = value;
+        }
+        SweepPoint point;
+        point.params = base;
+        point.params.fromJson(json);
+        point.values = applied;
+        QString key = point.params.hash();
+        if (seen.contains(key)) {
+            dup++;
+            continue;
+        }
+        seen.insert(key);
+        points.append(point);
+    }
+    if (duplicates) *duplicates = dup;
+    return true;
+}
+
+QJsonObject ParameterSweep::exampleDefinition()
+{
+    QJsonObject lr;
+    lr["min"] = 0.001;
+    lr["max"] = 0.1;
+    lr["log"] = true;
+    QJsonObject params;
+    params["learning_rate"] = lr;
+    params["N"] = QJsonArray({ 300, 500, 800 });
+    params["sched_T"] = QJsonArray({ 200, 300 });
+
+    QJsonObject definition;
+    definition["name"] = "lr_study";
+    definition["method"] = "lhs";
+    definition["samples"] = 12;
+    definition["seed"] = 1;
+    definition["params"] = params;
+    return definition;
+}
+
+// ========== SweepCampaign ==========
+SweepCampaign::SweepCampaign(const QString& name, const QStringList& keys, const QString& resultDir, QObject *parent)
+    : QObject(parent),
+      m_name(name),
+      m_keys(keys),
+      m_resultDir(resultDir)
+{
+    QDir().mkpath(m_resultDir);
+    connect(RunScheduler::getInstance(), &RunScheduler::jobResult, this, &SweepCampaign::onJobResult);
+}
+
+void SweepCampaign::addJob(int jobId, const QString& testCode, const QJsonObject& values)
+{
+    Row row;
+    row.testCode = testCode;
+    row.status = "排队中";
+    row.values = values;
+    m_jobRows.insert(jobId, m_rows.size());
+    m_rows.append(row);
+}
+
+void SweepCampaign::addResult(const QString& testCode, const QJsonObject& values, const TestRecord& record)
+{
+    Row row;
+    row.testCode = testCode;
+    row.values = values;
+    m_rows.append(row);
+    fillRow(m_rows.last(), record);
+}
+
+void SweepCampaign::fillRow(Row& row, const TestRecord& record)
+{
+    row.status = record.remark;
+    row.resultPath = record.result_path;
+    QJsonObject metrics = QJsonDocument::fromJson(record.metrics_data.toUtf8()).object();
+    flattenMetrics(metrics, "", row.metrics);
+    for (auto m = row.metrics.constBegin(); m != row.metrics.constEnd(); ++m) {
+        if (!m_metricKeys.contains(m.key())) m_metricKeys << m.key();
+    }
+    m_finished++;
+
+    // 每个任务结束都落盘，中途退出也保留已完成的结果
+    writeSummary();
+}
+
+void SweepCampaign::onJobResult(int jobId, const TestRecord& record)
+{
+    auto it = m_jobRows.find(jobId);
+    if (it == m_jobRows.end()) return;
+    int rowIndex = it.value();
+    m_jobRows.erase(it);
+    fillRow(m_rows[rowIndex], record);
+
+    emit progress(m_finished, m_rows.size());
+    if (isFinished()) {
+        LOG_INFO("算法模块", "【参数扫描】" << m_name << "完成，共" << m_rows.size() << "组，汇总：" << m_resultDir);
+        emit finished(m_resultDir + "/summary.csv");
+    }
+}
+
+void SweepCampaign::flattenMetrics(const QJsonObject& object, const QString& prefix, QHash<QString, QString>& metrics)
+{
+    for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+        QString key = prefix.isEmpty() ? it.key() : prefix + "." + it.key();
+        const QJsonValue& value = it.value();
+        if (value.isObject()) {
+            flattenMetrics(value.toObject(), key, metrics);
+        } else if (value.isArray()) {
+            metrics.insert(key, QString::fromUtf8(QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact)));
+        } else if (value.isDouble()) {
+            metrics.insert(key, QString::number(value.toDouble(), 'g', 10));
+        } else if (value.isBool()) {
+            metrics.insert(key, value.toBool() ? "true" : "false");
+        } else {
+            metrics.insert(key, value.toString());
+        }
+    }
+}
+
+QStringList SweepCampaign::headers() const
+{
+    return QStringList({ "测试代号", "状态" }) + m_keys + m_metricKeys + QStringList({ "结果路径" });
+}
+
+QList<QStringList> SweepCampaign::rows() const
+{
+    QList<QStringList> rows;
+    for (const Row& row : m_rows) {
+        QStringList cells;
+        cells << row.testCode << row.status;
+        for (const QString& key : m_keys) {
+            QJsonValue value = row.values.value(key);
+            cells << (value.isDouble() ? QString::number(value.toDouble(), 'g', 10) : value.toVariant().toString());
+        }
+        for (const QString& key : m_metricKeys) {
+            cells << row.metrics.value(key);
+        }
+        cells << row.resultPath;
+        rows.append(cells);
+    }
+    return rows;
+}
+
+void SweepCampaign::writeSummary()
+{
+    auto csvField = [](QString field) {
+        if (field.contains(',') || field.contains('"') || field.contains('\n')) {
+            field.replace("\"", "\"\"");
+            field = "\"" + field + "\"";
+        }
+        return field;
+    };
+
+    QSaveFile csvFile(m_resultDir + "/summary.csv");
+    if (csvFile.open(QIODevice::WriteOnly)) {
+        QTextStream out(&csvFile);
+        out.setCodec("UTF-8");
+        out.setGenerateByteOrderMark(true); // Excel按UTF-8识别中文表头
+        QList<QStringList> lines = rows();
+        lines.prepend(headers());
+        for (const QStringList& cells : lines) {
+            QStringList fields;
+            for (const QString& cell : cells) fields << csvField(cell);
+            out << fields.join(',') << "\n";
+        }
+        out.flush();
+        csvFile.commit();
+    } else {
+        LOG_ERROR("算法模块", "【参数扫描】写入汇总表失败：" << csvFile.fileName());
+    }
+
+    QJsonArray items;
+    for (const Row& row : m_rows) {
+        QJsonObject item;
+        item["test_code"] = row.testCode;
+        item["status"] = row.status;
+        item["params"] = row.values;
+        QJsonObject metrics;
+        for (auto it = row.metrics.constBegin(); it != row.metrics.constEnd(); ++it) {
+            metrics[it.key()] = it.value();
+        }
+        item["metrics"] = metrics;
+        item["result_path"] = row.resultPath;
+        items.append(item);
+    }
+    QJsonObject summary;
+    summary["name"] = m_name;
+    summary["runs"] = items;
+    QSaveFile jsonFile(m_resultDir + "/summary.json");
+    if (jsonFile.open(QIODevice::WriteOnly)) {
+        jsonFile.write(QJsonDocument(summary).toJson(QJsonDocument::Indented));
+        jsonFile.commit();
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef PARAMETERSWEEP_H
+#define PARAMETERSWEEP_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "testdbhelper.h"
+
+// 扫描展开后的一组参数
+struct SweepPoint {
+    ConfigParams params;     // 完整配置（基础配置 + 扫描参数）
+    QJsonObject values;      // 本组扫描参数的取值
+};
+
+/**
+ * @brief 参数扫描定义：对ConfigParams任意字段做网格/随机/拉丁超立方采样
+ * 定义格式（JSON）：
+ * {
+ *   "name": "lr_study",
+ *   "method": "grid",              // grid | random | lhs
+ *   "samples": 20,                 // random/lhs 的采样组数
+ *   "seed": 1,                     // random/lhs 的随机种子（相同种子展开结果相同）
+ *   "params": {
+ *     "learning_rate": [0.001, 0.01, 0.1],                 // 离散取值
+ *     "N": {"min": 200, "max": 1000, "step": 200},          // 区间；网格扫描须指定step
+ *     "alpha_1": {"min": 0.1, "max": 10, "log": true}       // 对数区间（网格时step为倍数）
+ *   }
+ * }
+ * 展开时按基础配置补全其余字段，整型字段取整，完全相同的配置只保留一组。
+ */
+class ParameterSweep
+{
+public:
+    enum Method {
+        Grid,
+        Random,
+        LatinHypercube
+    };
+
+    // 解析扫描定义，失败时返回false并输出错误信息
+    bool parse(const QJsonObject& definition, QString* error);
+    // 以base为基础展开为参数组（已去重）；组数超过maxPoints时返回false
+    bool expand(const ConfigParams& base, int maxPoints, QList<SweepPoint>& points,
+                QString* error, int* duplicates = nullptr) const;
+
+    QString name() const { return m_name; }
+    Method method() const { return m_method; }
+    QStringList keys() const;
+
+    // 示例定义（扫描对话框的初始内容）
+    static QJsonObject exampleDefinition();
+
+private:
+    struct Dimension {
+        QString key;
+        QJsonArray values;       // 离散取值（非空时忽略区间）
+        double min = 0;
+        double max = 0;
+        double step = 0;
+        bool logScale = false;
+        bool integer = false;    // 整型字段，展开时按字段类型确定
+    };
+
+    // 维度u∈[0,1)对应的取值
+    static QJsonValue valueAt(const Dimension& dim, double u);
+    // 网格扫描时维度的取值个数（不生成取值，用于先校验组合数上限）
+    static double gridCount(const Dimension& dim);
+    // 网格扫描时维度的全部取值
+    static QJsonArray gridValues(const Dimension& dim);
+
+    QString m_name;
+    Method m_method = Grid;
+    int m_samples = 0;
+    quint32 m_seed = 1;
+    QList<Dimension> m_dimensions;
+};
+
+/**
+ * @brief 一次参数扫描的运行结果汇总
+ * 跟踪扫描提交到RunScheduler的任务，每个任务结束后读取其metrics.json（嵌套字段以“.”展开），
+ * 与扫描参数合并为一张对比表，并同步写入结果目录下的summary.csv / summary.json。
+ */
+class SweepCampaign : public QObject
+{
+    Q_OBJECT
+public:
+    SweepCampaign(const QString& name, const QStringList& keys, const QString& resultDir, QObject *parent = nullptr);
+
+    // 登记一个已提交的任务
+    void addJob(int jobId, const QString& testCode, const QJsonObject& values);
+    // 登记一组直接复用已有结果（命中结果缓存）的配置
+    void addResult(const QString& testCode, const QJsonObject& values, const TestRecord& record);
+
+    QString name() const { return m_name; }
+    QString resultDir() const { return m_resultDir; }
+    int totalCount() const { return m_rows.size(); }
+    int finishedCount() const { return m_finished; }
+    bool isFinished() const { return m_finished == m_rows.size(); }
+
+    // 对比表（表头 + 各行取值）
+    QStringList headers() const;
+    QList<QStringList> rows() const;
+
+signals:
+    void progress(int finished, int total);
+    // 全部任务结束，csvPath为汇总表路径
+    void finished(const QString& csvPath);
+
+private slots:
+    void onJobResult(int jobId, const TestRecord& record);
+
+private:
+    struct Row {
+        QString testCode;
+        QString status;
+        QJsonObject values;
+        QHash<QString, QString> metrics;
+        QString resultPath;
+    };
+
+    // 指标JSON展开为“字段路径 -> 值”
+    static void flattenMetrics(const QJsonObject& object, const QString& prefix, QHash<QString, QString>& metrics);
+    // 填入任务结果并写汇总表
+    void fillRow(Row& row, const TestRecord& record);
+    void writeSummary();
+
+    QString m_name;
+    QStringList m_keys;
+    QStringList m_metricKeys;       // 按首次出现顺序
+    QString m_resultDir;
+    QList<Row> m_rows;
+    QHash<int, int> m_jobRows;      // 任务ID -> 行号
+    int m_finished = 0;
+};
+
+#endif // PARAMETERSWEEP_H
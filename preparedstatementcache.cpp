@@ -0,0 +1,59 @@
+#include "preparedstatementcache.h"
+
+PreparedStatementCache::PreparedStatementCache(int capacity)
+    : m_capacity(capacity)
+{
+}
+
+PreparedStatementCache::~PreparedStatementCache()
+{
+    clear();
+}
+
+QSqlQuery PreparedStatementCache::statement(const QSqlDatabase &db, const QString &sql, bool *hit)
+{
+    auto it = m_statements.find(sql);
+    if (it != m_statements.end()) {
+        // 命中：移到LRU尾部
+        m_lruOrder.removeOne(sql);
+        m_lruOrder.append(sql);
+        if (hit) *hit = true;
+        return it.value();
+    }
+
+    if (hit) *hit = false;
+    QSqlQuery query(db);
+    if (!query.prepare(sql) || m_capacity <= 0) {
+        return query;
+    }
+
+    // 淘汰最久未使用的语句
+    while (m_statements.size() >= m_capacity && !m_lruOrder.isEmpty()) {
+        m_statements.remove(m_lruOrder.takeFirst());
+    }
+    m_statements.insert(sql, query);
+    m_lruOrder.append(sql);
+    return query;
+}
+
+void PreparedStatementCache::evict(const QString &sql)
+{
+    m_statements.remove(sql);
+    m_lruOrder.removeOne(sql);
+}
+
+void PreparedStatementCache::clear()
+{
+    m_statements.clear();
+    m_lruOrder.clear();
+}
+
+int PreparedStatementCache::size() const
+{
+    return m_statements.size();
+}
+
+int PreparedStatementCache::capacity() const
+{
+    return m_capacity;
+}
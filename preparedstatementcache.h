@@ -0,0 +1,33 @@
+#ifndef PREPAREDSTATEMENTCACHE_H
+#define PREPAREDSTATEMENTCACHE_H
+
+#include <QHash>
+#include <QStringList>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+// 预处理语句LRU缓存：按SQL文本缓存已prepare的QSqlQuery，重复执行时跳过服务端prepare往返
+// 每个实例只属于一条连接，仅由该连接所属线程访问，无需加锁
+class PreparedStatementCache
+{
+public:
+    explicit PreparedStatementCache(int capacity);
+    ~PreparedStatementCache();
+
+    // 获取已prepare的语句：命中直接返回，未命中则prepare后入缓存（prepare失败不入缓存）
+    QSqlQuery statement(const QSqlDatabase &db, const QString &sql, bool *hit = nullptr);
+    // 移除某条语句（执行失败、连接重连后语句句柄失效时使用）
+    void evict(const QString &sql);
+    // 清空缓存（关闭连接前必须调用，释放对连接的引用）
+    void clear();
+
+    int size() const;
+    int capacity() const;
+
+private:
+    int m_capacity;
+    QHash<QString, QSqlQuery> m_statements; // SQL文本 -> 已prepare的语句
+    QStringList m_lruOrder;                 // 尾部为最近使用
+};
+
+#endif // PREPAREDSTATEMENTCACHE_H
@@ -1,9 +1,18 @@
 #include "PythonRunner.h"
 #include <QDir>
+#include <QFile>
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QJsonDocument>
 #include <QStandardPaths>
+#include <QCoreApplication>
+#include <QSettings>
 #include "loghelper.h"
+#ifdef Q_OS_WIN
+#include <windows.h>
+#elif defined(Q_OS_LINUX)
+#include <sched.h>
+#endif
 
 PythonRunner::PythonRunner(QObject *parent) : QObject(parent) {
     m_process = new QProcess(this);
@@ -29,11 +38,20 @@ void PythonRunner::setScriptParams(const QJsonObject& params) {
     m_scriptParams = params;
 }
 
+void PythonRunner::setCpuAffinity(quint64 mask) {
+    m_cpuMask = mask;
+}
+
 bool PythonRunner::start() {
     if (m_scriptPath.isEmpty()) {
         emit logOutput("错误：Python脚本路径未设置");
         return false;
     }
+    m_stdoutBuffer.clear();
+    m_streamedMetrics = QJsonObject();
+    m_iteration = 0;
+    m_totalIterations = 0;
+    m_phase.clear();
 
     // 创建结果文件夹
     m_resultPath = createResultFolder();
@@ -53,21 +71,111 @@ bool PythonRunner::start() {
     paramsFile.write(doc.toJson(QJsonDocument::Indented));
     paramsFile.close();
 
-    // 构造Python执行命令
-    QString pythonExe = "python"; // 若系统未配置环境变量，需指定完整路径（如C:/Python39/python.exe）
     QStringList args = {
-        m_scriptPath,
         "--params_path", paramsPath,
         "--result_path", m_resultPath
     };
 
+    // 常驻工作进程可用时在其中执行，省去解释器启动和模块导入
+    if (m_worker && m_worker->isAvailable()) {
+        emit logOutput("在常驻Python进程中执行脚本：" + m_scriptPath + " " + args.join(" "));
+        m_runningInWorker = m_worker->run(m_scriptPath, args);
+        if (m_runningInWorker) {
+            return true;
+        }
+        emit logOutput("警告：常驻Python进程忙，改为启动新进程");
+    }
+
+    // 构造Python执行命令
+    QString pythonExe = pythonExecutable();
+    args.prepend(m_scriptPath);
+
+    // 多个脚本并行时，numpy/torch等默认按全部核数开线程会相互争抢，限制为绑定的核数
+    if (m_cpuMask != 0) {
+        m_process->setProcessEnvironment(threadLimitedEnvironment(m_cpuMask));
+    }
+
     emit logOutput("启动Python脚本：" + pythonExe + " " + args.join(" "));
     m_process->start(pythonExe, args);
 
-    return m_process->waitForStarted(3000);
+    if (!m_process->waitForStarted(3000)) {
+        return false;
+    }
+    if (m_cpuMask != 0 && !setProcessAffinity(m_process->processId(), m_cpuMask)) {
+        emit logOutput("警告：设置CPU亲和性失败，进程将由系统调度");
+    }
+    return true;
+}
+
+QString PythonRunner::pythonExecutable() {
+    // 若系统未配置环境变量，需在config.ini中指定完整路径（如C:/Python39/python.exe）
+    QSettings config(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+    return config.value("Runner/PythonExe", "python").toString();
+}
+
+QProcessEnvironment PythonRunner::threadLimitedEnvironment(quint64 mask) {
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    if (mask != 0) {
+        QString threads = QString::number(qPopulationCount(mask));
+        env.insert("OMP_NUM_THREADS", threads);
+        env.insert("MKL_NUM_THREADS", threads);
+        env.insert("OPENBLAS_NUM_THREADS", threads);
+    }
+    return env;
+}
+
+bool PythonRunner::setProcessAffinity(qint64 pid, quint64 mask) {
+    bool ok = false;
+#ifdef Q_OS_WIN
+    HANDLE process = OpenProcess(PROCESS_SET_INFORMATION | PROCESS_QUERY_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (process) {
+        ok = SetProcessAffinityMask(process, static_cast<DWORD_PTR>(mask));
+        CloseHandle(process);
+    }
+#elif defined(Q_OS_LINUX)
+    // 刚启动时解释器只有主线程，之后创建的线程继承该亲和性
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64; cpu++) {
+        if (mask & (quint64(1) << cpu)) CPU_SET(cpu, &set);
+    }
+    ok = (sched_setaffinity(static_cast<pid_t>(pid), sizeof(set), &set) == 0);
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(mask);
+#endif
+    return ok;
+}
+
+void PythonRunner::setWorker(PythonWorker* worker) {
+    if (m_worker) {
+        disconnect(m_worker, nullptr, this, nullptr);
+    }
+    m_worker = worker;
+    if (!m_worker) return;
+    connect(m_worker, &PythonWorker::output, this, [this](const QString& text) {
+        if (m_runningInWorker) appendStdout(text.toUtf8());
+    });
+    connect(m_worker, &PythonWorker::errorOutput, this, [this](const QString& text) {
+        if (m_runningInWorker) emit logOutput("Python错误：" + text);
+    });
+    connect(m_worker, &PythonWorker::jobFinished, this, [this](int exitCode, const QString& error) {
+        if (!m_runningInWorker) return;
+        m_runningInWorker = false;
+        if (!error.isEmpty()) {
+            emit logOutput("Python错误：" + error);
+        }
+        onProcessFinished(exitCode, exitCode < 0 ? QProcess::CrashExit : QProcess::NormalExit);
+    });
 }
 
 void PythonRunner::stop() {
+    if (m_runningInWorker) {
+        // abort同步发出jobFinished，经onProcessFinished通知调用方
+        m_worker->abort();
+        emit logOutput("Python脚本已终止");
+        return;
+    }
     if (m_process->state() == QProcess::Running) {
         m_process->kill();
         m_process->waitForFinished();
@@ -79,6 +187,15 @@ void PythonRunner::onProcessFinished(int exitCode, QProcess::ExitStatus exitStat
     QDateTime execTime = QDateTime::currentDateTime();
     QString metricsData = "";
 
+    // 处理剩余输出（最后一行可能没有换行）
+    if (!m_stdoutBuffer.isEmpty()) {
+        QByteArray rest = m_stdoutBuffer;
+        m_stdoutBuffer.clear();
+        if (!handleEventLine(rest.trimmed())) {
+            emit logOutput("Python输出：" + QString::fromUtf8(rest));
+        }
+    }
+
     if (exitStatus == QProcess::CrashExit || exitCode != 0) {
         emit logOutput("错误：Python脚本执行失败，退出码：" + QString::number(exitCode));
         emit finished(false, execTime, metricsData);
@@ -93,6 +210,10 @@ void PythonRunner::onProcessFinished(int exitCode, QProcess::ExitStatus exitStat
         metricsData = QString(data);
         metricsFile.close();
         emit logOutput("成功读取指标数据：" + metricsPath);
+    } else if (!m_streamedMetrics.isEmpty()) {
+        // 脚本未写metrics.json时使用运行中上报的指标
+        metricsData = QString::fromUtf8(QJsonDocument(m_streamedMetrics).toJson(QJsonDocument::Compact));
+        emit logOutput("未找到指标文件，使用运行中上报的指标：" + metricsPath);
     } else {
         emit logOutput("警告：未找到指标文件：" + metricsPath);
     }
@@ -102,8 +223,79 @@ void PythonRunner::onProcessFinished(int exitCode, QProcess::ExitStatus exitStat
 }
 
 void PythonRunner::onReadyReadStandardOutput() {
-    QString output = QString::fromUtf8(m_process->readAllStandardOutput());
-    emit logOutput("Python输出：" + output);
+    appendStdout(m_process->readAllStandardOutput());
+}
+
+void PythonRunner::appendStdout(const QByteArray& data) {
+    m_stdoutBuffer.append(data);
+
+    // 按行切分（输出块可能在任意位置截断），事件行转为信号，其余行作为日志
+    QStringList lines;
+    int newline;
+    while ((newline = m_stdoutBuffer.indexOf('\n')) >= 0) {
+        QByteArray line = m_stdoutBuffer.left(newline);
+        m_stdoutBuffer.remove(0, newline + 1);
+        if (line.endsWith('\r')) line.chop(1);
+        if (!handleEventLine(line.trimmed())) {
+            lines << QString::fromUtf8(line);
+        }
+    }
+
+    // 不是事件的未完整行（如\r刷新的进度条）直接输出，保证日志实时；末尾不完整的UTF-8字符留到下次
+    QByteArray pending = m_stdoutBuffer.trimmed();
+    if (!pending.isEmpty() && !pending.startsWith('{')) {
+        int keep = incompleteUtf8Tail(m_stdoutBuffer);
+        lines << QString::fromUtf8(m_stdoutBuffer.left(m_stdoutBuffer.size() - keep));
+        m_stdoutBuffer.remove(0, m_stdoutBuffer.size() - keep);
+    }
+
+    if (!lines.isEmpty()) {
+        emit logOutput("Python输出：" + lines.join("\n"));
+    }
+}
+
+bool PythonRunner::handleEventLine(const QByteArray& line) {
+    if (!line.startsWith('{') || !line.endsWith('}')) return false;
+    QJsonParseError error;
+    QJsonObject event = QJsonDocument::fromJson(line, &error).object();
+    if (error.error != QJsonParseError::NoError || !event.value("event").isString()) return false;
+
+    QString type = event.value("event").toString();
+    if (type == "progress") {
+        m_iteration = event.value("iteration").toInt(m_iteration);
+        m_totalIterations = event.value("total").toInt(m_totalIterations);
+        m_phase = event.value("phase").toString(m_phase);
+        emit progress(m_iteration, m_totalIterations, m_phase);
+    } else if (type == "phase") {
+        m_phase = event.value("phase").toString(m_phase);
+        emit progress(m_iteration, m_totalIterations, m_phase);
+    } else if (type == "loss") {
+        m_iteration = event.value("iteration").toInt(m_iteration);
+        emit lossReported(m_iteration, event.value("values").toObject());
+    } else if (type == "metrics") {
+        // 部分指标逐次合并，后上报的覆盖先上报的
+        QJsonObject metrics = event.value("metrics").toObject();
+        for (auto it = metrics.constBegin(); it != metrics.constEnd(); ++it) {
+            m_streamedMetrics[it.key()] = it.value();
+        }
+        emit metricsUpdated(m_streamedMetrics);
+    } else if (type == "log") {
+        emit logOutput("Python输出：" + event.value("message").toString());
+    } else {
+        // 未知事件按普通输出显示，便于脚本调试
+        return false;
+    }
+    return true;
+}
+
+int PythonRunner::incompleteUtf8Tail(const QByteArray& data) {
+    for (int i = data.size() - 1; i >= qMax(0, data.size() - 3); i--) {
+        uchar c = static_cast<uchar>(data.at(i));
+        if ((c & 0xC0) == 0x80) continue;          // 后续字节
+        int length = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+        return data.size() - i < length ? data.size() - i : 0;
+    }
+    return 0;
 }
 
 void PythonRunner::onReadyReadStandardError() {
@@ -111,13 +303,28 @@ void PythonRunner::onReadyReadStandardError() {
     emit logOutput("Python错误：" + error);
 }
 
+QString PythonRunner::scriptHash(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return "";
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return "";
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
 QString PythonRunner::createResultFolder() {
-    // 生成唯一的文件夹名称（基于时间）
-    QString timeStr = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss");
+    // 生成唯一的文件夹名称（基于时间；并行启动时同一毫秒内可能重名，追加序号）
+    QString timeStr = QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz");
     QString basePath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/TestResults";
     QString folderPath = basePath + "/" + timeStr;
+    QDir dir(basePath);
+    for (int i = 1; dir.exists(folderPath); i++) {
+        folderPath = QString("%1/%2_%3").arg(basePath, timeStr).arg(i);
+    }
 
-    QDir dir;
     if (!dir.mkpath(folderPath)) {
         return "";
     }
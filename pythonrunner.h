@@ -5,7 +5,19 @@
 #include <QProcess>
 #include <QJsonObject>
 #include <QDateTime>
+#include <QProcessEnvironment>
+#include "pythonworker.h"
 
+/**
+ * @brief Python算法脚本运行器
+ * 脚本的标准输出中，单独一行的JSON对象且带有"event"字段时视为进度事件，转为对应信号（不再作为日志输出）：
+ *   {"event": "progress", "iteration": 120, "total": 5000, "phase": "learner"}
+ *   {"event": "phase", "phase": "falsifier"}
+ *   {"event": "loss", "iteration": 120, "values": {"loss": 0.12, "lie": 0.03}}
+ *   {"event": "metrics", "metrics": {"overshoot": 1.2}}      // 部分指标，逐次合并
+ *   {"event": "log", "message": "..."}
+ * Python端每个事件 print(json.dumps(event), flush=True) 即可；脚本未写metrics.json时使用上报的指标。
+ */
 class PythonRunner : public QObject
 {
     Q_OBJECT
@@ -16,6 +28,10 @@ public:
     // 设置Python脚本路径和参数
     void setScriptPath(const QString& path);
     void setScriptParams(const QJsonObject& params);
+    // 绑定运行的CPU（位掩码，0=不绑定）；绑定时数值库线程数限制为绑定的核数
+    void setCpuAffinity(quint64 mask);
+    // 在常驻Python进程中执行（nullptr或进程不可用时每次启动新进程）；worker由调用方持有
+    void setWorker(PythonWorker* worker);
 
     // 启动Python脚本
     bool start();
@@ -26,11 +42,28 @@ public:
     // 获取结果保存路径
     QString getResultPath() const { return m_resultPath; }
 
+    // 脚本文件内容的SHA-256（十六进制），读取失败返回空
+    static QString scriptHash(const QString& path);
+    // Python解释器路径（config.ini [Runner] PythonExe，默认python）
+    static QString pythonExecutable();
+    // 按绑定的核数限制OMP/MKL/OpenBLAS线程数的环境变量（mask=0时不限制）
+    static QProcessEnvironment threadLimitedEnvironment(quint64 mask);
+    // 设置进程的CPU亲和性，返回是否成功
+    static bool setProcessAffinity(qint64 pid, quint64 mask);
+    // 末尾不完整的UTF-8字符的字节数（分块输出时留到下一块再解码）
+    static int incompleteUtf8Tail(const QByteArray& data);
+
 signals:
     // 脚本执行完成（成功/失败，执行时间，指标数据JSON）
     void finished(bool success, const QDateTime& execTime, const QString& metricsData);
     // 输出日志
     void logOutput(const QString& log);
+    // 运行进度（phase为当前阶段，total未知时为0）
+    void progress(int iteration, int total, const QString& phase);
+    // 损失值
+    void lossReported(int iteration, const QJsonObject& values);
+    // 运行中上报的指标（已合并的全部指标）
+    void metricsUpdated(const QJsonObject& metrics);
 
 private slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
@@ -42,9 +75,23 @@ private:
     QString m_scriptPath;
     QJsonObject m_scriptParams;
     QString m_resultPath;
+    quint64 m_cpuMask = 0;
+    PythonWorker* m_worker = nullptr;
+    bool m_runningInWorker = false;
+
+    // 标准输出的行缓冲和进度事件状态
+    QByteArray m_stdoutBuffer;
+    QJsonObject m_streamedMetrics;
+    int m_iteration = 0;
+    int m_totalIterations = 0;
+    QString m_phase;
 
     // 创建结果文件夹
     QString createResultFolder();
+    // 追加标准输出，按行解析进度事件
+    void appendStdout(const QByteArray& data);
+    // 解析一行进度事件，不是事件时返回false
+    bool handleEventLine(const QByteArray& line);
 };
 
 #endif // PYTHONRUNNER_H
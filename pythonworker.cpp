@@ -0,0 +1,341 @@
+#include "pythonworker.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+#include "pythonrunner.h"
+#include "loghelper.h"
+
+// 与worker_host.py中的FRAME_MARKER一致
+static const QByteArray FRAME_MARKER("\x1e@worker ");
+// 未就绪即退出的连续次数达到该值时停用常驻进程
+static const int MAX_QUICK_FAILURES = 3;
+
+PythonWorker::PythonWorker(QObject *parent)
+    : QObject(parent),
+      m_process(new QProcess(this)),
+      m_healthTimer(new QTimer(this))
+{
+    QSettings config(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+    m_healthIntervalMs = qMax(500, config.value("Runner/HealthCheckMs", 5000).toInt());
+    m_maxJobs = qMax(0, config.value("Runner/MaxJobsPerWorker", 50).toInt());
+    m_jobTimeoutMs = qMax(0, config.value("Runner/JobTimeoutSec", 0).toInt()) * qint64(1000);
+
+    typedef void (QProcess::*FinishedSignal)(int, QProcess::ExitStatus);
+    FinishedSignal signal = &QProcess::finished;
+    connect(m_process, signal, this, &PythonWorker::onProcessFinished);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &PythonWorker::onReadyReadStandardOutput);
+    connect(m_process, &QProcess::readyReadStandardError, this, &PythonWorker::onReadyReadStandardError);
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        // 解释器不存在等启动失败不会触发finished，按异常退出处理
+        if (error == QProcess::FailedToStart) {
+            onProcessFinished(-1, QProcess::CrashExit);
+        }
+    });
+    connect(m_process, &QProcess::started, this, [this]() {
+        if (m_processMask != 0 && !PythonRunner::setProcessAffinity(m_process->processId(), m_processMask)) {
+            LOG_WARN("算法模块", "【常驻进程】设置CPU亲和性失败，进程将由系统调度");
+        }
+    });
+
+    m_healthTimer->setInterval(m_healthIntervalMs);
+    connect(m_healthTimer, &QTimer::timeout, this, &PythonWorker::onHealthCheck);
+}
+
+PythonWorker::~PythonWorker()
+{
+    shutdown();
+}
+
+void PythonWorker::setCpuAffinity(quint64 mask)
+{
+    m_cpuMask = mask;
+    // 线程数环境变量只能在启动时设置，空闲时直接按新掩码重启
+    if (m_process->state() != QProcess::NotRunning && !m_busy && m_processMask != mask) {
+        m_restarting = true;
+        m_restartReason.clear();
+        m_process->kill();
+        m_process->waitForFinished();
+    }
+}
+
+bool PythonWorker::ensureStarted()
+{
+    if (!m_available || m_shuttingDown) return false;
+    if (m_process->state() == QProcess::NotRunning) {
+        startProcess();
+    }
+    return true;
+}
+
+void PythonWorker::startProcess()
+{
+    QString hostScript = hostScriptPath();
+    if (hostScript.isEmpty()) {
+        LOG_ERROR("算法模块", "【常驻进程】释放worker_host.py失败，改为每次启动新进程");
+        m_available = false;
+        return;
+    }
+
+    QProcessEnvironment env = PythonRunner::threadLimitedEnvironment(m_cpuMask);
+    env.insert("PYTHONUNBUFFERED", "1");
+    env.insert("PYTHONIOENCODING", "utf-8");
+    env.insert("WORKER_MAX_JOBS", QString::number(m_maxJobs));
+    m_process->setProcessEnvironment(env);
+
+    m_processMask = m_cpuMask;
+    m_ready = false;
+    m_exiting = false;
+    m_stdoutBuffer.clear();
+    m_heldNewline = false;
+    m_atLineStart = true;
+    m_startedAt.start();
+    m_lastPong.start();
+    m_process->start(PythonRunner::pythonExecutable(), { "-u", hostScript });
+    m_healthTimer->start();
+}
+
+bool PythonWorker::run(const QString& scriptPath, const QStringList& args)
+{
+    if (m_busy || !ensureStarted()) return false;
+    m_busy = true;
+    m_pendingScript = scriptPath;
+    m_pendingArgs = args;
+    m_hasPending = true;
+    if (m_ready) {
+        sendPendingJob();
+    }
+    return true;
+}
+
+void PythonWorker::sendPendingJob()
+{
+    if (!m_hasPending) return;
+    m_hasPending = false;
+    QJsonObject message;
+    message["type"] = "run";
+    message["job"] = ++m_jobSeq;
+    message["script"] = m_pendingScript;
+    message["argv"] = QJsonArray::fromStringList(m_pendingArgs);
+    sendMessage(message);
+    m_jobStartedAt.start();
+}
+
+void PythonWorker::sendMessage(const QJsonObject& message)
+{
+    m_process->write(QJsonDocument(message).toJson(QJsonDocument::Compact) + "\n");
+}
+
+void PythonWorker::abort()
+{
+    if (!m_busy) return;
+    // 无法安全中断解释器内正在执行的脚本，直接终止进程，退出后立即重启预热
+    m_restarting = true;
+    m_restartReason.clear();
+    if (m_process->state() != QProcess::NotRunning) {
+        m_process->kill();
+        m_process->waitForFinished();
+    } else {
+        onProcessFinished(-1, QProcess::CrashExit);
+    }
+}
+
+void PythonWorker::shutdown()
+{
+    m_shuttingDown = true;
+    m_healthTimer->stop();
+    if (m_process->state() == QProcess::NotRunning) return;
+    QJsonObject message;
+    message["type"] = "exit";
+    sendMessage(message);
+    m_process->closeWriteChannel();
+    if (!m_process->waitForFinished(2000)) {
+        m_process->kill();
+        m_process->waitForFinished();
+    }
+}
+
+void PythonWorker::onReadyReadStandardOutput()
+{
+    m_stdoutBuffer.append(m_process->readAllStandardOutput());
+    int newline;
+    while ((newline = m_stdoutBuffer.indexOf('\n')) >= 0) {
+        QByteArray line = m_stdoutBuffer.left(newline);
+        m_stdoutBuffer.remove(0, newline + 1);
+
+        int pos = line.indexOf(FRAME_MARKER);
+        if (pos < 0) {
+            // Windows下Python文本模式输出为\r\n
+            if ((line.isEmpty() || line == "\r") && !m_heldNewline) {
+                m_heldNewline = true;
+                continue;
+            }
+            emitText(line + "\n");
+            continue;
+        }
+        // 协议帧：帧前的空行是worker_host写入的分隔，不属于脚本输出
+        m_heldNewline = false;
+        if (pos > 0) {
+            emitText(line.left(pos));
+        }
+        if (!m_atLineStart) {
+            emitText("\n");
+        }
+        handleFrame(line.mid(pos + FRAME_MARKER.size()).trimmed());
+    }
+
+    // 不含帧标记的未完整行（如进度条）直接输出，保证日志实时；末尾不完整的UTF-8字符留到下次
+    if (!m_stdoutBuffer.isEmpty() && !m_stdoutBuffer.contains('\x1e')) {
+        int keep = PythonRunner::incompleteUtf8Tail(m_stdoutBuffer);
+        emitText(m_stdoutBuffer.left(m_stdoutBuffer.size() - keep));
+        m_stdoutBuffer.remove(0, m_stdoutBuffer.size() - keep);
+    }
+}
+
+void PythonWorker::emitText(const QByteArray& text)
+{
+    if (text.isEmpty()) return;
+    if (m_heldNewline) {
+        m_heldNewline = false;
+        emitText("\n");
+    }
+    m_atLineStart = text.endsWith('\n');
+    if (m_busy) {
+        emit output(QString::fromUtf8(text));
+    }
+}
+
+void PythonWorker::onReadyReadStandardError()
+{
+    QString text = QString::fromUtf8(m_process->readAllStandardError());
+    if (m_busy) {
+        emit errorOutput(text);
+    } else {
+        LOG_DEBUG("算法模块", "【常驻进程】" << text);
+    }
+}
+
+void PythonWorker::handleFrame(const QByteArray& json)
+{
+    QJsonObject frame = QJsonDocument::fromJson(json).object();
+    QString type = frame.value("type").toString();
+    if (type == "ready") {
+        m_ready = true;
+        m_quickFailures = 0;
+        m_lastPong.start();
+        LOG_INFO("算法模块", "【常驻进程】就绪：pid=" << frame.value("pid").toInt()
+                 << "，Python " << frame.value("python").toString()
+                 << "，启动耗时" << m_startedAt.elapsed() << "ms");
+        sendPendingJob();
+    } else if (type == "pong") {
+        m_lastPong.start();
+    } else if (type == "done" && m_busy) {
+        m_busy = false;
+        // 运行期间不检查心跳，回到空闲后重新计时
+        m_lastPong.start();
+        if (frame.value("exiting").toBool()) {
+            // 已达任务数上限，进程随后自行退出；此后的任务保留到重启后的ready再发送
+            m_ready = false;
+            m_exiting = true;
+        }
+        emit jobFinished(frame.value("exit_code").toInt(1), frame.value("error").toString());
+    }
+}
+
+void PythonWorker::onHealthCheck()
+{
+    if (m_process->state() != QProcess::Running) return;
+    if (m_busy && !m_hasPending) {
+        // 脚本在C扩展中长时间持有GIL（如dReal求解）时应答线程无法回复，运行期间只看进程存活和任务超时
+        if (m_jobTimeoutMs > 0 && m_jobStartedAt.elapsed() > m_jobTimeoutMs) {
+            LOG_ERROR("算法模块", "【常驻进程】任务运行超过" << m_jobTimeoutMs / 1000 << "秒，终止并重启");
+            m_restarting = true;
+            m_restartReason = QString("任务运行超时（%1秒），已终止").arg(m_jobTimeoutMs / 1000);
+            m_process->kill();
+        }
+        return;
+    }
+    // 空闲时连续3个周期没有应答（未就绪时放宽到6个周期，首次导入较慢）视为卡死
+    qint64 limit = m_healthIntervalMs * (m_ready ? 3 : 6);
+    if (m_lastPong.elapsed() > limit) {
+        LOG_ERROR("算法模块", "【常驻进程】心跳超时" << m_lastPong.elapsed() << "ms，终止并重启");
+        m_restarting = true;
+        m_restartReason = "常驻Python进程心跳超时，已终止";
+        m_process->kill();
+        return;
+    }
+    if (m_ready) {
+        QJsonObject ping;
+        ping["type"] = "ping";
+        ping["id"] = ++m_pingSeq;
+        sendMessage(ping);
+    }
+}
+
+void PythonWorker::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    m_healthTimer->stop();
+    bool wasReady = m_ready || m_exiting;
+    // 中断任务/重绑CPU为主动终止；心跳超时带有原因，按异常处理
+    bool requested = m_restarting && m_restartReason.isEmpty();
+    // 达到任务数上限后的正常退出：尚未发送的任务留到重启后执行
+    bool recycled = m_exiting && !m_restarting && exitStatus == QProcess::NormalExit && exitCode == 0;
+    QString error = m_restarting ? m_restartReason : QString("常驻Python进程异常退出（退出码%1）").arg(exitCode);
+    m_ready = false;
+    m_exiting = false;
+    m_restarting = false;
+    m_restartReason.clear();
+
+    if (m_busy && !(recycled && m_hasPending)) {
+        m_busy = false;
+        m_hasPending = false;
+        emit jobFinished(-1, error);
+    }
+    if (m_shuttingDown) return;
+
+    if (!wasReady && !requested) {
+        // 未就绪即退出：解释器路径错误、worker_host无法运行等，连续多次后停用
+        if (++m_quickFailures >= MAX_QUICK_FAILURES) {
+            m_available = false;
+            LOG_ERROR("算法模块", "【常驻进程】连续" << m_quickFailures << "次启动失败，改为每次启动新进程");
+            return;
+        }
+    } else if (recycled) {
+        LOG_DEBUG("算法模块", "【常驻进程】已达单进程任务数上限，重启");
+    }
+
+    // 立即重启预热，下一个任务无需等待导入；启动失败时稍后重试
+    QTimer::singleShot(requested || wasReady ? 0 : 1000, this, [this]() {
+        if (!m_shuttingDown && m_available && m_process->state() == QProcess::NotRunning) {
+            startProcess();
+        }
+    });
+}
+
+QString PythonWorker::hostScriptPath()
+{
+    // 随资源分发，首次使用或程序更新后释放到本地数据目录
+    QFile resource(":/python/static/python/worker_host.py");
+    if (!resource.open(QIODevice::ReadOnly)) {
+        return "";
+    }
+    QByteArray content = resource.readAll();
+
+    QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QString path = dirPath + "/worker_host.py";
+    QFile existing(path);
+    if (existing.open(QIODevice::ReadOnly) && existing.readAll() == content) {
+        return path;
+    }
+    existing.close();
+    QDir().mkpath(dirPath);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(content) != content.size()) {
+        return "";
+    }
+    return path;
+}
@@ -0,0 +1,98 @@
+#ifndef PYTHONWORKER_H
+#define PYTHONWORKER_H
+
+#include <QObject>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QJsonObject>
+
+class QTimer;
+
+/**
+ * @brief 常驻Python工作进程（预热解释器）
+ * 启动一个长期运行的 worker_host.py，依次在同一解释器内执行算法脚本，
+ * torch等重量级模块只导入一次。stdin/stdout上使用按行分帧的JSON协议（见worker_host.py），
+ * 空闲时定时心跳检测进程是否卡死，任务运行期间只检查进程存活和任务超时；
+ * 异常退出后自动重启；连续启动失败时停用，由PythonRunner回退为单次进程。
+ * 配置见config.ini [Runner]：WarmWorkers / HealthCheckMs / MaxJobsPerWorker / JobTimeoutSec。
+ */
+class PythonWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PythonWorker(QObject *parent = nullptr);
+    ~PythonWorker() override;
+
+    // 绑定的CPU（位掩码，0=不绑定）；与当前进程不同时空闲后重启生效
+    void setCpuAffinity(quint64 mask);
+    quint64 cpuAffinity() const { return m_cpuMask; }
+
+    // 启动常驻进程（异步，收到ready帧后可执行任务）
+    bool ensureStarted();
+    // 未因连续启动失败而停用
+    bool isAvailable() const { return m_available; }
+    bool isBusy() const { return m_busy; }
+
+    // 执行脚本（进程尚未就绪时在就绪后发送）；已有任务在运行时返回false
+    bool run(const QString& scriptPath, const QStringList& args);
+    // 中断当前任务：终止进程后重启，同步发出jobFinished
+    void abort();
+    // 退出常驻进程，不再重启
+    void shutdown();
+
+signals:
+    // 当前任务的标准输出/错误输出（保持原始换行）
+    void output(const QString& text);
+    void errorOutput(const QString& text);
+    // 当前任务结束；进程异常退出时exitCode为-1
+    void jobFinished(int exitCode, const QString& error);
+
+private slots:
+    void onReadyReadStandardOutput();
+    void onReadyReadStandardError();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onHealthCheck();
+
+private:
+    void startProcess();
+    void handleFrame(const QByteArray& json);
+    void sendMessage(const QJsonObject& message);
+    void sendPendingJob();
+    // 输出一段脚本文本（处理协议帧前的分隔换行）
+    void emitText(const QByteArray& text);
+    // 释放资源中的worker_host.py到本地目录，返回路径
+    static QString hostScriptPath();
+
+    QProcess* m_process;
+    QTimer* m_healthTimer;
+    QByteArray m_stdoutBuffer;
+    bool m_heldNewline = false;     // 暂存的空行（可能是协议帧前的分隔）
+    bool m_atLineStart = true;      // 已输出文本是否以换行结尾
+
+    quint64 m_cpuMask = 0;
+    quint64 m_processMask = 0;      // 当前进程启动时的掩码
+    bool m_ready = false;
+    bool m_exiting = false;         // 已收到带exiting的done帧，进程即将自行退出
+    bool m_busy = false;
+    bool m_available = true;
+    bool m_shuttingDown = false;
+    bool m_restarting = false;      // 由本对象终止进程，退出后立即重启
+    QString m_restartReason;        // 终止原因（中断/重绑CPU为空，心跳超时时作为任务错误信息）
+    int m_quickFailures = 0;        // 未就绪即退出的连续次数
+    int m_jobSeq = 0;
+    int m_pingSeq = 0;
+    QElapsedTimer m_startedAt;
+    QElapsedTimer m_lastPong;
+    QElapsedTimer m_jobStartedAt;   // 当前任务发送给进程的时间
+
+    QString m_pendingScript;        // 等待进程就绪的任务
+    QStringList m_pendingArgs;
+    bool m_hasPending = false;
+
+    int m_healthIntervalMs = 5000;
+    int m_maxJobs = 50;
+    qint64 m_jobTimeoutMs = 0;      // 单个任务最长运行时间，0为不限
+};
+
+#endif // PYTHONWORKER_H
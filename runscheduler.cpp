@@ -0,0 +1,238 @@
+#include "runscheduler.h"
+#include <QCoreApplication>
+#include <QSettings>
+#include <QThread>
+#include <QTimer>
+#include "pythonrunner.h"
+#include "pythonworker.h"
+#include "loghelper.h"
+
+RunScheduler* RunScheduler::m_instance = nullptr;
+
+RunScheduler* RunScheduler::getInstance()
+{
+    // 仅在界面线程使用；挂在应用对象下，退出时终止仍在运行的进程
+    if (m_instance == nullptr) {
+        m_instance = new RunScheduler(QCoreApplication::instance());
+    }
+    return m_instance;
+}
+
+RunScheduler::RunScheduler(QObject *parent) : QObject(parent)
+{
+    m_testDbHelper = TestDbHelper::getInstance();
+
+    QSettings config(QCoreApplication::applicationDirPath() + "/config.ini", QSettings::IniFormat);
+    config.beginGroup("Runner");
+    setMaxWorkers(config.value("MaxWorkers", 0).toInt());
+    m_pinCpu = config.value("PinCpu", true).toBool();
+    m_warmWorkers = config.value("WarmWorkers", true).toBool();
+    config.endGroup();
+    LOG_INFO("算法模块", "【调度】并行进程数=" << m_maxWorkers << "，绑定CPU=" << m_pinCpu
+             << "，常驻进程=" << m_warmWorkers << "，CPU核数=" << QThread::idealThreadCount());
+}
+
+void RunScheduler::setMaxWorkers(int workers)
+{
+    m_maxWorkers = workers > 0 ? workers : qMax(1, QThread::idealThreadCount());
+    trimWorkers();
+    dispatch();
+}
+
+int RunScheduler::enqueue(const QString& scriptPath, const QJsonObject& params, const TestRecord& record)
+{
+    RunJob job;
+    job.jobId = m_nextJobId++;
+    job.scriptPath = scriptPath;
+    job.params = params;
+    job.record = record;
+    m_pending.append(job);
+    // 延后启动：调用方先拿到任务ID，再收到该任务的jobStarted/jobFinished
+    scheduleDispatch();
+    emit queueChanged(m_running.size(), m_pending.size());
+    return job.jobId;
+}
+
+bool RunScheduler::cancel(int jobId)
+{
+    for (int i = 0; i < m_pending.size(); i++) {
+        if (m_pending.at(i).jobId == jobId) {
+            RunJob job = m_pending.takeAt(i);
+            finishRecord(job.record, "手动中断");
+            emit jobResult(job.jobId, job.record);
+            emit jobFinished(job.jobId, job.record.test_id, false);
+            emit queueChanged(m_running.size(), m_pending.size());
+            return true;
+        }
+    }
+
+    auto it = m_running.find(jobId);
+    if (it == m_running.end()) return false;
+    it->cancelled = true;
+    // stop()同步等待进程退出，结束处理在onRunnerFinished中完成
+    PythonRunner* runner = it->runner;
+    runner->stop();
+    return true;
+}
+
+void RunScheduler::cancelAll()
+{
+    // 先取消排队的任务，避免终止运行中的任务时又启动新的
+    QList<int> jobIds;
+    for (const RunJob& job : m_pending) jobIds << job.jobId;
+    jobIds << m_running.keys();
+    for (int jobId : jobIds) {
+        cancel(jobId);
+    }
+}
+
+int RunScheduler::freeSlot() const
+{
+    QList<int> used;
+    for (const Worker& worker : m_running) used << worker.slot;
+    for (int slot = 0; slot < m_maxWorkers; slot++) {
+        if (!used.contains(slot)) return slot;
+    }
+    return -1;
+}
+
+PythonWorker* RunScheduler::workerOf(int slot)
+{
+    if (!m_warmWorkers) return nullptr;
+    if (m_workers.size() <= slot) {
+        m_workers.resize(slot + 1);
+    }
+    if (!m_workers[slot]) {
+        m_workers[slot] = new PythonWorker(this);
+    }
+    // 并行数变化后槽位绑定的核也会变，常驻进程按新掩码重启
+    m_workers[slot]->setCpuAffinity(affinityMaskOf(slot));
+    return m_workers[slot];
+}
+
+void RunScheduler::trimWorkers()
+{
+    for (int slot = m_maxWorkers; slot < m_workers.size(); slot++) {
+        if (m_workers[slot] && !m_workers[slot]->isBusy()) {
+            // 可能正处于该进程发出的jobFinished调用链中，延后释放
+            m_workers[slot]->deleteLater();
+            m_workers[slot] = nullptr;
+        }
+    }
+    while (!m_workers.isEmpty() && !m_workers.last()) {
+        m_workers.removeLast();
+    }
+}
+
+quint64 RunScheduler::affinityMaskOf(int slot) const
+{
+    if (!m_pinCpu) return 0;
+    int cores = qMin(64, QThread::idealThreadCount());
+    if (cores <= 1 || m_maxWorkers > cores) return 0; // 进程数多于核数时交给系统调度
+    int perWorker = cores / m_maxWorkers;
+    quint64 mask = 0;
+    for (int i = 0; i < perWorker; i++) {
+        mask |= quint64(1) << (slot * perWorker + i);
+    }
+    return mask;
+}
+
+void RunScheduler::scheduleDispatch()
+{
+    if (m_dispatchScheduled) return;
+    m_dispatchScheduled = true;
+    QTimer::singleShot(0, this, [this]() {
+        m_dispatchScheduled = false;
+        dispatch();
+    });
+}
+
+void RunScheduler::dispatch()
+{
+    while (!m_pending.isEmpty() && m_running.size() < m_maxWorkers) {
+        int slot = freeSlot();
+        if (slot < 0) break;
+
+        Worker worker;
+        worker.job = m_pending.takeFirst();
+        worker.slot = slot;
+        worker.runner = new PythonRunner(this);
+        worker.runner->setScriptPath(worker.job.scriptPath);
+        worker.runner->setScriptParams(worker.job.params);
+        worker.runner->setCpuAffinity(affinityMaskOf(slot));
+        worker.runner->setWorker(workerOf(slot));
+
+        int jobId = worker.job.jobId;
+        connect(worker.runner, &PythonRunner::logOutput, this, [this, jobId](const QString& log) {
+            emit jobLog(jobId, log);
+        });
+        connect(worker.runner, &PythonRunner::progress, this, [this, jobId](int iteration, int total, const QString& phase) {
+            emit jobProgress(jobId, iteration, total, phase);
+        });
+        connect(worker.runner, &PythonRunner::lossReported, this, [this, jobId](int iteration, const QJsonObject& values) {
+            emit jobLoss(jobId, iteration, values);
+        });
+        connect(worker.runner, &PythonRunner::metricsUpdated, this, [this, jobId](const QJsonObject& metrics) {
+            emit jobMetrics(jobId, metrics);
+        });
+        connect(worker.runner, &PythonRunner::finished, this,
+                [this, jobId](bool success, const QDateTime& execTime, const QString& metricsData) {
+            onRunnerFinished(jobId, success, execTime, metricsData);
+        });
+        m_running.insert(jobId, worker);
+
+        if (!worker.runner->start()) {
+            Worker failed = m_running.take(jobId);
+            failed.runner->deleteLater();
+            LOG_ERROR("算法模块", "【调度】任务启动失败：test_id=" << failed.job.record.test_id);
+            finishRecord(failed.job.record, "启动失败");
+            emit jobResult(jobId, failed.job.record);
+            emit jobFinished(jobId, failed.job.record.test_id, false);
+            continue;
+        }
+
+        TestRecord& record = m_running[jobId].job.record;
+        record.result_path = worker.runner->getResultPath();
+        record.execute_time = QDateTime::currentDateTime();
+        record.remark = "运行中";
+        m_testDbHelper->updateTestRecord(record);
+        LOG_INFO("算法模块", "【调度】任务开始：test_id=" << record.test_id << "，工作槽=" << slot
+                 << "，运行中=" << m_running.size() << "，排队=" << m_pending.size());
+        emit jobStarted(jobId, record.test_id);
+    }
+    emit queueChanged(m_running.size(), m_pending.size());
+}
+
+void RunScheduler::onRunnerFinished(int jobId, bool success, const QDateTime& execTime, const QString& metricsData)
+{
+    auto it = m_running.find(jobId);
+    if (it == m_running.end()) return;
+    Worker worker = m_running.take(jobId);
+    worker.runner->deleteLater();
+
+    TestRecord& record = worker.job.record;
+    record.execute_time = execTime;
+    record.metrics_data = metricsData;
+    if (worker.cancelled) {
+        finishRecord(record, "手动中断");
+    } else {
+        finishRecord(record, success ? "执行成功" : "执行失败");
+    }
+    LOG_INFO("算法模块", "【调度】任务结束：test_id=" << record.test_id << "，备注=" << record.remark);
+    emit jobResult(jobId, record);
+    emit jobFinished(jobId, record.test_id, success && !worker.cancelled);
+
+    trimWorkers();
+    dispatch();
+}
+
+void RunScheduler::finishRecord(TestRecord& record, const QString& remark)
+{
+    record.remark = remark;
+    if (!record.execute_time.isValid()) {
+        record.execute_time = QDateTime::currentDateTime();
+    }
+    if (!m_testDbHelper->updateTestRecord(record)) {
+        LOG_ERROR("算法模块", "【调度】更新测试记录失败：test_id=" << record.test_id);
+    }
+}
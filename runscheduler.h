@@ -0,0 +1,96 @@
+#ifndef RUNSCHEDULER_H
+#define RUNSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QJsonObject>
+#include "testdbhelper.h"
+
+class PythonRunner;
+class PythonWorker;
+
+/**
+ * @brief 算法运行调度器（全局单例，不随界面切换销毁）
+ * 排队执行多个 (参数, 脚本) 任务，同时最多运行 maxWorkers 个Python进程；
+ * 每个工作槽绑定一组固定的CPU核，任务开始/结束时按test_id更新对应的test_records行。
+ * 开启WarmWorkers时每个工作槽保留一个常驻Python进程，连续的任务不再重复启动解释器。
+ * 配置见config.ini [Runner]。
+ */
+class RunScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    static RunScheduler* getInstance();
+
+    // 并行进程数（<=0 时取CPU核数）
+    void setMaxWorkers(int workers);
+    int maxWorkers() const { return m_maxWorkers; }
+
+    // 排队一个任务：record须已入库（test_id有效），返回任务ID；任务在下一次事件循环中启动
+    int enqueue(const QString& scriptPath, const QJsonObject& params, const TestRecord& record);
+    // 取消任务：排队中的直接移除，运行中的终止进程；记录备注为“手动中断”
+    bool cancel(int jobId);
+    void cancelAll();
+
+    int runningCount() const { return m_running.size(); }
+    int pendingCount() const { return m_pending.size(); }
+
+signals:
+    void jobStarted(int jobId, int testId);
+    void jobFinished(int jobId, int testId, bool success);
+    // 任务结束时的测试记录（含结果路径和指标数据），在jobFinished之前发出
+    void jobResult(int jobId, const TestRecord& record);
+    // 任务的脚本输出
+    void jobLog(int jobId, const QString& log);
+    // 任务上报的进度/损失/部分指标（见PythonRunner的进度事件）
+    void jobProgress(int jobId, int iteration, int total, const QString& phase);
+    void jobLoss(int jobId, int iteration, const QJsonObject& values);
+    void jobMetrics(int jobId, const QJsonObject& metrics);
+    // 运行/排队数量变化
+    void queueChanged(int running, int pending);
+
+private:
+    struct RunJob {
+        int jobId = 0;
+        QString scriptPath;
+        QJsonObject params;
+        TestRecord record;
+    };
+    struct Worker {
+        RunJob job;
+        PythonRunner* runner = nullptr;
+        int slot = 0;
+        bool cancelled = false;
+    };
+
+    explicit RunScheduler(QObject *parent = nullptr);
+    // 有空闲工作槽时启动排队的任务
+    void dispatch();
+    // 在下一次事件循环中执行dispatch（多次调用合并为一次）
+    void scheduleDispatch();
+    void onRunnerFinished(int jobId, bool success, const QDateTime& execTime, const QString& metricsData);
+    // 更新任务对应的测试记录
+    void finishRecord(TestRecord& record, const QString& remark);
+    // 工作槽绑定的CPU核（按核数均分给各槽）
+    quint64 affinityMaskOf(int slot) const;
+    int freeSlot() const;
+    // 工作槽的常驻进程（未开启WarmWorkers时返回nullptr）
+    PythonWorker* workerOf(int slot);
+    // 释放超出并行数的空闲常驻进程
+    void trimWorkers();
+
+    static RunScheduler* m_instance;
+    TestDbHelper* m_testDbHelper;
+    QList<RunJob> m_pending;
+    QHash<int, Worker> m_running;
+    int m_maxWorkers = 1;
+    bool m_pinCpu = true;
+    bool m_warmWorkers = true;
+    QVector<PythonWorker*> m_workers;       // 按工作槽
+    int m_nextJobId = 1;
+    bool m_dispatchScheduled = false;
+};
+
+#endif // RUNSCHEDULER_H
@@ -118,9 +118,13 @@ CREATE TABLE IF NOT EXISTS test_records (
     execute_time DATETIME COMMENT '执行完成时间',
     remark VARCHAR(255) DEFAULT '' COMMENT '备注',
     config_id INT COMMENT '关联的配置ID',
+    config_hash CHAR(64) DEFAULT NULL COMMENT '配置参数哈希（toJson规范化后的SHA-256）',
+    script_hash CHAR(64) DEFAULT NULL COMMENT 'Python脚本文件的SHA-256',
+    INDEX idx_result_cache (user_id, config_hash, script_hash, test_id) COMMENT '同一用户相同配置+脚本复用已有结果',
     FOREIGN KEY (config_id) REFERENCES config_params(config_id)
     FOREIGN KEY (user_id) REFERENCES sys_user(id) ON DELETE CASCADE
 );
+-- 旧库升级：ALTER TABLE test_records ADD COLUMN config_hash CHAR(64) DEFAULT NULL, ADD COLUMN script_hash CHAR(64) DEFAULT NULL, ADD INDEX idx_result_cache (user_id, config_hash, script_hash, test_id);
 
 CREATE TABLE IF NOT EXISTS chat_dialog (
   id INT PRIMARY KEY AUTO_INCREMENT COMMENT '对话ID',
@@ -129,8 +133,25 @@ CREATE TABLE IF NOT EXISTS chat_dialog (
   dialog_content TEXT NOT NULL COMMENT 'JSON格式存储多轮对话',
   create_time DATETIME DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
   update_time DATETIME DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP COMMENT '更新时间',
+  INDEX idx_user_update (user_id, update_time, id) COMMENT '对话列表keyset分页',
   FOREIGN KEY (user_id) REFERENCES sys_user(id) ON DELETE CASCADE
 ) COMMENT='大模型对话记录表';
+-- 旧库升级：ALTER TABLE chat_dialog ADD INDEX idx_user_update (user_id, update_time, id);
+
+-- 对话消息表（逐条存储，追加写入；chat_dialog.dialog_content仅保留给旧数据）
+CREATE TABLE IF NOT EXISTS chat_message (
+  id BIGINT PRIMARY KEY AUTO_INCREMENT COMMENT '消息ID',
+  dialog_id INT NOT NULL COMMENT '关联chat_dialog表id',
+  seq INT NOT NULL COMMENT '对话内序号（从1开始）',
+  role VARCHAR(16) NOT NULL COMMENT '角色：user/assistant',
+  content MEDIUMTEXT NOT NULL COMMENT '消息原文（AI回复为Markdown）',
+  tokens INT NOT NULL DEFAULT 0 COMMENT '估算token数',
+  created_at DATETIME(3) DEFAULT CURRENT_TIMESTAMP(3) COMMENT '创建时间',
+  UNIQUE KEY uk_dialog_seq (dialog_id, seq),
+  FULLTEXT KEY ft_content (content) WITH PARSER ngram COMMENT '对话内容全文搜索（ngram分词支持中文）',
+  FOREIGN KEY (dialog_id) REFERENCES chat_dialog(id) ON DELETE CASCADE
+) COMMENT='大模型对话消息表';
+-- 旧库升级：ALTER TABLE chat_message ADD FULLTEXT KEY ft_content (content) WITH PARSER ngram;
 
 -- 用户API配置表（多用户独立配置）
 CREATE TABLE IF NOT EXISTS user_api_config (
@@ -152,6 +173,7 @@ CREATE TABLE IF NOT EXISTS model_config (
   model_code VARCHAR(50) NOT NULL UNIQUE COMMENT '模型编码（如glm-4.7）',
   model_name VARCHAR(100) NOT NULL COMMENT '模型名称（如智谱GLM-4.7）',
   is_default TINYINT DEFAULT 0 COMMENT '是否默认模型（1=是）',
+  context_tokens INT NOT NULL DEFAULT 8000 COMMENT '请求上下文token预算（含回复预留）',
   create_time DATETIME DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
   FOREIGN KEY (user_id) REFERENCES sys_user(id) ON DELETE CASCADE
 ) COMMENT='系统大模型配置表';
@@ -162,4 +184,5 @@ VALUES
 ('glm-4.7', '智谱GLM-4.7', 1),
 ('glm-4', '智谱GLM-4', 0),
 ('glm-3-turbo', '智谱GLM-3-Turbo', 0)
-ON DUPLICATE KEY UPDATE model_name = VALUES(model_name);
\ No newline at end of file
+ON DUPLICATE KEY UPDATE model_name = VALUES(model_name);
+-- 旧库升级：ALTER TABLE model_config ADD COLUMN context_tokens INT NOT NULL DEFAULT 8000 COMMENT '请求上下文token预算（含回复预留）' AFTER is_default;
\ No newline at end of file
@@ -0,0 +1,193 @@
+# -*- coding: utf-8 -*-
+"""
+常驻Python工作进程（由PythonWorker启动，随程序资源分发）
+
+同一进程内依次执行多个算法脚本，torch/dreal/matplotlib等模块只在第一次运行时导入，
+后续任务直接复用sys.modules，省去每次启动解释器和导入的时间。
+只保留标准库和site-packages中的模块；脚本目录下的辅助模块每次任务结束后移除，
+避免不同目录的同名模块（utils/learner等）互相串用，修改后也能立即生效。
+
+协议（每条消息一行紧凑JSON，UTF-8）：
+  程序 -> 本进程（stdin）：
+    {"type": "run", "job": 1, "script": "...", "argv": ["--params_path", "..."]}
+    {"type": "ping", "id": 1}
+    {"type": "exit"}
+  本进程 -> 程序（stdout，以FRAME_MARKER开头，其余输出均为脚本自身的输出）：
+    {"type": "ready", "pid": 123, "python": "3.10.12"}
+    {"type": "pong", "id": 1, "busy": true}
+    {"type": "done", "job": 1, "exit_code": 0, "error": ""}
+    达到WORKER_MAX_JOBS后最后一个done帧带 "exiting": true，程序收到后不再向本进程发送任务
+心跳由stdin读取线程直接应答，脚本运行期间也能响应。
+"""
+import gc
+import importlib
+import json
+import os
+import queue
+import runpy
+import site
+import sys
+import sysconfig
+import threading
+import traceback
+
+FRAME_MARKER = "\x1e@worker "
+
+_write_lock = threading.Lock()
+_busy = threading.Event()
+
+
+def _flush_std():
+    for stream in (sys.stdout, sys.stderr):
+        try:
+            stream.flush()
+        except Exception:
+            pass
+    # C扩展通过printf写入的内容在管道下是全缓冲的，帧之前一并刷出
+    try:
+        import ctypes
+        ctypes.CDLL(None).fflush(None)
+    except Exception:
+        pass
+
+
+def send_frame(frame):
+    with _write_lock:
+        _flush_std()
+        # 前置换行：脚本最后一行没有换行时，帧仍然从新的一行开始
+        sys.stdout.write("\n" + FRAME_MARKER + json.dumps(frame, ensure_ascii=False) + "\n")
+        sys.stdout.flush()
+
+
+def _read_commands(jobs):
+    for line in sys.stdin:
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            message = json.loads(line)
+        except ValueError:
+            sys.stderr.write("worker_host: 无法解析的指令：%s\n" % line)
+            continue
+        kind = message.get("type")
+        if kind == "ping":
+            send_frame({"type": "pong", "id": message.get("id"), "busy": _busy.is_set()})
+        elif kind == "run":
+            jobs.put(message)
+        elif kind == "exit":
+            break
+    # stdin关闭（程序退出）或收到exit：等当前任务结束后退出
+    jobs.put(None)
+
+
+def _installed_roots():
+    """标准库和site-packages所在目录，其中的模块可以在任务之间保留"""
+    roots = set()
+    for name in ("stdlib", "platstdlib", "purelib", "platlib"):
+        path = sysconfig.get_paths().get(name)
+        if path:
+            roots.add(path)
+    try:
+        roots.update(site.getsitepackages())
+    except AttributeError:
+        pass
+    user_site = getattr(site, "getusersitepackages", lambda: None)()
+    if user_site:
+        roots.add(user_site)
+    return tuple(os.path.normcase(os.path.realpath(p)) + os.sep for p in roots)
+
+
+_INSTALLED_ROOTS = _installed_roots()
+
+
+def _is_installed(module):
+    path = getattr(module, "__file__", None)
+    if not path:
+        # 内置模块和命名空间包
+        return True
+    path = os.path.normcase(os.path.realpath(path))
+    return path.startswith(_INSTALLED_ROOTS)
+
+
+def _unload_local_modules(before):
+    """移除本次任务导入的本地模块（脚本目录下的utils等），下次任务按新的脚本目录重新导入"""
+    for name in list(sys.modules):
+        if name in before:
+            continue
+        module = sys.modules.get(name)
+        if module is not None and not _is_installed(module):
+            del sys.modules[name]
+    importlib.invalidate_caches()
+
+
+def _run_job(message):
+    script = message["script"]
+    argv = message.get("argv", [])
+    saved_argv = sys.argv[:]
+    saved_path = sys.path[:]
+    saved_modules = set(sys.modules)
+    saved_cwd = os.getcwd()
+    exit_code = 0
+    error = ""
+    try:
+        sys.argv = [script] + list(argv)
+        # 与 python script.py 一致：脚本所在目录优先于其他路径
+        sys.path.insert(0, os.path.dirname(os.path.abspath(script)))
+        runpy.run_path(script, run_name="__main__")
+    except SystemExit as e:
+        if e.code is None:
+            exit_code = 0
+        elif isinstance(e.code, int):
+            exit_code = e.code
+        else:
+            sys.stderr.write("%s\n" % e.code)
+            exit_code = 1
+    except BaseException:
+        traceback.print_exc()
+        exit_code = 1
+        error = traceback.format_exc(limit=1).strip().splitlines()[-1]
+    finally:
+        sys.argv = saved_argv
+        sys.path[:] = saved_path
+        _unload_local_modules(saved_modules)
+        try:
+            os.chdir(saved_cwd)
+        except OSError:
+            pass
+        # 释放上一次运行的图像和中间对象，避免常驻进程内存持续增长
+        if "matplotlib.pyplot" in sys.modules:
+            try:
+                sys.modules["matplotlib.pyplot"].close("all")
+            except Exception:
+                pass
+        gc.collect()
+    return exit_code, error
+
+
+def main():
+    max_jobs = int(os.environ.get("WORKER_MAX_JOBS", "0"))
+    jobs = queue.Queue()
+    reader = threading.Thread(target=_read_commands, args=(jobs,), daemon=True)
+    reader.start()
+
+    send_frame({"type": "ready", "pid": os.getpid(), "python": sys.version.split()[0]})
+    finished = 0
+    while True:
+        message = jobs.get()
+        if message is None:
+            break
+        _busy.set()
+        exit_code, error = _run_job(message)
+        _busy.clear()
+        finished += 1
+        # 运行一定次数后主动退出，由程序重新拉起（回收脚本遗留的全局状态）
+        exiting = max_jobs > 0 and finished >= max_jobs
+        send_frame({"type": "done", "job": message.get("job"), "exit_code": exit_code, "error": error,
+                    "exiting": exiting})
+        if exiting:
+            break
+    _flush_std()
+
+
+if __name__ == "__main__":
+    main()
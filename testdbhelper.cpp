@@ -2,7 +2,10 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QSqlQuery>
+#include <QSqlRecord>
 #include <QVariant>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QDebug>
 
 // ConfigParams 转换JSON
@@ -92,21 +95,101 @@ QJsonObject ConfigParams::toJson() const {
 }
 
 void ConfigParams::fromJson(const QJsonObject& json) {
-    // 仅示例核心参数，其余参数可按需补充
-    init_seed = json["init_seed"].toInt(1);
-    campaign_run = json["campaign_run"].toInt(2000);
-    system_name = json["system_name"].toString("nomoto_ship");
+    // 与toJson字段一一对应；缺少的字段保留当前值（可在已有配置上覆盖部分参数）
+    auto readInt = [&json](const char* key, int& field) { field = json.value(key).toInt(field); };
+    auto readDouble = [&json](const char* key, double& field) { field = json.value(key).toDouble(field); };
+    auto readBool = [&json](const char* key, bool& field) { field = json.value(key).toBool(field); };
+    auto readString = [&json](const char* key, QString& field) { field = json.value(key).toString(field); };
 
+    // campaign_params
+    readInt("init_seed", init_seed);
+    readInt("campaign_run", campaign_run);
+    readInt("tot_runs", tot_runs);
+    readInt("max_loop_number", max_loop_number);
+    readInt("max_iters", max_iters);
+    readString("system_name", system_name);
     QJsonArray xStar = json["x_star"].toArray();
     if (xStar.size() >= 2) {
-        x_star_1 = xStar[0].toDouble(30.0);
-        x_star_2 = xStar[1].toDouble(0.0);
+        x_star_1 = xStar[0].toDouble(x_star_1);
+        x_star_2 = xStar[1].toDouble(x_star_2);
     }
 
-    learning_rate = json["learning_rate"].toDouble(0.01);
-    use_saturation = json["use_saturation"].toBool(true);
-    K = json["K"].toDouble(0.478);
-    end_time = json["end_time"].toDouble(300.0);
+    // learner_params
+    readInt("N", N);
+    readInt("N_max", N_max);
+    readBool("sliding_window", sliding_window);
+    readDouble("learning_rate", learning_rate);
+    readDouble("learning_rate_c", learning_rate_c);
+    readBool("use_scheduler", use_scheduler);
+    readInt("sched_T", sched_T);
+    readInt("print_interval", print_interval);
+
+    // lyap_params
+    readInt("n_input", n_input);
+    readDouble("beta_sfpl", beta_sfpl);
+    readBool("clipping_V", clipping_V);
+    readString("size_layers", size_layers);
+    readString("lyap_activations", lyap_activations);
+    readString("lyap_bias", lyap_bias);
+
+    // control_params
+    readBool("use_lin_ctr", use_lin_ctr);
+    readBool("lin_contr_bias", lin_contr_bias);
+    readBool("control_initialised", control_initialised);
+    readString("init_control", init_control);
+    readString("size_ctrl_layers", size_ctrl_layers);
+    readString("ctrl_bias", ctrl_bias);
+    readString("ctrl_activations", ctrl_activations);
+    readBool("use_saturation", use_saturation);
+    readString("ctrl_sat", ctrl_sat);
+
+    // falsifier_params
+    readDouble("gamma_underbar", gamma_underbar);
+    readDouble("gamma_overbar", gamma_overbar);
+    readInt("zeta_SMT", zeta_SMT);
+    readDouble("epsilon", epsilon);
+    readInt("grid_points", grid_points);
+    readInt("zeta_D", zeta_D);
+
+    // loss_function
+    readDouble("alpha_1", alpha_1);
+    readDouble("alpha_2", alpha_2);
+    readDouble("alpha_3", alpha_3);
+    readDouble("alpha_4", alpha_4);
+    readDouble("alpha_roa", alpha_roa);
+    readDouble("alpha_5", alpha_5);
+
+    // dyn_sys_params
+    readInt("n1", n1);
+    readInt("n2", n2);
+    readDouble("K", K);
+    readInt("T", T);
+    readInt("d", d);
+
+    // postproc_params
+    readBool("execute_postprocessing", execute_postprocessing);
+    readBool("verbose_info", verbose_info);
+    readInt("dpi_", dpi_);
+    readBool("plot_V", plot_V);
+    readBool("plot_Vdot", plot_Vdot);
+    readBool("plot_u", plot_u);
+    readBool("plot_4D_", plot_4D_);
+    readInt("n_points_4D", n_points_4D);
+    readInt("n_points_3D", n_points_3D);
+    readBool("plot_ctr_weights", plot_ctr_weights);
+    readBool("plot_V_weights", plot_V_weights);
+    readBool("plot_dataset", plot_dataset);
+
+    // closed_loop_params
+    readBool("test_closed_loop_dynamics", test_closed_loop_dynamics);
+    readDouble("end_time", end_time);
+    readDouble("Dt", Dt);
+}
+
+QString ConfigParams::hash() const {
+    // QJsonObject按键名有序存储，紧凑输出即为规范形式
+    QByteArray canonical = QJsonDocument(toJson()).toJson(QJsonDocument::Compact);
+    return QString::fromLatin1(QCryptographicHash::hash(canonical, QCryptographicHash::Sha256).toHex());
 }
 
 // TestDbHelper 单例实现
@@ -176,10 +259,10 @@ bool TestDbHelper::saveConfigParams(const ConfigParams& params, int UUID, int& c
         return false;
     }
 
-    // 获取插入的ID
-    QSqlQuery query = m_dbHelper->execQuery("SELECT LAST_INSERT_ID()");
-    if (query.next()) {
-        configId = query.value(0).toInt();
+    // 获取插入的ID（取自本次插入语句，连接池下无需依赖同一连接执行LAST_INSERT_ID()）
+    QVariant insertId = m_dbHelper->lastInsertId();
+    if (insertId.isValid()) {
+        configId = insertId.toInt();
     } else {
         configId = -1;
         return false;
@@ -191,7 +274,7 @@ bool TestDbHelper::saveConfigParams(const ConfigParams& params, int UUID, int& c
 // 获取配置参数
 bool TestDbHelper::getConfigParams(int UUID, int configId, ConfigParams& params) {
     QString sql = "SELECT * FROM config_params WHERE config_id = ?";
-    QSqlQuery query = m_dbHelper->execPrepareQuery(sql, {UUID, configId});
+    DbQuery query = m_dbHelper->execPrepareQuery(sql, {UUID, configId});
     if (!query.next()) {
         qCritical() << "获取配置参数失败，配置ID或者用户ID不存在：" << UUID << ":" << configId;
         return false;
@@ -275,24 +358,28 @@ bool TestDbHelper::getConfigParams(int UUID, int configId, ConfigParams& params)
 }
 
 // 添加测试记录
-bool TestDbHelper::addTestRecord(const TestRecord& record) {
+bool TestDbHelper::addTestRecord(const TestRecord& record, int* testId) {
     QString sql = R"(
         INSERT INTO test_records (
             user_id, config_id, test_name, test_code, params_detail, result_path, metrics_data,
-            execute_time, remark
-        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)
+            execute_time, remark, config_hash, script_hash
+        ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
     )";
 
     QVariantList paramsList = {
         record.UUID, record.config_id, record.test_name, record.test_code, record.params_detail,
         record.result_path, record.metrics_data, record.execute_time.toString("yyyy-MM-dd HH:mm:ss"),
-        record.remark
+        record.remark, record.config_hash, record.script_hash
     };
 
     if (!m_dbHelper->execPrepareSql(sql, paramsList)) {
         qCritical() << "添加测试记录失败：" << m_dbHelper->getLastError();
         return false;
     }
+    if (testId) {
+        QVariant insertId = m_dbHelper->lastInsertId();
+        *testId = insertId.isValid() ? insertId.toInt() : -1;
+    }
     return true;
 }
 
@@ -301,13 +388,13 @@ bool TestDbHelper::updateTestRecord(const TestRecord& record) {
     QString sql = R"(
         UPDATE test_records SET
             user_id = ?, config_id = ?, test_name = ?, test_code = ?, params_detail = ?, result_path = ?,
-            metrics_data = ?, execute_time = ?, remark = ?
+            metrics_data = ?, execute_time = ?, remark = ?, config_hash = ?, script_hash = ?
         WHERE test_id = ?
     )";
     QVariantList paramsList = {
         record.UUID, record.config_id, record.test_name, record.test_code, record.params_detail,
         record.result_path, record.metrics_data, record.execute_time.toString("yyyy-MM-dd HH:mm:ss"),
-        record.remark, record.test_id
+        record.remark, record.config_hash, record.script_hash, record.test_id
     };
 
     if (!m_dbHelper->execPrepareSql(sql, paramsList)) {
@@ -327,26 +414,52 @@ bool TestDbHelper::deleteTestRecord(int testId) {
     return true;
 }
 
+// 查找可复用的执行结果
+bool TestDbHelper::findCachedResult(int UUID, const QString& configHash, const QString& scriptHash, TestRecord& record) {
+    if (configHash.isEmpty() || scriptHash.isEmpty()) return false;
+    // 命中idx_result_cache；只复用本用户的结果（与getAllTestRecords(UUID)的可见范围一致），结果目录被手动删除的记录跳过
+    QString sql = R"(
+        SELECT * FROM test_records
+        WHERE user_id = ? AND config_hash = ? AND script_hash = ? AND remark = '执行成功'
+        ORDER BY test_id DESC LIMIT 5
+    )";
+    DbQuery query = m_dbHelper->execPrepareQuery(sql, {UUID, configHash, scriptHash});
+    while (query.next()) {
+        TestRecord candidate = recordFromSql(query.record());
+        if (!candidate.result_path.isEmpty() && QDir(candidate.result_path).exists()) {
+            record = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// 数据库行映射为测试记录
+TestRecord TestDbHelper::recordFromSql(const QSqlRecord& row) {
+    TestRecord record;
+    record.test_id = row.value("test_id").toInt();
+    record.UUID = row.value("user_id").toInt();
+    record.config_id = row.value("config_id").toInt();
+    record.test_name = row.value("test_name").toString();
+    record.test_code = row.value("test_code").toString();
+    record.params_detail = row.value("params_detail").toString();
+    record.result_path = row.value("result_path").toString();
+    record.metrics_data = row.value("metrics_data").toString();
+    record.execute_time = QDateTime::fromString(row.value("execute_time").toString(), "yyyy-MM-dd'T'HH:mm:ss.zzz");
+    record.remark = row.value("remark").toString();
+    record.config_hash = row.value("config_hash").toString();
+    record.script_hash = row.value("script_hash").toString();
+    return record;
+}
+
 // 获取所有测试记录
 QList<TestRecord> TestDbHelper::getAllTestRecords(int UUID) {
     QList<TestRecord> records;
     QString sql = "SELECT * FROM test_records WHERE user_id = ? ORDER BY test_id DESC";
-    QSqlQuery query = m_dbHelper->execPrepareQuery(sql, {UUID});
+    DbQuery query = m_dbHelper->execPrepareQuery(sql, {UUID});
 
     while (query.next()) {
-        TestRecord record;
-        record.test_id = query.value("test_id").toInt();
-        record.UUID = query.value("user_id").toInt();
-        record.config_id = query.value("config_id").toInt();
-        record.test_name = query.value("test_name").toString();
-        record.test_code = query.value("test_code").toString();
-        record.params_detail = query.value("params_detail").toString();
-        record.result_path = query.value("result_path").toString();
-        record.metrics_data = query.value("metrics_data").toString();
-        record.execute_time = QDateTime::fromString(query.value("execute_time").toString(), "yyyy-MM-dd'T'HH:mm:ss.zzz");
-        record.remark = query.value("remark").toString();
-//        qDebug() << record.execute_time << query.value("execute_time").toString();
-        records.append(record);
+        records.append(recordFromSql(query.record()));
     }
 
     return records;
@@ -355,23 +468,31 @@ QList<TestRecord> TestDbHelper::getAllTestRecords(int UUID) {
 QList<TestRecord> TestDbHelper::getAllTestRecords() {
     QList<TestRecord> records;
     QString sql = "SELECT * FROM test_records ORDER BY test_id DESC";
-    QSqlQuery query = m_dbHelper->execPrepareQuery(sql, {});
+    DbQuery query = m_dbHelper->execPrepareQuery(sql, {});
 
     while (query.next()) {
-        TestRecord record;
-        record.test_id = query.value("test_id").toInt();
-        record.UUID = query.value("user_id").toInt();
-        record.config_id = query.value("config_id").toInt();
-        record.test_name = query.value("test_name").toString();
-        record.test_code = query.value("test_code").toString();
-        record.params_detail = query.value("params_detail").toString();
-        record.result_path = query.value("result_path").toString();
-        record.metrics_data = query.value("metrics_data").toString();
-        record.execute_time = QDateTime::fromString(query.value("execute_time").toString(), "yyyy-MM-dd'T'HH:mm:ss.zzz");
-        record.remark = query.value("remark").toString();
-//        qDebug() << record.execute_time << query.value("execute_time").toString();
-        records.append(record);
+        records.append(recordFromSql(query.record()));
     }
 
     return records;
 }
+
+// 异步获取测试记录（UUID < 0 表示全部），结果在context线程回调
+quint64 TestDbHelper::getAllTestRecordsAsync(int UUID, QObject *context,
+                                             std::function<void(bool, const QList<TestRecord>&)> callback) {
+    QString sql = (UUID < 0) ? "SELECT * FROM test_records ORDER BY test_id DESC"
+                             : "SELECT * FROM test_records WHERE user_id = ? ORDER BY test_id DESC";
+    QVariantList params;
+    if (UUID >= 0) params << UUID;
+
+    return m_dbHelper->execPrepareQueryAsync(sql, params, context, [callback](const DbQueryResult& result) {
+        QList<TestRecord> records;
+        if (!result.success) {
+            qCritical() << "异步获取测试记录失败：" << result.error;
+        }
+        for (const QSqlRecord& row : result.rows) {
+            records.append(recordFromSql(row));
+        }
+        callback(result.success, records);
+    });
+}
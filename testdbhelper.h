@@ -4,6 +4,7 @@
 #include "BaseDbHelper.h"
 #include <QJsonObject>
 #include <QDateTime>
+#include <functional>
 
 // 配置参数结构体
 struct ConfigParams {
@@ -83,8 +84,10 @@ struct ConfigParams {
 
     // 转换为JSON对象
     QJsonObject toJson() const;
-    // 从JSON对象加载
+    // 从JSON对象加载（缺少的字段保留当前值）
     void fromJson(const QJsonObject& json);
+    // 配置哈希：toJson按键名排序的紧凑JSON的SHA-256（十六进制），参数完全相同时相同
+    QString hash() const;
 };
 
 // 测试记录结构体
@@ -99,6 +102,8 @@ struct TestRecord {
     QString metrics_data;   // JSON字符串
     QDateTime execute_time;
     QString remark;
+    QString config_hash;    // ConfigParams::hash()
+    QString script_hash;    // 脚本文件内容的SHA-256
 };
 
 class TestDbHelper : public QObject
@@ -113,11 +118,18 @@ public:
     bool getConfigParams(int UUID, int configId, ConfigParams& params);         // 根据ID获取配置
 
     // 测试记录相关
-    bool addTestRecord(const TestRecord& record);                    // 添加测试记录
+    bool addTestRecord(const TestRecord& record, int* testId = nullptr); // 添加测试记录，可选输出test_id
     bool updateTestRecord(const TestRecord& record);                 // 更新测试记录
     bool deleteTestRecord(int testId);                               // 删除测试记录
+    // 查找该用户相同配置+脚本最近一次执行成功且结果目录仍存在的记录
+    bool findCachedResult(int UUID, const QString& configHash, const QString& scriptHash, TestRecord& record);
     QList<TestRecord> getAllTestRecords(int UUID);                           // 获取当前用户的测试记录
     QList<TestRecord> getAllTestRecords();                           // 获取所有测试记录
+    // 异步获取测试记录（UUID < 0 表示全部），返回请求ID
+    quint64 getAllTestRecordsAsync(int UUID, QObject *context,
+                                   std::function<void(bool, const QList<TestRecord>&)> callback);
+    // 数据库行映射为测试记录
+    static TestRecord recordFromSql(const QSqlRecord& row);
 
 private:
     TestDbHelper(QObject *parent = nullptr);
@@ -21,15 +21,27 @@ bool UserDbHelper::userLogin(const QString &phone, const QString &pwd)
 {
 //    qDebug() << m_baseDbHelper->encryptPwd(pwd);
     QString sql = "SELECT * FROM sys_user WHERE phone=? AND pwd=?";
-    QSqlQuery query = m_baseDbHelper->execPrepareQuery(sql, {phone, m_baseDbHelper->encryptPwd(pwd)});
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, {phone, m_baseDbHelper->encryptPwd(pwd)});
     return query.next();
 }
 
+// 异步登录：在数据库工作线程校验，避免网络往返阻塞登录界面
+quint64 UserDbHelper::userLoginAsync(const QString &phone, const QString &pwd,
+                                     QObject *context, std::function<void(bool, int)> callback)
+{
+    QString sql = "SELECT id FROM sys_user WHERE phone=? AND pwd=?";
+    return m_baseDbHelper->execPrepareQueryAsync(sql, {phone, m_baseDbHelper->encryptPwd(pwd)}, context,
+                                                 [callback](const DbQueryResult &result) {
+        bool ok = result.success && !result.rows.isEmpty();
+        callback(ok, ok ? result.rows.first().value(0).toInt() : -1);
+    });
+}
+
 // 校验手机号是否存在
 bool UserDbHelper::checkPhoneExist(const QString &phone)
 {
     QString sql = "SELECT * FROM sys_user WHERE phone=?";
-    QSqlQuery query = m_baseDbHelper->execPrepareQuery(sql, {phone});
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, {phone});
     return query.next();
 }
 
@@ -39,7 +51,7 @@ bool UserDbHelper::modifyUserPwd(const QString &phone, const QString &oldPwd, co
     if(!checkPhoneExist(phone)) return false;
     // 校验原密码
     QString sqlCheck = "SELECT * FROM sys_user WHERE phone=? AND pwd=?";
-    QSqlQuery query = m_baseDbHelper->execPrepareQuery(sqlCheck, {phone, m_baseDbHelper->encryptPwd(oldPwd)});
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sqlCheck, {phone, m_baseDbHelper->encryptPwd(oldPwd)});
     if(!query.next()) return false;
     // 更新新密码
     QString sqlUpdate = "UPDATE sys_user SET pwd=? WHERE phone=?";
@@ -56,7 +68,7 @@ bool UserDbHelper::modifyUserPwdByPhone(const QString& phone, const QString& new
 QString UserDbHelper::getUserInfoByPhone(const QString &phone)
 {
     QString sql = "SELECT phone FROM sys_user WHERE phone=?";
-    QSqlQuery query = m_baseDbHelper->execPrepareQuery(sql, {phone});
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, {phone});
     return query.next() ? query.value(0).toString() : "";
 }
 
@@ -64,7 +76,7 @@ QString UserDbHelper::getUserInfoByPhone(const QString &phone)
 QString UserDbHelper::getUserUUIDByPhone(const QString &phone)
 {
     QString sql = "SELECT id FROM sys_user WHERE phone=?";
-    QSqlQuery query = m_baseDbHelper->execPrepareQuery(sql, {phone});
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, {phone});
     return query.next() ? query.value(0).toString() : "";
 }
 
@@ -76,7 +88,7 @@ QHash<QString, QString> UserDbHelper::getUserInfoByUUID(const QString &UUID)
 
     // 1. SQL语句和查询参数
     QString sql = "SELECT * FROM sys_user WHERE phone=?";
-    QSqlQuery query = m_baseDbHelper->execPrepareQuery(sql, {UUID});
+    DbQuery query = m_baseDbHelper->execPrepareQuery(sql, {UUID});
 
     // 2. 判断是否查询到有效记录
     if (!query.next())
@@ -126,13 +138,13 @@ bool UserDbHelper::updateUser(int userId, const QString &userName, const QString
 }
 
 // 获取所有用户列表
-QSqlQuery UserDbHelper::getAllUserList()
+DbQuery UserDbHelper::getAllUserList()
 {
     return m_baseDbHelper->execQuery("SELECT id,user_name,nick_name,role_name,phone,status,pwd,create_time FROM sys_user ORDER BY id DESC");
 }
 
 // 搜索用户
-QSqlQuery UserDbHelper::searchUserByKey(const QString &key)
+DbQuery UserDbHelper::searchUserByKey(const QString &key)
 {
     QString sql = "SELECT * FROM sys_user WHERE user_name LIKE ? OR nick_name LIKE ? OR phone LIKE ? OR role_name LIKE ? ORDER BY id DESC";
     QString likeKey = "%" + key + "%";
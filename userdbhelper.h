@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QSqlQuery>
 #include <QHash>
+#include <functional>
 #include "BaseDbHelper.h"
 
 // 用户业务助手：仅处理用户相关业务逻辑，依赖通用数据库层
@@ -16,6 +17,9 @@ public:
     // 基础用户操作（登录/注册/改密码）
     bool userRegister(const QString &phone, const QString &pwd);
     bool userLogin(const QString &phone, const QString &pwd);
+    // 异步登录校验：回调参数为是否通过、用户ID
+    quint64 userLoginAsync(const QString &phone, const QString &pwd,
+                           QObject *context, std::function<void(bool, int)> callback);
     bool checkPhoneExist(const QString &phone);
     bool modifyUserPwd(const QString &phone, const QString &oldPwd, const QString &newPwd);
     bool modifyUserPwdByPhone(const QString& phone, const QString& newPwd);
@@ -27,8 +31,8 @@ public:
     bool delUserById(int userId);
     bool addUser(const QString &userName, const QString &nickName, const QString &roleName, const QString &phone, const QString &pwd, int status);
     bool updateUser(int userId, const QString &userName, const QString &nickName, const QString &roleName, const QString &phone, const QString &pwd, int status);
-    QSqlQuery getAllUserList();
-    QSqlQuery searchUserByKey(const QString &key);
+    DbQuery getAllUserList();
+    DbQuery searchUserByKey(const QString &key);
 
 private:
     BaseDbHelper *m_baseDbHelper; // 依赖通用数据库层
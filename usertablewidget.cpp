@@ -28,7 +28,7 @@ void UserTableWidget::loadTableData()
 {
     m_tableWidget->setRowCount(0);
     UserDbHelper userDbHelper;
-    QSqlQuery query = userDbHelper.getAllUserList();
+    DbQuery query = userDbHelper.getAllUserList();
     LOG_DEBUG("用户信息模块", "用户信息数量: " << query.size());
     int row = 0;
     while(query.next())
@@ -130,7 +130,7 @@ void UserTableWidget::slot_searchFilter()
     if(key.isEmpty()){ loadTableData(); return; }
 
     UserDbHelper userDbHelper;
-    QSqlQuery query = userDbHelper.searchUserByKey(key);
+    DbQuery query = userDbHelper.searchUserByKey(key);
     int row=0;
     while(query.next())
     {